@@ -53,18 +53,74 @@
 #include "wxx_exception.h"
 #include "wxx_cstring.h"
 #include "wxx_messagepump.h"
+#include "wxx_gdi.h"
 
 
 namespace Win32xx
 {
 
+    //////////////////////////////////////
+    // Definitions for the CFreeList class
+    //
+
+    // Returns the blocks held by the free list to the heap.
+    inline CFreeList::~CFreeList()
+    {
+        for (size_t i = 0; i < m_blocks.size(); ++i)
+            ::operator delete(m_blocks[i]);
+    }
+
+    // Returns a block from the free list, or allocates one from the heap if
+    // the free list is empty. All blocks of a free list must be the same size.
+    inline void* CFreeList::Allocate(size_t size, GDIDataStats& stats)
+    {
+        if (!m_blocks.empty())
+        {
+            void* pBlock = m_blocks.back();
+            m_blocks.pop_back();
+            ++stats.poolAllocs;
+            return pBlock;
+        }
+
+        ++stats.heapAllocs;
+        return ::operator new(size);
+    }
+
+    // Adds the block to the free list, or returns it to the heap if the
+    // free list is full.
+    inline void CFreeList::Free(void* pBlock)
+    {
+        if (m_blocks.size() < WXX_MAX_FREE_BLOCKS)
+        {
+            // Reserve the full capacity so push_back doesn't reallocate.
+            if (m_blocks.capacity() < WXX_MAX_FREE_BLOCKS)
+                m_blocks.reserve(WXX_MAX_FREE_BLOCKS);
+
+            m_blocks.push_back(pBlock);
+        }
+        else
+            ::operator delete(pBlock);
+    }
+
+
     ////////////////////////////////////
     // Definitions for the CWinApp class
     //
 
     // Constructor
-    inline CWinApp::CWinApp() : m_callback(NULL)
+    inline CWinApp::CWinApp() : m_wndProp(0), m_wndPropFailures(0), m_preTranslateGen(0),
+                                m_callback(NULL), m_maxGDIHandles(0), m_maxUserHandles(0),
+                                m_resourceLog(INVALID_HANDLE_VALUE), m_resourceLogTimer(0)
     {
+        ZeroMemory(m_maxMapSizes, sizeof(m_maxMapSizes));
+
+#ifndef NO_DISPATCH_PROFILER
+        LARGE_INTEGER frequency;
+        VERIFY(::QueryPerformanceFrequency(&frequency));
+        m_profileFrequency = frequency.QuadPart;
+        m_isProfiling = 0;
+#endif
+
         static CCriticalSection cs;
         CThreadLock appLock(cs);
 
@@ -84,7 +140,28 @@ namespace Win32xx
                 m_instance = (HINSTANCE)mbi.AllocationBase;
 
                 m_resource = m_instance;
+
+                // Register the global atom used to store the CWnd pointer as a
+                // window property. The name is derived from the module's path,
+                // so it's the same each time the program runs. A process that
+                // ends without deleting the atom doesn't add another one to
+                // the global atom table.
+                TCHAR modulePath[MAX_PATH] = _T("");
+                ::GetModuleFileName(m_instance, modulePath, MAX_PATH);
+                DWORD hash = 2166136261UL;
+                for (LPCTSTR pChar = modulePath; *pChar != _T('\0'); ++pChar)
+                {
+                    hash ^= static_cast<DWORD>(static_cast<TBYTE>(*pChar));
+                    hash *= 16777619UL;
+                }
+
+                CString propName;
+                propName.Format(_T("Win32++ CWnd %08lX"), hash);
+                m_wndProp = ::GlobalAddAtom(propName);
+
+                m_allMaps.push_back(&m_sharedMaps);
                 SetTlsData();
+                GetTlsData()->pMessagePump = this;
                 SetCallback();
                 LoadCommonControls();
 
@@ -116,6 +193,19 @@ namespace Win32xx
     // Destructor
     inline CWinApp::~CWinApp()
     {
+        // Call the shutdown procedures first, so thread pools are stopped
+        // before their tasks can use a partly destroyed CWinApp.
+        std::vector<std::pair<PFNTASKPROC, LPVOID> > shutdownProcs;
+        {
+            CThreadLock appLock(m_appLock);
+            shutdownProcs.swap(m_shutdownProcs);
+        }
+
+        for (size_t i = 0; i < shutdownProcs.size(); ++i)
+            shutdownProcs[i].first(shutdownProcs[i].second);
+
+        StopResourceLog();
+
         // Forcibly destroy any remaining windows now. Windows created from
         //  static CWnds or dangling pointers are destroyed here.
         std::map<HWND, CWnd*, CompareHWND>::const_iterator m;
@@ -129,6 +219,23 @@ namespace Win32xx
         }
 
         // Do remaining tidy up
+        if (m_wndProp != 0)
+        {
+            ::GlobalDeleteAtom(m_wndProp);
+            m_wndProp = 0;
+        }
+
+        // Delete the GDI caches and paint buffers while the handle maps still exist.
+        std::vector<TLSDataPtr>::iterator it;
+        for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+        {
+            delete (*it)->pGDICache;
+            (*it)->pGDICache = 0;
+            delete (*it)->pPaintBuffer;
+            (*it)->pPaintBuffer = 0;
+        }
+
+        m_allMaps.clear();
         m_allTLSData.clear();
         if (m_tlsData != TLS_OUT_OF_INDEXES)
         {
@@ -143,101 +250,541 @@ namespace Win32xx
         OleUninitialize();
     }
 
-    // Adds a HDC and CDC_Data* pair to the map.
-    inline void CWinApp::AddCDCData(HDC dc, CDC_Data* pData)
+    // Adds a HDC and CDC_Data* pair to the calling thread's map. The map
+    // holds the device contexts attached to a CDC. The resource telemetry
+    // counts the managed device contexts here. The maps are searched and
+    // the pair inserted while m_appLock is held, so two threads can't add
+    // the same HDC. If the HDC is already in a map, its data is returned
+    // instead, with its reference count incremented. Otherwise pData is
+    // returned.
+    inline CDC_Data* CWinApp::AddCDCData(HDC dc, CDC_Data* pData)
     {
-        CThreadLock mapLock(m_gdiLock);
-        m_mapCDCData.insert(std::make_pair(dc, pData));
+        CThreadLock appLock(m_appLock);
+        CDC_Data* pMappedData = GetCDCData(dc);
+        if (pMappedData != 0)
+            return pMappedData;
+
+        HandleMaps& maps = GetHandleMaps();
+        CThreadLock mapLock(maps.mapLock);
+        if (maps.mapCDCData.insert(std::make_pair(dc, pData)).second && pData->isManagedHDC)
+            CResourceCounter::Add(RESOURCE_DC);
+
+        pData->pMaps = &maps;
+
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData)
+            ++pTLSData->gdiStats.mapInserts;
+
+        return pData;
     }
 
-    // Adds a HGDIOBJ and CGDI_Data* pair to the map.
-    inline void CWinApp::AddCGDIData(HGDIOBJ gdi, CGDI_Data* pData)
+    // Adds a HGDIOBJ and CGDI_Data* pair to the calling thread's map. The
+    // map holds the managed GDI objects, so the resource telemetry counts
+    // the GDI object here. Like AddCDCData, it returns the data already
+    // mapped to the GDI object, if any.
+    inline CGDI_Data* CWinApp::AddCGDIData(HGDIOBJ gdi, CGDI_Data* pData)
     {
-        CThreadLock mapLock(m_gdiLock);
-        m_mapCGDIData.insert(std::make_pair(gdi, pData));
+        CThreadLock appLock(m_appLock);
+        CGDI_Data* pMappedData = GetCGDIData(gdi);
+        if (pMappedData != 0)
+            return pMappedData;
+
+        HandleMaps& maps = GetHandleMaps();
+        CThreadLock mapLock(maps.mapLock);
+        if (maps.mapCGDIData.insert(std::make_pair(gdi, pData)).second)
+            CResourceCounter::Add(GetResourceType(gdi));
+
+        pData->pMaps = &maps;
+
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData)
+            ++pTLSData->gdiStats.mapInserts;
+
+        return pData;
     }
 
-    // Adds a HIMAGELIST and Ciml_Data* pair to the map.
-    inline void CWinApp::AddCImlData(HIMAGELIST images, CIml_Data* pData)
+    // Adds a HIMAGELIST and Ciml_Data* pair to the calling thread's map.
+    // Like AddCDCData, it returns the data already mapped to the image list,
+    // if any.
+    inline CIml_Data* CWinApp::AddCImlData(HIMAGELIST images, CIml_Data* pData)
     {
-        CThreadLock mapLock(m_wndLock);
-        m_mapCImlData.insert(std::make_pair(images, pData));
+        CThreadLock appLock(m_appLock);
+        CIml_Data* pMappedData = GetCImlData(images);
+        if (pMappedData != 0)
+            return pMappedData;
+
+        HandleMaps& maps = GetHandleMaps();
+        CThreadLock mapLock(maps.mapLock);
+        maps.mapCImlData.insert(std::make_pair(images, pData));
+        pData->pMaps = &maps;
+        return pData;
     }
 
-    // Adds a HMENU and CMenu_Data* to the map.
-    inline void CWinApp::AddCMenuData(HMENU menu, CMenu_Data* pData)
+    // Adds a HMENU and CMenu_Data* to the calling thread's map. Like
+    // AddCDCData, it returns the data already mapped to the menu, if any.
+    inline CMenu_Data* CWinApp::AddCMenuData(HMENU menu, CMenu_Data* pData)
     {
-        CThreadLock mapLock(m_wndLock);
-        m_mapCMenuData.insert(std::make_pair(menu, pData));
+        CThreadLock appLock(m_appLock);
+        CMenu_Data* pMappedData = GetCMenuData(menu);
+        if (pMappedData != 0)
+            return pMappedData;
+
+        HandleMaps& maps = GetHandleMaps();
+        CThreadLock mapLock(maps.mapLock);
+        maps.mapCMenuData.insert(std::make_pair(menu, pData));
+        pData->pMaps = &maps;
+        return pData;
+    }
+
+    // Adds a procedure that's called when the CWinApp is destroyed, before
+    // anything else is destroyed. CThreadPool uses it to stop its threads.
+    inline void CWinApp::AddShutdownProc(PFNTASKPROC pfnProc, LPVOID pParam)
+    {
+        assert(pfnProc);
+        CThreadLock appLock(m_appLock);
+        m_shutdownProcs.push_back(std::make_pair(pfnProc, pParam));
+    }
+
+#ifndef NO_DISPATCH_PROFILER
+
+    // Adds a dispatch time, measured in performance counter ticks, to the statistics.
+    inline void CWinApp::AddDispatchTime(DispatchStats& stats, LONGLONG ticks) const
+    {
+        ++stats.count;
+        stats.totalTicks += ticks;
+        stats.maxTicks = MAX(stats.maxTicks, ticks);
+
+        // Bucket n counts the dispatches that took less than 2^n microseconds.
+        LONGLONG microseconds = (ticks * 1000000) / m_profileFrequency;
+        int bucket = 0;
+        while (microseconds > 0 && bucket < PROFILE_BUCKETS - 1)
+        {
+            microseconds >>= 1;
+            ++bucket;
+        }
+
+        ++stats.histogram[bucket];
+    }
+
+    // Writes the dispatch statistics recorded by all threads to the file in
+    // CSV format. Times are in microseconds. The dispatch profiler must be
+    // enabled with EnableDispatchProfile for statistics to be recorded.
+    inline BOOL CWinApp::DumpDispatchProfile(LPCTSTR fileName)
+    {
+        std::map<UINT, DispatchStats> messages;
+        std::map<std::basic_string<TCHAR>, DispatchStats> classes;
+        std::map<UINT, DispatchStats> queued;
+
+        // Merge the statistics recorded by each thread.
+        {
+            CThreadLock appLock(m_appLock);
+            std::vector<TLSDataPtr>::const_iterator it;
+            for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+            {
+                DispatchProfile& profile = (*it)->profile;
+                CThreadLock profileLock(profile.profileLock);
+
+                std::map<UINT, DispatchStats>::const_iterator m;
+                for (m = profile.messages.begin(); m != profile.messages.end(); ++m)
+                    MergeDispatchStats(messages[m->first], m->second);
+
+                for (m = profile.queued.begin(); m != profile.queued.end(); ++m)
+                    MergeDispatchStats(queued[m->first], m->second);
+
+                // Window classes are merged by name, as a class registered by
+                // each thread has a different atom.
+                std::map<ATOM, DispatchStats>::const_iterator c;
+                for (c = profile.classes.begin(); c != profile.classes.end(); ++c)
+                    MergeDispatchStats(classes[profile.classNames[c->first]], c->second);
+            }
+        }
+
+        CString text = _T("section,key,count,total_us,mean_us,max_us");
+        for (int bucket = 0; bucket < PROFILE_BUCKETS; ++bucket)
+        {
+            CString label;
+            if (bucket < PROFILE_BUCKETS - 1)
+                label.Format(_T(",<%dus"), 1 << bucket);
+            else
+                label.Format(_T(",>=%dus"), 1 << (bucket - 1));
+
+            text += label;
+        }
+        text += _T("\r\n");
+
+        CString key;
+        std::map<UINT, DispatchStats>::const_iterator m;
+        for (m = messages.begin(); m != messages.end(); ++m)
+        {
+            key.Format(_T("0x%04X"), m->first);
+            text += FormatDispatchStats(_T("wndproc_message"), key, m->second);
+        }
+
+        std::map<std::basic_string<TCHAR>, DispatchStats>::const_iterator c;
+        for (c = classes.begin(); c != classes.end(); ++c)
+        {
+            key = _T("\"");
+            key += c->first.c_str();
+            key += _T("\"");
+            text += FormatDispatchStats(_T("wndproc_class"), key, c->second);
+        }
+
+        for (m = queued.begin(); m != queued.end(); ++m)
+        {
+            key.Format(_T("0x%04X"), m->first);
+            text += FormatDispatchStats(_T("queued_message"), key, m->second);
+        }
+
+        HANDLE file = ::CreateFile(fileName, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return FALSE;
+
+        TtoA ansiText(text);
+        DWORD length = static_cast<DWORD>(lstrlenA(ansiText.c_str()));
+        DWORD written = 0;
+        BOOL result = ::WriteFile(file, ansiText.c_str(), length, &written, NULL);
+        ::CloseHandle(file);
+
+        return (result && written == length);
+    }
+
+    // Enables or disables the dispatch profiler. While enabled, the time taken
+    // by each window procedure and each message processed by the message loop
+    // is recorded. Define NO_DISPATCH_PROFILER to compile out the profiler.
+    inline void CWinApp::EnableDispatchProfile(BOOL enable /*= TRUE*/)
+    {
+        ::InterlockedExchange(&m_isProfiling, enable ? 1 : 0);
+    }
+
+    // Returns a line of CSV text for the dispatch statistics.
+    inline CString CWinApp::FormatDispatchStats(LPCTSTR section, LPCTSTR key, const DispatchStats& stats) const
+    {
+        double totalUS = 1000000.0 * static_cast<double>(stats.totalTicks) / m_profileFrequency;
+        double meanUS = stats.count ? totalUS / static_cast<double>(stats.count) : 0.0;
+        double maxUS = 1000000.0 * static_cast<double>(stats.maxTicks) / m_profileFrequency;
+
+        CString line;
+        line.Format(_T("%s,%s,%.0f,%.1f,%.2f,%.1f"), section, key,
+            static_cast<double>(stats.count), totalUS, meanUS, maxUS);
+
+        for (int bucket = 0; bucket < PROFILE_BUCKETS; ++bucket)
+        {
+            CString value;
+            value.Format(_T(",%.0f"), static_cast<double>(stats.histogram[bucket]));
+            line += value;
+        }
+
+        line += _T("\r\n");
+        return line;
+    }
+
+    // Returns the current value of the performance counter.
+    inline LONGLONG CWinApp::GetProfileCounter()
+    {
+        LARGE_INTEGER counter;
+        ::QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    // Adds the statistics to the total.
+    inline void CWinApp::MergeDispatchStats(DispatchStats& total, const DispatchStats& stats) const
+    {
+        total.count += stats.count;
+        total.totalTicks += stats.totalTicks;
+        total.maxTicks = MAX(total.maxTicks, stats.maxTicks);
+        for (int bucket = 0; bucket < PROFILE_BUCKETS; ++bucket)
+            total.histogram[bucket] += stats.histogram[bucket];
     }
 
-    // Retrieves a pointer to CDC_Data from the map
+    // Records the time the message loop took to process a queued message.
+    // Called by CMessagePump::MessageLoop.
+    inline void CWinApp::RecordQueuedMessage(UINT msg, LONGLONG start)
+    {
+        LONGLONG ticks = GetProfileCounter() - start;
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData)
+        {
+            DispatchProfile& profile = pTLSData->profile;
+            CThreadLock profileLock(profile.profileLock);
+            AddDispatchTime(profile.queued[msg], ticks);
+        }
+    }
+
+    // Records the time a window procedure took to process a message, not
+    // counting the time taken by the dispatches nested within it. Called by
+    // CWnd::StaticWindowProc. The statistics for a window class are keyed
+    // by its atom, and the class name is retrieved the first time the class
+    // is seen. The class atom is used as the name if the window procedure
+    // destroyed the window before its class was named.
+    inline void CWinApp::RecordWndProc(TLSData& tlsData, HWND wnd, ATOM classAtom, UINT msg, LONGLONG ticks)
+    {
+        DispatchProfile& profile = tlsData.profile;
+        CThreadLock profileLock(profile.profileLock);
+        AddDispatchTime(profile.messages[msg], ticks);
+        if (classAtom != 0)
+        {
+            AddDispatchTime(profile.classes[classAtom], ticks);
+            if (profile.classNames.find(classAtom) == profile.classNames.end())
+            {
+                CString className;
+                if (::GetClassName(wnd, className.GetBuffer(256), 256) == 0)
+                {
+                    className.ReleaseBuffer(0);
+                    className.Format(_T("#%u"), static_cast<UINT>(classAtom));
+                }
+                else
+                    className.ReleaseBuffer();
+
+                profile.classNames[classAtom] = className.c_str();
+            }
+        }
+    }
+
+    // Discards the dispatch statistics recorded by all threads.
+    inline void CWinApp::ResetDispatchProfile()
+    {
+        CThreadLock appLock(m_appLock);
+        std::vector<TLSDataPtr>::const_iterator it;
+        for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+        {
+            DispatchProfile& profile = (*it)->profile;
+            CThreadLock profileLock(profile.profileLock);
+            profile.messages.clear();
+            profile.classes.clear();
+            profile.classNames.clear();
+            profile.queued.clear();
+        }
+    }
+
+#endif // NO_DISPATCH_PROFILER
+
+    // Returns a line of CSV text for the resource snapshot.
+    inline CString CWinApp::FormatResourceLog(const ResourceSnapshot& snapshot) const
+    {
+        CString line;
+        line.Format(_T("%lu,%lu,%lu,%lu,%lu"), snapshot.tickCount, snapshot.gdiHandles,
+            snapshot.maxGDIHandles, snapshot.userHandles, snapshot.maxUserHandles);
+
+        CString value;
+        for (int type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            const ResourceCount& count = snapshot.resources[type];
+            value.Format(_T(",%ld,%ld,%lu,%lu"), count.count, count.maxCount,
+                count.created, count.destroyed);
+            line += value;
+        }
+
+        for (int map = 0; map < HANDLEMAP_TYPES; ++map)
+        {
+            value.Format(_T(",%lu,%lu"), static_cast<unsigned long>(snapshot.mapSizes[map]),
+                static_cast<unsigned long>(snapshot.maxMapSizes[map]));
+            line += value;
+        }
+
+        line += _T("\r\n");
+        return line;
+    }
+
+    // Returns the CSV column headings for the resource log.
+    inline CString CWinApp::FormatResourceLogHeader() const
+    {
+        CString text = _T("tick_ms,gdi_handles,max_gdi_handles,user_handles,max_user_handles");
+
+        CString columns;
+        for (int type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            LPCTSTR name = GetResourceName(static_cast<ResourceType>(type));
+            columns.Format(_T(",%s,%s_max,%s_created,%s_destroyed"), name, name, name, name);
+            text += columns;
+        }
+
+        for (int map = 0; map < HANDLEMAP_TYPES; ++map)
+        {
+            LPCTSTR name = GetHandleMapName(static_cast<HandleMapType>(map));
+            columns.Format(_T(",%s_map,%s_map_max"), name, name);
+            text += columns;
+        }
+
+        text += _T("\r\n");
+        return text;
+    }
+
+    // Retrieves a pointer to CDC_Data from the map, and increments its
+    // reference count. The calling thread's map is searched first. The
+    // maps of other threads are only searched if that fails.
     inline CDC_Data* CWinApp::GetCDCData(HDC dc)
     {
         std::map<HDC, CDC_Data*, CompareHDC>::const_iterator m;
 
         // Find the CDC data mapped to this HDC
-        CDC_Data* pCDCData = 0;
-        CThreadLock mapLock(m_gdiLock);
-        m = m_mapCDCData.find(dc);
+        HandleMaps& localMaps = GetHandleMaps();
+        {
+            CThreadLock mapLock(localMaps.mapLock);
+            m = localMaps.mapCDCData.find(dc);
+            if (m != localMaps.mapCDCData.end())
+            {
+                InterlockedIncrement(&m->second->count);
+                return m->second;
+            }
+        }
 
-        if (m != m_mapCDCData.end())
-            pCDCData = m->second;
+        // Search the maps of the other threads.
+        CThreadLock appLock(m_appLock);
+        for (size_t i = 0; i < m_allMaps.size(); ++i)
+        {
+            HandleMaps* pMaps = m_allMaps[i];
+            if (pMaps != &localMaps)
+            {
+                CThreadLock mapLock(pMaps->mapLock);
+                m = pMaps->mapCDCData.find(dc);
+                if (m != pMaps->mapCDCData.end())
+                {
+                    InterlockedIncrement(&m->second->count);
+                    return m->second;
+                }
+            }
+        }
 
-        return pCDCData;
+        return 0;
     }
 
-    // Retrieves a pointer to CGDI_Data from the map
+    // Retrieves a pointer to CGDI_Data from the map, and increments its
+    // reference count. The calling thread's map is searched first. The
+    // maps of other threads are only searched if that fails.
     inline CGDI_Data* CWinApp::GetCGDIData(HGDIOBJ object)
     {
         std::map<HGDIOBJ, CGDI_Data*, CompareGDI>::const_iterator m;
 
         // Find the CGDIObject data mapped to this HGDIOBJ
-        CGDI_Data* pCGDIData = 0;
-        CThreadLock mapLock(m_gdiLock);
-        m = m_mapCGDIData.find(object);
+        HandleMaps& localMaps = GetHandleMaps();
+        {
+            CThreadLock mapLock(localMaps.mapLock);
+            m = localMaps.mapCGDIData.find(object);
+            if (m != localMaps.mapCGDIData.end())
+            {
+                InterlockedIncrement(&m->second->count);
+                return m->second;
+            }
+        }
 
-        if (m != m_mapCGDIData.end())
-            pCGDIData = m->second;
+        // Search the maps of the other threads.
+        CThreadLock appLock(m_appLock);
+        for (size_t i = 0; i < m_allMaps.size(); ++i)
+        {
+            HandleMaps* pMaps = m_allMaps[i];
+            if (pMaps != &localMaps)
+            {
+                CThreadLock mapLock(pMaps->mapLock);
+                m = pMaps->mapCGDIData.find(object);
+                if (m != pMaps->mapCGDIData.end())
+                {
+                    InterlockedIncrement(&m->second->count);
+                    return m->second;
+                }
+            }
+        }
 
-        return pCGDIData;
+        return 0;
     }
 
-    // Retrieves a pointer to CIml_Data from the map
+    // Retrieves a pointer to CIml_Data from the map, and increments its
+    // reference count. The calling thread's map is searched first. The
+    // maps of other threads are only searched if that fails.
     inline CIml_Data* CWinApp::GetCImlData(HIMAGELIST images)
     {
         std::map<HIMAGELIST, CIml_Data*, CompareHIMAGELIST>::const_iterator m;
 
         // Find the CImageList data mapped to this HIMAGELIST
-        CIml_Data* pCImlData = 0;
-        CThreadLock mapLock(m_wndLock);
-        m = m_mapCImlData.find(images);
+        HandleMaps& localMaps = GetHandleMaps();
+        {
+            CThreadLock mapLock(localMaps.mapLock);
+            m = localMaps.mapCImlData.find(images);
+            if (m != localMaps.mapCImlData.end())
+            {
+                InterlockedIncrement(&m->second->count);
+                return m->second;
+            }
+        }
 
-        if (m != m_mapCImlData.end())
-            pCImlData = m->second;
+        // Search the maps of the other threads.
+        CThreadLock appLock(m_appLock);
+        for (size_t i = 0; i < m_allMaps.size(); ++i)
+        {
+            HandleMaps* pMaps = m_allMaps[i];
+            if (pMaps != &localMaps)
+            {
+                CThreadLock mapLock(pMaps->mapLock);
+                m = pMaps->mapCImlData.find(images);
+                if (m != pMaps->mapCImlData.end())
+                {
+                    InterlockedIncrement(&m->second->count);
+                    return m->second;
+                }
+            }
+        }
 
-        return pCImlData;
+        return 0;
     }
 
-    // Retrieves a pointer to CMenu_Data from the map
+    // Retrieves a pointer to CMenu_Data from the map, and increments its
+    // reference count. The calling thread's map is searched first. The
+    // maps of other threads are only searched if that fails.
     inline CMenu_Data* CWinApp::GetCMenuData(HMENU menu)
     {
         std::map<HMENU, CMenu_Data*, CompareHMENU>::const_iterator m;
 
         // Find the CMenu data mapped to this HMENU
-        CMenu_Data* pCMenuData = 0;
-        CThreadLock mapLock(m_wndLock);
-        m = m_mapCMenuData.find(menu);
+        HandleMaps& localMaps = GetHandleMaps();
+        {
+            CThreadLock mapLock(localMaps.mapLock);
+            m = localMaps.mapCMenuData.find(menu);
+            if (m != localMaps.mapCMenuData.end())
+            {
+                InterlockedIncrement(&m->second->count);
+                return m->second;
+            }
+        }
 
-        if (m != m_mapCMenuData.end())
-            pCMenuData = m->second;
+        // Search the maps of the other threads.
+        CThreadLock appLock(m_appLock);
+        for (size_t i = 0; i < m_allMaps.size(); ++i)
+        {
+            HandleMaps* pMaps = m_allMaps[i];
+            if (pMaps != &localMaps)
+            {
+                CThreadLock mapLock(pMaps->mapLock);
+                m = pMaps->mapCMenuData.find(menu);
+                if (m != pMaps->mapCMenuData.end())
+                {
+                    InterlockedIncrement(&m->second->count);
+                    return m->second;
+                }
+            }
+        }
 
-        return pCMenuData;
+        return 0;
     }
 
     // Retrieves the CWnd pointer associated with the specified wnd.
     inline CWnd* CWinApp::GetCWndFromMap(HWND wnd)
     {
+        // The CWnd pointer is stored as a window property. Retrieving it
+        // doesn't require a lock or a search of the HWND map. Other
+        // processes running the same program use the same property name,
+        // so the window must belong to this process. The map is only
+        // searched if the property couldn't be set for some window.
+        if (m_wndProp != 0)
+        {
+            DWORD processID = 0;
+            ::GetWindowThreadProcessId(wnd, &processID);
+            if (processID != ::GetCurrentProcessId())
+                return 0;
+
+            CWnd* pWnd = static_cast<CWnd*>(::GetProp(wnd, MAKEINTATOM(m_wndProp)));
+            if (pWnd != 0 || m_wndPropFailures == 0)
+                return pWnd;
+        }
+
         // Allocate an iterator for our HWND map
         std::map<HWND, CWnd*, CompareHWND>::const_iterator m;
 
@@ -252,6 +799,31 @@ namespace Win32xx
         return pWnd;
     }
 
+    // Returns the name of the handle map type, as used by the resource log.
+    inline LPCTSTR CWinApp::GetHandleMapName(HandleMapType type) const
+    {
+        static const LPCTSTR names[HANDLEMAP_TYPES] =
+            { _T("hwnd"), _T("hdc"), _T("gdi"), _T("imagelist"), _T("menu") };
+
+        assert(type >= 0 && type < HANDLEMAP_TYPES);
+        return names[type];
+    }
+
+    // Returns the handle maps for the calling thread. Threads without TLS
+    // data use the maps shared by all such threads.
+    inline HandleMaps& CWinApp::GetHandleMaps()
+    {
+        TLSData* pTLSData = GetTlsData();
+        return pTLSData ? pTLSData->maps : m_sharedMaps;
+    }
+
+    // Returns the lock for the specified handle maps. The calling thread's
+    // lock is returned if pMaps is NULL.
+    inline CCriticalSection& CWinApp::GetMapLock(HandleMaps* pMaps)
+    {
+        return pMaps ? pMaps->mapLock : GetHandleMaps().mapLock;
+    }
+
     // Retrieves a handle to the main window for this thread.
     // Note: CFrame set's itself as the main window of its thread
     inline HWND CWinApp::GetMainWnd() const
@@ -265,6 +837,190 @@ namespace Win32xx
         return pTLSData ? pTLSData->mainWnd : 0;
     }
 
+    // Returns the windows whose PreTranslateMessage function is called for
+    // messages sent to the specified window. The chain starts with the window
+    // itself and is followed by its ancestors. It is cached in the thread's TLS
+    // data, and rebuilt when the window differs or a chain has been invalidated.
+    inline std::vector<CWnd*>& CWinApp::GetPreTranslateChain(TLSData& tlsData, HWND wnd)
+    {
+        LONG gen = m_preTranslateGen;
+        if (tlsData.preTranslateWnd != wnd || tlsData.preTranslateGen != gen)
+        {
+            tlsData.preTranslateChain.clear();
+            for (HWND ancestor = wnd; ancestor != 0; ancestor = ::GetParent(ancestor))
+            {
+                CWnd* pWnd = GetCWndFromMap(ancestor);
+                if (pWnd && pWnd->IsPreTranslateEnabled())
+                    tlsData.preTranslateChain.push_back(pWnd);
+            }
+
+            tlsData.preTranslateWnd = wnd;
+            tlsData.preTranslateGen = gen;
+        }
+
+        return tlsData.preTranslateChain;
+    }
+
+    // Retrieves the calling thread's cache of pens, brushes and fonts. The
+    // cache is created when it's first used by a thread that has TLS data,
+    // such as a thread that creates windows. Returns NULL for other threads,
+    // such as thread pool threads, which create their objects directly.
+    inline CGDICache* CWinApp::GetGDICache()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData == 0)
+            return 0;
+
+        if (pTLSData->pGDICache == 0)
+            pTLSData->pGDICache = new CGDICache;
+
+        return pTLSData->pGDICache;
+    }
+
+    // Retrieves the allocation statistics for the data of the CDC and
+    // CGDIObject objects constructed by the calling thread. Threads without
+    // TLS data don't record statistics.
+    inline GDIDataStats CWinApp::GetGDIDataStats() const
+    {
+        TLSData* pTLSData = GetTlsData();
+        return pTLSData ? pTLSData->gdiStats : GDIDataStats();
+    }
+
+    // Retrieves the CWinApp or CWinThread that runs the message loop of the
+    // specified thread. Returns NULL if the thread doesn't run a message loop.
+    // Note: A CWinThread can be deleted after its thread ends. Use
+    //       PostThreadTask to post a task to another thread's message loop.
+    inline CMessagePump* CWinApp::GetMessagePump(DWORD threadID)
+    {
+        CThreadLock appLock(m_appLock);
+        std::vector<TLSDataPtr>::const_iterator it;
+        for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+        {
+            if ((*it)->threadID == threadID)
+                return (*it)->pMessagePump;
+        }
+
+        return 0;
+    }
+
+    // Posts a task to the message loop of the specified thread. The message
+    // pump is retrieved and used while the TLS data is locked, so it can't
+    // be deleted while the task is posted. Returns FALSE if the thread
+    // doesn't run a message loop.
+    inline BOOL CWinApp::PostThreadTask(DWORD threadID, PFNTASKPROC pfnTask, LPVOID pParam)
+    {
+        CThreadLock appLock(m_appLock);
+        std::vector<TLSDataPtr>::const_iterator it;
+        for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+        {
+            if ((*it)->threadID == threadID && (*it)->pMessagePump != 0)
+                return (*it)->pMessagePump->PostTask(pfnTask, pParam);
+        }
+
+        return FALSE;
+    }
+
+    // Retrieves the calling thread's back buffer for double buffered painting.
+    // The buffer is created when it's first used by a thread that has TLS
+    // data, such as a thread that creates windows. Returns NULL for other
+    // threads, which paint with a bitmap of their own.
+    inline CPaintBuffer* CWinApp::GetPaintBuffer()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData == 0)
+            return 0;
+
+        if (pTLSData->pPaintBuffer == 0)
+            pTLSData->pPaintBuffer = new CPaintBuffer;
+
+        return pTLSData->pPaintBuffer;
+    }
+
+    // Returns the name of the resource type, as used by the resource log.
+    inline LPCTSTR CWinApp::GetResourceName(ResourceType type) const
+    {
+        static const LPCTSTR names[RESOURCE_TYPES] =
+            { _T("bitmap"), _T("brush"), _T("font"), _T("palette"), _T("pen"), _T("region"),
+              _T("other_gdi"), _T("dc"), _T("dc_data"), _T("gdi_data"), _T("shared_ptr") };
+
+        assert(type >= 0 && type < RESOURCE_TYPES);
+        return names[type];
+    }
+
+    // Retrieves the counts of the resources created by the framework, the
+    // number of entries in the handle maps of all threads, and the GDI and
+    // USER handles used by the process. The largest map sizes are those seen
+    // by the snapshots taken so far. Use StartResourceLog to take snapshots
+    // at regular intervals.
+    inline ResourceSnapshot CWinApp::GetResourceSnapshot()
+    {
+        ResourceSnapshot snapshot;
+        ZeroMemory(&snapshot, sizeof(snapshot));
+        snapshot.tickCount = ::GetTickCount();
+
+        for (int type = 0; type < RESOURCE_TYPES; ++type)
+            snapshot.resources[type] = CResourceCounter::Get(static_cast<ResourceType>(type));
+
+        {
+            CThreadLock wndLock(m_wndLock);
+            snapshot.mapSizes[HANDLEMAP_HWND] = m_mapHWND.size();
+        }
+
+#if (WINVER >= 0x0500)
+        // The peak counts are zero before Windows 7.
+        HANDLE process = ::GetCurrentProcess();
+        snapshot.gdiHandles = ::GetGuiResources(process, GR_GDIOBJECTS);
+        snapshot.maxGDIHandles = ::GetGuiResources(process, GR_GDIOBJECTS_PEAK);
+        snapshot.userHandles = ::GetGuiResources(process, GR_USEROBJECTS);
+        snapshot.maxUserHandles = ::GetGuiResources(process, GR_USEROBJECTS_PEAK);
+#endif
+
+        CThreadLock appLock(m_appLock);
+        for (size_t i = 0; i < m_allMaps.size(); ++i)
+        {
+            HandleMaps* pMaps = m_allMaps[i];
+            CThreadLock mapLock(pMaps->mapLock);
+            snapshot.mapSizes[HANDLEMAP_HDC] += pMaps->mapCDCData.size();
+            snapshot.mapSizes[HANDLEMAP_GDI] += pMaps->mapCGDIData.size();
+            snapshot.mapSizes[HANDLEMAP_IMAGELIST] += pMaps->mapCImlData.size();
+            snapshot.mapSizes[HANDLEMAP_MENU] += pMaps->mapCMenuData.size();
+        }
+
+        for (int map = 0; map < HANDLEMAP_TYPES; ++map)
+        {
+            m_maxMapSizes[map] = MAX(m_maxMapSizes[map], snapshot.mapSizes[map]);
+            snapshot.maxMapSizes[map] = m_maxMapSizes[map];
+        }
+
+        m_maxGDIHandles = MAX(m_maxGDIHandles, MAX(snapshot.gdiHandles, snapshot.maxGDIHandles));
+        snapshot.maxGDIHandles = m_maxGDIHandles;
+        m_maxUserHandles = MAX(m_maxUserHandles, MAX(snapshot.userHandles, snapshot.maxUserHandles));
+        snapshot.maxUserHandles = m_maxUserHandles;
+
+        return snapshot;
+    }
+
+    // Returns the ResourceType used to count the GDI object.
+    inline ResourceType CWinApp::GetResourceType(HGDIOBJ object)
+    {
+#ifndef NO_RESOURCE_TELEMETRY
+        switch (::GetObjectType(object))
+        {
+        case OBJ_BITMAP:    return RESOURCE_BITMAP;
+        case OBJ_BRUSH:     return RESOURCE_BRUSH;
+        case OBJ_FONT:      return RESOURCE_FONT;
+        case OBJ_PAL:       return RESOURCE_PALETTE;
+        case OBJ_PEN:
+        case OBJ_EXTPEN:    return RESOURCE_PEN;
+        case OBJ_REGION:    return RESOURCE_REGION;
+        }
+#else
+        UNREFERENCED_PARAMETER(object);
+#endif
+
+        return RESOURCE_OTHER_GDI;
+    }
+
     // Retrieves the pointer to the Thread Local Storage data for the current thread.
     inline TLSData* CWinApp::GetTlsData() const
     {
@@ -342,6 +1098,129 @@ namespace Win32xx
         return ::LoadImage(GetResourceHandle(), MAKEINTRESOURCE (imageID), type, cx, cy, flags);
     }
 
+    // Removes the CDC_Data from the map that holds it. A managed device
+    // context is counted as destroyed, even if it's being detached.
+    inline BOOL CWinApp::RemoveCDCData(CDC_Data* pData)
+    {
+        BOOL success = FALSE;
+        HandleMaps* pMaps = pData->pMaps;
+        if (pMaps != 0)
+        {
+            std::map<HDC, CDC_Data*, CompareHDC>::iterator m;
+
+            CThreadLock mapLock(pMaps->mapLock);
+            m = pMaps->mapCDCData.find(pData->dc);
+            if (m != pMaps->mapCDCData.end() && m->second == pData)
+            {
+                pMaps->mapCDCData.erase(m);
+                if (pData->isManagedHDC)
+                    CResourceCounter::Remove(RESOURCE_DC);
+                success = TRUE;
+            }
+
+            pData->pMaps = 0;
+        }
+
+        return success;
+    }
+
+    // Removes the CGDI_Data from the map that holds it. The GDI object is
+    // counted as destroyed, even if it's being detached.
+    inline BOOL CWinApp::RemoveCGDIData(CGDI_Data* pData)
+    {
+        BOOL success = FALSE;
+        HandleMaps* pMaps = pData->pMaps;
+        if (pMaps != 0)
+        {
+            std::map<HGDIOBJ, CGDI_Data*, CompareGDI>::iterator m;
+
+            CThreadLock mapLock(pMaps->mapLock);
+            m = pMaps->mapCGDIData.find(pData->hGDIObject);
+            if (m != pMaps->mapCGDIData.end() && m->second == pData)
+            {
+                pMaps->mapCGDIData.erase(m);
+                CResourceCounter::Remove(GetResourceType(pData->hGDIObject));
+                success = TRUE;
+            }
+
+            pData->pMaps = 0;
+        }
+
+        return success;
+    }
+
+    // Removes the CIml_Data from the map that holds it.
+    inline BOOL CWinApp::RemoveCImlData(CIml_Data* pData)
+    {
+        BOOL success = FALSE;
+        HandleMaps* pMaps = pData->pMaps;
+        if (pMaps != 0)
+        {
+            std::map<HIMAGELIST, CIml_Data*, CompareHIMAGELIST>::iterator m;
+
+            CThreadLock mapLock(pMaps->mapLock);
+            m = pMaps->mapCImlData.find(pData->images);
+            if (m != pMaps->mapCImlData.end() && m->second == pData)
+            {
+                pMaps->mapCImlData.erase(m);
+                success = TRUE;
+            }
+
+            pData->pMaps = 0;
+        }
+
+        return success;
+    }
+
+    // Removes the CMenu_Data from the map that holds it.
+    inline BOOL CWinApp::RemoveCMenuData(CMenu_Data* pData)
+    {
+        BOOL success = FALSE;
+        HandleMaps* pMaps = pData->pMaps;
+        if (pMaps != 0)
+        {
+            std::map<HMENU, CMenu_Data*, CompareHMENU>::iterator m;
+
+            CThreadLock mapLock(pMaps->mapLock);
+            m = pMaps->mapCMenuData.find(pData->menu);
+            if (m != pMaps->mapCMenuData.end() && m->second == pData)
+            {
+                pMaps->mapCMenuData.erase(m);
+                success = TRUE;
+            }
+
+            pData->pMaps = 0;
+        }
+
+        return success;
+    }
+
+    // Resets the calling thread's allocation statistics for CDC and CGDIObject data.
+    inline void CWinApp::ResetGDIDataStats()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData)
+            pTLSData->gdiStats = GDIDataStats();
+    }
+
+    // Invalidates the cached pre-translation chains of all threads. This is
+    // called when windows with pre-translation enabled are added or removed,
+    // when pre-translation is enabled or disabled, and when a window's parent
+    // is changed.
+    inline void CWinApp::ResetPreTranslateChains()
+    {
+        ::InterlockedIncrement(&m_preTranslateGen);
+    }
+
+    // Writes a resource snapshot to the log. Called by the thread timer set
+    // by StartResourceLog.
+    inline void CALLBACK CWinApp::ResourceLogProc(HWND, UINT, UINT_PTR, DWORD)
+    {
+        CWinApp* pApp = SetnGetThis();
+        if (pApp && pApp->IsResourceLogging())
+            pApp->WriteResourceLog(pApp->FormatResourceLog(pApp->GetResourceSnapshot()));
+    }
+
     // Registers a temporary window class so we can get the callback
     // address of CWnd::StaticWindowProc.
     inline void CWinApp::SetCallback()
@@ -422,6 +1301,157 @@ namespace Win32xx
         m_resource = resource;
     }
 
+    // Starts writing snapshots of the resources used by the application to
+    // the file at the specified interval in milliseconds. The snapshots are
+    // appended to the file in CSV format, one line per snapshot. The timer
+    // runs on the calling thread's message loop. StopResourceLog should be
+    // called by the same thread.
+    inline BOOL CWinApp::StartResourceLog(LPCTSTR fileName, UINT interval)
+    {
+        StopResourceLog();
+
+        HANDLE file = ::CreateFile(fileName, GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return FALSE;
+
+        m_resourceLog = file;
+
+        // Add the column headings to a new file.
+        BOOL result = TRUE;
+        if (::GetFileSize(file, NULL) == 0)
+            result = WriteResourceLog(FormatResourceLogHeader());
+        else
+            ::SetFilePointer(file, 0, NULL, FILE_END);
+
+        if (result)
+            result = WriteResourceLog(FormatResourceLog(GetResourceSnapshot()));
+
+        if (result)
+        {
+            m_resourceLogTimer = ::SetTimer(0, 0, interval, ResourceLogProc);
+            result = (m_resourceLogTimer != 0);
+        }
+
+        if (!result)
+            StopResourceLog();
+
+        return result;
+    }
+
+    // Stops writing resource snapshots, and closes the file.
+    inline void CWinApp::StopResourceLog()
+    {
+        if (m_resourceLogTimer != 0)
+        {
+            ::KillTimer(0, m_resourceLogTimer);
+            m_resourceLogTimer = 0;
+        }
+
+        if (m_resourceLog != INVALID_HANDLE_VALUE)
+        {
+            ::CloseHandle(m_resourceLog);
+            m_resourceLog = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    // Empties the calling thread's cache of pens, brushes and fonts, if it
+    // has one. Called when the system colors or settings change.
+    inline void CWinApp::TrimGDICache()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData != 0 && pTLSData->pGDICache != 0)
+            pTLSData->pGDICache->Trim();
+    }
+
+    // Deletes the bitmap of the calling thread's paint buffer, if it has one.
+    // Called when the display settings change.
+    inline void CWinApp::TrimPaintBuffer()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData != 0 && pTLSData->pPaintBuffer != 0)
+            pTLSData->pPaintBuffer->Trim();
+    }
+
+    // Called by a CWinThread's thread when its message loop ends. The thread
+    // no longer has a message pump, and its GDI cache and paint buffer are
+    // deleted. Its TLS data is also deleted, unless GDI objects, image lists
+    // or menus created by the thread are still in its handle maps.
+    inline void CWinApp::ReleaseTlsData()
+    {
+        TLSData* pTLSData = GetTlsData();
+        if (pTLSData == 0)
+            return;
+
+        // The cached objects are in this thread's handle maps.
+        delete pTLSData->pGDICache;
+        pTLSData->pGDICache = 0;
+        delete pTLSData->pPaintBuffer;
+        pTLSData->pPaintBuffer = 0;
+
+        CThreadLock appLock(m_appLock);
+        pTLSData->pMessagePump = 0;
+        pTLSData->threadID = 0;
+
+        // Only this thread adds to its handle maps, so they stay empty.
+        HandleMaps& maps = pTLSData->maps;
+        bool isEmpty;
+        {
+            CThreadLock mapLock(maps.mapLock);
+            isEmpty = maps.mapCDCData.empty() && maps.mapCGDIData.empty() &&
+                      maps.mapCImlData.empty() && maps.mapCMenuData.empty();
+        }
+
+        if (isEmpty)
+        {
+            std::vector<HandleMaps*>::iterator m;
+            m = std::find(m_allMaps.begin(), m_allMaps.end(), &maps);
+            if (m != m_allMaps.end())
+                m_allMaps.erase(m);
+
+            VERIFY(::TlsSetValue(m_tlsData, NULL));
+            std::vector<TLSDataPtr>::iterator it;
+            for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+            {
+                if ((*it).get() == pTLSData)
+                {
+                    m_allTLSData.erase(it);   // deletes the TLS data
+                    break;
+                }
+            }
+        }
+    }
+
+    // Removes the message pump from the TLS data of the thread that runs it.
+    // Called when a CWinThread is destroyed, in case its thread is still running.
+    inline void CWinApp::RemoveMessagePump(CMessagePump* pPump)
+    {
+        CThreadLock appLock(m_appLock);
+        std::vector<TLSDataPtr>::const_iterator it;
+        for (it = m_allTLSData.begin(); it != m_allTLSData.end(); ++it)
+        {
+            if ((*it)->pMessagePump == pPump)
+            {
+                (*it)->pMessagePump = 0;
+                (*it)->threadID = 0;
+            }
+        }
+    }
+
+    // Removes the shutdown procedures added with the specified parameter.
+    inline void CWinApp::RemoveShutdownProc(LPVOID pParam)
+    {
+        CThreadLock appLock(m_appLock);
+        std::vector<std::pair<PFNTASKPROC, LPVOID> >::iterator it = m_shutdownProcs.begin();
+        while (it != m_shutdownProcs.end())
+        {
+            if (it->second == pParam)
+                it = m_shutdownProcs.erase(it);
+            else
+                ++it;
+        }
+    }
+
     // Creates the Thread Local Storage data for the current thread if none already exists,
     // and returns a pointer to the TLS data.
     inline void CWinApp::SetTlsData()
@@ -430,15 +1460,28 @@ namespace Win32xx
         if (NULL == pTLSData)
         {
             pTLSData = new TLSData;
+            pTLSData->threadID = ::GetCurrentThreadId();
             TLSDataPtr dataPtr(pTLSData);
 
             CThreadLock TLSLock(m_appLock);
             m_allTLSData.push_back(dataPtr); // store as a smart pointer
+            m_allMaps.push_back(&pTLSData->maps);
 
             VERIFY(::TlsSetValue(m_tlsData, pTLSData));
         }
     }
 
+    // Appends the text to the resource log.
+    inline BOOL CWinApp::WriteResourceLog(LPCTSTR text)
+    {
+        TtoA ansiText(text);
+        DWORD length = static_cast<DWORD>(lstrlenA(ansiText.c_str()));
+        DWORD written = 0;
+        BOOL result = ::WriteFile(m_resourceLog, ansiText.c_str(), length, &written, NULL);
+
+        return (result && written == length);
+    }
+
     // Messages used for exceptions.
     inline CString CWinApp::MsgAppThread() const
     { return _T("Failed to create thread."); }
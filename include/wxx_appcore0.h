@@ -65,26 +65,31 @@ namespace Win32xx
     class CClientDCEx;
     class CDataExchange;
     class CDC;
+    class CDCView;
     class CDocker;
     class CFont;
+    class CGDICache;
     class CGDIObject;
     class CImageList;
     class CMDIChild;
     class CMemDC;
     class CMenu;
     class CMenuBar;
+    class CPaintBuffer;
     class CPaintDC;
     class CPalette;
     class CPen;
     class CPropertyPage;
     class CRgn;
     class CString;
+    class CUpdateRegion;
     class CWinApp;
     class CWinThread;
     class CWorkThread;
     class CWindowDC;
     class CWnd;
     struct CDC_Data;
+    struct HandleMaps;
     struct MenuItemData;
     struct TLSData;
 
@@ -139,11 +144,12 @@ namespace Win32xx
     struct CGDI_Data
     {
         // Constructor
-        CGDI_Data() : hGDIObject(0), count(1L), isManagedObject(false) {}
+        CGDI_Data() : hGDIObject(0), count(1L), isManagedObject(false), pMaps(0) {}
 
         HGDIOBJ hGDIObject;
         long    count;
         bool    isManagedObject;
+        HandleMaps* pMaps;      // The maps holding this object, if any
     };
 
 
@@ -151,23 +157,25 @@ namespace Win32xx
     struct CIml_Data
     {
         // Constructor
-        CIml_Data() : images(0), isManagedHiml(false), count(1L) {}
+        CIml_Data() : images(0), isManagedHiml(false), count(1L), pMaps(0) {}
 
         HIMAGELIST  images;
         bool        isManagedHiml;
         long        count;
+        HandleMaps* pMaps;      // The maps holding this object, if any
     };
 
     // A structure that contains the data members for CMenu.
     struct CMenu_Data
     {
         // Constructor
-        CMenu_Data() : menu(0), isManagedMenu(false), count(1L) {}
+        CMenu_Data() : menu(0), isManagedMenu(false), count(1L), pMaps(0) {}
 
         std::vector<MenuPtr> vSubMenus; // A vector of smart pointers to CMenu
         HMENU menu;
         bool isManagedMenu;
         long count;
+        HandleMaps* pMaps;              // The maps holding this object, if any
     };
 
     // The comparison function object used by CWinApp::m_mapHDC
@@ -205,6 +213,114 @@ namespace Win32xx
             {return (reinterpret_cast<DWORD_PTR>(a) < reinterpret_cast<DWORD_PTR>(b));}
     };
 
+    // Maps the handles of GDI objects, image lists and menus to the data of
+    // their wrapper objects. Each thread with TLS data has its own set of maps,
+    // so threads don't contend for a single lock. Threads without TLS data,
+    // such as worker threads, use a set of maps shared by CWinApp.
+    struct HandleMaps
+    {
+        std::map<HDC, CDC_Data*, CompareHDC> mapCDCData;
+        std::map<HGDIOBJ, CGDI_Data*, CompareGDI> mapCGDIData;
+        std::map<HIMAGELIST, CIml_Data*, CompareHIMAGELIST> mapCImlData;
+        std::map<HMENU, CMenu_Data*, CompareHMENU> mapCMenuData;
+        CCriticalSection mapLock;   // thread synchronization for these maps
+    };
+
+    // The allocation statistics for the data of CDC and CGDIObject, recorded
+    // by each thread. Used by CWinApp::GetGDIDataStats.
+    struct GDIDataStats
+    {
+        GDIDataStats() : heapAllocs(0), poolAllocs(0), mapInserts(0) {}
+
+        LONGLONG heapAllocs;    // Data allocated from the heap
+        LONGLONG poolAllocs;    // Data reused from the thread's free lists
+        LONGLONG mapInserts;    // Data added to the thread's handle maps
+    };
+
+    // The handle maps whose sizes are recorded by a ResourceSnapshot.
+    enum HandleMapType
+    {
+        HANDLEMAP_HWND = 0,     // Windows mapped to CWnd objects
+        HANDLEMAP_HDC,          // Device contexts mapped to CDC data
+        HANDLEMAP_GDI,          // GDI objects mapped to CGDIObject data
+        HANDLEMAP_IMAGELIST,    // Image lists mapped to CImageList data
+        HANDLEMAP_MENU,         // Menus mapped to CMenu data
+        HANDLEMAP_TYPES         // The number of handle map types
+    };
+
+    // The resources used by the application at a point in time.
+    // Used by CWinApp::GetResourceSnapshot.
+    struct ResourceSnapshot
+    {
+        ResourceCount resources[RESOURCE_TYPES];  // The counts for each ResourceType
+        size_t mapSizes[HANDLEMAP_TYPES];         // Entries in the handle maps of all threads
+        size_t maxMapSizes[HANDLEMAP_TYPES];      // Largest number of entries seen by a snapshot
+        DWORD gdiHandles;       // GDI handles used by the process
+        DWORD maxGDIHandles;    // Largest number of GDI handles used by the process
+        DWORD userHandles;      // USER handles used by the process
+        DWORD maxUserHandles;   // Largest number of USER handles used by the process
+        DWORD tickCount;        // The value of GetTickCount when the snapshot was taken
+    };
+
+    // The maximum number of blocks kept by a CFreeList.
+    const size_t WXX_MAX_FREE_BLOCKS = 64;
+
+    ///////////////////////////////////////////////////////////////////
+    // CFreeList keeps released memory blocks of the same size, so they
+    // can be reused without returning them to the heap. Each thread with
+    // TLS data has a free list for CDC_Data and one for CGDI_Data. A free
+    // list is only used by the thread that owns it, so it doesn't need
+    // a lock.
+    class CFreeList
+    {
+    public:
+        CFreeList() {}
+        ~CFreeList();
+
+        void* Allocate(size_t size, GDIDataStats& stats);
+        void  Free(void* pBlock);
+
+    private:
+        CFreeList(const CFreeList&);                // Disable copy construction
+        CFreeList& operator = (const CFreeList&);   // Disable assignment operator
+
+        std::vector<void*> m_blocks;
+    };
+
+#ifndef NO_DISPATCH_PROFILER
+
+    // The number of buckets in a dispatch latency histogram. Bucket 0 counts
+    // dispatches under 1us, and bucket n counts those under 2^n us.
+    const int PROFILE_BUCKETS = 24;
+
+    // The dispatch statistics for a message or a CWnd class.
+    struct DispatchStats
+    {
+        DispatchStats() : count(0), totalTicks(0), maxTicks(0)
+            { ZeroMemory(histogram, sizeof(histogram)); }
+
+        LONGLONG count;         // Number of dispatches
+        LONGLONG totalTicks;    // Cumulative time in performance counter ticks
+        LONGLONG maxTicks;      // Longest time in performance counter ticks
+        LONGLONG histogram[PROFILE_BUCKETS];  // Log-scale latency histogram
+    };
+
+    // The dispatch statistics recorded by a thread. Used by CWinApp's
+    // dispatch profiler.
+    struct DispatchProfile
+    {
+        DispatchProfile() : childTicks(0) {}
+
+        std::map<UINT, DispatchStats> messages;     // WndProc time by message
+        std::map<ATOM, DispatchStats> classes;      // WndProc time by window class atom
+        std::map<ATOM, std::basic_string<TCHAR> > classNames;  // The name of each window class
+        std::map<UINT, DispatchStats> queued;       // MessageLoop time by message
+        CCriticalSection profileLock;   // thread synchronization for these maps
+        LONGLONG childTicks;            // time taken by the dispatches nested in the current one
+    };
+
+#endif // NO_DISPATCH_PROFILER
+
     // Used for Thread Local Storage (TLS)
     struct TLSData
     {
@@ -213,8 +329,24 @@ namespace Win32xx
         CMenuBar* pMenuBar; // Pointer to CMenuBar object used for the WH_MSGFILTER hook
         HHOOK msgHook;      // WH_MSGFILTER hook for CMenuBar and modal dialogs
         long  dlgHooks;     // Number of dialog MSG hooks
-
-        TLSData() : pWnd(0), mainWnd(0), pMenuBar(0), msgHook(0), dlgHooks(0) {} // Constructor
+        HandleMaps maps;    // Handle maps for the objects created by this thread
+        CMessagePump* pMessagePump; // The CWinApp or CWinThread running this thread's message loop
+        DWORD threadID;     // The ID of the thread that owns this data
+        CFreeList dcDataPool;       // Released CDC_Data memory for reuse
+        CFreeList gdiDataPool;      // Released CGDI_Data memory for reuse
+        GDIDataStats gdiStats;      // Allocation statistics for CDC and CGDIObject data
+        CGDICache* pGDICache;       // The thread's cache of pens, brushes and fonts
+        CPaintBuffer* pPaintBuffer; // The thread's back buffer for double buffered painting
+#ifndef NO_DISPATCH_PROFILER
+        DispatchProfile profile;  // Dispatch statistics recorded by this thread
+#endif
+        std::vector<CWnd*> preTranslateChain;  // Windows that pre-translate messages for preTranslateWnd
+        HWND preTranslateWnd;   // The window the preTranslateChain was built for
+        LONG preTranslateGen;   // CWinApp's pre-translation generation when the chain was built
+
+        TLSData() : pWnd(0), mainWnd(0), pMenuBar(0), msgHook(0), dlgHooks(0),
+                    pMessagePump(0), threadID(0), pGDICache(0), pPaintBuffer(0), preTranslateWnd(0),
+                    preTranslateGen(0) {} // Constructor
     };
 
 
@@ -226,15 +358,18 @@ namespace Win32xx
     class CWinApp : public CMessagePump
     {
         // Provide these access to CWinApp's private members:
+        friend class CAsyncTask;
         friend class CDC;
         friend class CDialog;
         friend class CGDIObject;
         friend class CImageList;
         friend class CMenu;
+        friend class CMessagePump;
         friend class CPageSetupDialog;
         friend class CPrintDialog;
         friend class CPrintDialogEx;
         friend class CPropertyPage;
+        friend class CThreadPool;
         friend class CWinThread;
         friend class CWnd;
         friend CWinApp* GetApp();
@@ -245,8 +380,12 @@ namespace Win32xx
 
         // Operations
         CWnd* GetCWndFromMap(HWND wnd);
+        CGDICache* GetGDICache();
+        GDIDataStats GetGDIDataStats() const;
         HINSTANCE GetInstanceHandle() const { return m_instance; }
         HWND      GetMainWnd() const;
+        CMessagePump* GetMessagePump(DWORD threadID);
+        CPaintBuffer* GetPaintBuffer();
         HINSTANCE GetResourceHandle() const { return (m_resource ? m_resource : m_instance); }
         TLSData*  GetTlsData() const;
         HCURSOR   LoadCursor(LPCTSTR resourceName) const;
@@ -257,44 +396,101 @@ namespace Win32xx
         HANDLE    LoadImage(int imageID, UINT type, int cx, int cy, UINT flags = LR_DEFAULTCOLOR) const;
         HCURSOR   LoadStandardCursor(LPCTSTR cursorName) const;
         HICON     LoadStandardIcon(LPCTSTR iconName) const;
+        BOOL      PostThreadTask(DWORD threadID, PFNTASKPROC pfnTask, LPVOID pParam);
+        void      ResetGDIDataStats();
         HCURSOR   SetCursor(HCURSOR cursor) const;
         void      SetMainWnd(HWND wnd) const;
         void      SetResourceHandle(HINSTANCE resource);
+        void      TrimGDICache();
+        void      TrimPaintBuffer();
+
+#ifndef NO_DISPATCH_PROFILER
+        // Dispatch profiler
+        BOOL DumpDispatchProfile(LPCTSTR fileName);
+        void EnableDispatchProfile(BOOL enable = TRUE);
+        BOOL IsDispatchProfileEnabled() const { return (m_isProfiling != 0); }
+        void ResetDispatchProfile();
+#endif
+
+        // Resource telemetry
+        LPCTSTR GetHandleMapName(HandleMapType type) const;
+        LPCTSTR GetResourceName(ResourceType type) const;
+        ResourceSnapshot GetResourceSnapshot();
+        BOOL IsResourceLogging() const { return (m_resourceLog != INVALID_HANDLE_VALUE); }
+        BOOL StartResourceLog(LPCTSTR fileName, UINT interval);
+        void StopResourceLog();
 
     private:
         CWinApp(const CWinApp&);                // Disable copy construction
         CWinApp& operator = (const CWinApp&);   // Disable assignment operator
 
-        void AddCDCData(HDC dc, CDC_Data* pData);
-        void AddCGDIData(HGDIOBJ gdi, CGDI_Data* pData);
-        void AddCImlData(HIMAGELIST images, CIml_Data* pData);
-        void AddCMenuData(HMENU menu, CMenu_Data* pData);
+        CDC_Data*   AddCDCData(HDC dc, CDC_Data* pData);
+        CGDI_Data*  AddCGDIData(HGDIOBJ gdi, CGDI_Data* pData);
+        CIml_Data*  AddCImlData(HIMAGELIST images, CIml_Data* pData);
+        CMenu_Data* AddCMenuData(HMENU menu, CMenu_Data* pData);
+        void AddShutdownProc(PFNTASKPROC pfnProc, LPVOID pParam);
         CDC_Data*   GetCDCData(HDC dc);
         CGDI_Data*  GetCGDIData(HGDIOBJ object);
         CIml_Data*  GetCImlData(HIMAGELIST images);
         CMenu_Data* GetCMenuData(HMENU menu);
+        HandleMaps& GetHandleMaps();
+        CCriticalSection& GetMapLock(HandleMaps* pMaps);
+        CString FormatResourceLog(const ResourceSnapshot& snapshot) const;
+        CString FormatResourceLogHeader() const;
+        BOOL RemoveCDCData(CDC_Data* pData);
+        BOOL RemoveCGDIData(CGDI_Data* pData);
+        BOOL RemoveCImlData(CIml_Data* pData);
+        BOOL RemoveCMenuData(CMenu_Data* pData);
+        void ReleaseTlsData();
+        void RemoveMessagePump(CMessagePump* pPump);
+        void RemoveShutdownProc(LPVOID pParam);
         void SetCallback();
         void SetTlsData();
+        std::vector<CWnd*>& GetPreTranslateChain(TLSData& tlsData, HWND wnd);
+        void ResetPreTranslateChains();
         void UpdateDefaultPrinter();
-
+        BOOL WriteResourceLog(LPCTSTR text);
+
+#ifndef NO_DISPATCH_PROFILER
+        void AddDispatchTime(DispatchStats& stats, LONGLONG ticks) const;
+        CString FormatDispatchStats(LPCTSTR section, LPCTSTR key, const DispatchStats& stats) const;
+        void MergeDispatchStats(DispatchStats& total, const DispatchStats& stats) const;
+        void RecordQueuedMessage(UINT msg, LONGLONG start);
+        void RecordWndProc(TLSData& tlsData, HWND wnd, ATOM classAtom, UINT msg, LONGLONG ticks);
+        static LONGLONG GetProfileCounter();
+#endif
+
+        static ResourceType GetResourceType(HGDIOBJ object);
+        static void CALLBACK ResourceLogProc(HWND wnd, UINT msg, UINT_PTR eventID, DWORD time);
         static CWinApp* SetnGetThis(CWinApp* pThis = 0, bool reset = false);
 
-        std::map<HDC, CDC_Data*, CompareHDC> m_mapCDCData;
-        std::map<HGDIOBJ, CGDI_Data*, CompareGDI> m_mapCGDIData;
-        std::map<HIMAGELIST, CIml_Data*, CompareHIMAGELIST> m_mapCImlData;
-        std::map<HMENU, CMenu_Data*, CompareHMENU> m_mapCMenuData;
         std::map<HWND, CWnd*, CompareHWND> m_mapHWND;       // maps window handles to CWnd objects
         std::vector<TLSDataPtr> m_allTLSData;     // vector of TLSData smart pointers, one for each thread
+        std::vector<HandleMaps*> m_allMaps;       // the handle maps of each thread, and the shared maps
+        std::vector<std::pair<PFNTASKPROC, LPVOID> > m_shutdownProcs;  // called when the CWinApp is destroyed
+        HandleMaps m_sharedMaps;      // handle maps for threads without TLS data
         CCriticalSection m_appLock;   // thread synchronization for CWinApp and TLS.
-        CCriticalSection m_gdiLock;   // thread synchronization for m_mapCDCData and m_mapCGDIData.
-        CCriticalSection m_wndLock;   // thread synchronization for m_mapHWND etc.
+        CCriticalSection m_wndLock;   // thread synchronization for m_mapHWND.
         CCriticalSection m_printLock; // thread synchronization for printing.
+        ATOM m_wndProp;               // atom of the window property that stores the CWnd pointer
+        LONG m_wndPropFailures;       // number of windows whose CWnd pointer property couldn't be set
+        LONG m_preTranslateGen;       // incremented when cached pre-translation chains become invalid
         HINSTANCE m_instance;         // handle to the application's instance
         HINSTANCE m_resource;         // handle to the application's resources
         DWORD m_tlsData;              // Thread Local Storage data
         WNDPROC m_callback;           // callback address of CWnd::StaticWndowProc
         CHGlobal m_devMode;           // Used by CPrintDialog and CPageSetupDialog
         CHGlobal m_devNames;          // Used by CPrintDialog and CPageSetupDialog
+        size_t m_maxMapSizes[HANDLEMAP_TYPES];  // largest handle map sizes seen by GetResourceSnapshot
+        DWORD m_maxGDIHandles;        // largest GDI handle count seen by GetResourceSnapshot
+        DWORD m_maxUserHandles;       // largest USER handle count seen by GetResourceSnapshot
+        HANDLE m_resourceLog;         // file written by the resource snapshot logger
+        UINT_PTR m_resourceLogTimer;  // thread timer that writes the resource snapshots
+
+#ifndef NO_DISPATCH_PROFILER
+        LONGLONG m_profileFrequency;  // performance counter frequency used by the profiler
+        LONG m_isProfiling;           // non-zero while the dispatch profiler is enabled
+#endif
 
     public:
         // Messages used for exceptions.
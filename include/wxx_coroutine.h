@@ -0,0 +1,446 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// wxx_coroutine.h
+//  This file contains the declarations and definitions of the awaitable
+//  classes used by C++20 coroutines. They allow a coroutine to move its
+//  work to the thread pool, and then resume on the thread that runs a
+//  window's message loop. A coroutine can also wait for a kernel handle
+//  or an overlapped I/O operation without blocking the message loop.
+//
+//  These classes require a compiler that supports C++20 coroutines,
+//  such as Visual Studio 2019 version 16.8 or later with /std:c++20.
+//  They are omitted for other compilers.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+// A coroutine returning CAsyncTask runs until its first co_await
+// suspends it, and then returns to the caller.
+CAsyncTask CMainFrame::OnAddFolder()
+{
+    CString folder = ChooseFolder();
+
+    // The rest of the coroutine runs on a thread pool thread.
+    co_await ResumeBackground();
+    std::vector<MovieInfo> movies = LoadMovies(folder);
+
+    // The rest of the coroutine runs on the frame's thread.
+    co_await ResumeForeground(*this);
+    AddMovies(movies);
+}
+
+// Waits for an event without blocking the message loop.
+CAsyncTask CMainFrame::WaitForStop()
+{
+    co_await WaitForHandle(m_stopEvent);
+    SetStatusText(_T("Stopped"));
+}
+
+*/
+
+
+#ifndef _WIN32XX_COROUTINE_H_
+#define _WIN32XX_COROUTINE_H_
+
+#include "wxx_wincore.h"
+#include "wxx_threadpool.h"
+
+#if defined (__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+
+
+namespace Win32xx
+{
+
+    /////////////////////////////////////////////////////////////////
+    // CAsyncTask is the return type of a coroutine that runs
+    // independently of its caller. The coroutine starts immediately
+    // and its frame is destroyed when it finishes. An exception that
+    // isn't handled by the coroutine ends the coroutine, and is passed
+    // to the handler set with SetExceptionHandler. The handler is
+    // called by the message loop of the thread that started the
+    // coroutine, or by the current thread if that thread has no message
+    // loop. Without a handler, the exception is reported with TRACE and
+    // std::terminate is called.
+    class CAsyncTask
+    {
+    public:
+        typedef void (*PFNEXCEPTIONPROC)(std::exception_ptr exception);
+
+        struct promise_type
+        {
+            promise_type() : threadID(::GetCurrentThreadId()) {}
+
+            CAsyncTask get_return_object() noexcept { return CAsyncTask(); }
+            std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+            std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept;
+
+            DWORD threadID;     // the thread that started the coroutine
+        };
+
+        static void SetExceptionHandler(PFNEXCEPTIONPROC pfnHandler);
+
+    private:
+        static std::atomic<PFNEXCEPTIONPROC>& GetExceptionHandler();
+        static void ReportException(std::exception_ptr exception) noexcept;
+        static void WINAPI StaticReport(LPVOID pException);
+    };
+
+
+    //////////////////////////////////////////////////////////
+    // CResumeBackground is an awaitable that resumes the
+    // coroutine on a thread pool thread. Use ResumeBackground
+    // to create it.
+    class CResumeBackground
+    {
+    public:
+        explicit CResumeBackground(CThreadPool& pool) : m_pool(pool) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_resume() const noexcept {}
+        void await_suspend(std::coroutine_handle<> coroutine);
+
+    private:
+        static void WINAPI StaticResume(LPVOID pCoroutine);
+
+        CThreadPool& m_pool;
+    };
+
+
+    //////////////////////////////////////////////////////////
+    // CResumeForeground is an awaitable that resumes the
+    // coroutine on the thread that runs the message loop of a
+    // CWinApp or CWinThread. Use ResumeForeground to create it.
+    class CResumeForeground
+    {
+    public:
+        explicit CResumeForeground(CMessagePump* pPump) : m_pPump(pPump) {}
+
+        bool await_ready() const;
+        void await_resume() const noexcept {}
+        bool await_suspend(std::coroutine_handle<> coroutine);
+
+    private:
+        static void WINAPI StaticResume(LPVOID pCoroutine);
+
+        CMessagePump* m_pPump;
+    };
+
+
+    //////////////////////////////////////////////////////////
+    // CWaitForHandle is an awaitable that resumes the coroutine
+    // when a kernel handle, such as a CEvent, CMutex, CSemaphore
+    // or thread handle, is signalled. On a thread that runs a
+    // message loop, the message loop waits for the handle and
+    // continues to process messages. Other threads block until
+    // the handle is signalled. A handle should only be awaited by
+    // one coroutine at a time. Use WaitForHandle to create it.
+    class CWaitForHandle
+    {
+    public:
+        explicit CWaitForHandle(HANDLE handle) : m_handle(handle), m_pPump(0) {}
+
+        bool await_ready() const;
+        void await_resume() const noexcept {}
+        bool await_suspend(std::coroutine_handle<> coroutine);
+
+    private:
+        static BOOL WINAPI StaticWaitProc(HANDLE handle, LPVOID pAwaiter);
+
+        HANDLE m_handle;
+        CMessagePump* m_pPump;
+        std::coroutine_handle<> m_coroutine;
+    };
+
+
+    //////////////////////////////////////////////////////////
+    // CWaitForOverlapped is an awaitable that resumes the
+    // coroutine when an overlapped I/O operation completes. The
+    // operation's OVERLAPPED structure must have a manual-reset
+    // event, and the file or socket must be opened for
+    // overlapped I/O. co_await returns the result of
+    // GetOverlappedResult. Use WaitForOverlapped to create it.
+    class CWaitForOverlapped : public CWaitForHandle
+    {
+    public:
+        CWaitForOverlapped(HANDLE file, OVERLAPPED& overlapped, DWORD& bytesTransferred)
+            : CWaitForHandle(overlapped.hEvent), m_file(file), m_overlapped(overlapped),
+              m_bytesTransferred(bytesTransferred) {}
+
+        BOOL await_resume() const;
+
+    private:
+        HANDLE m_file;
+        OVERLAPPED& m_overlapped;
+        DWORD& m_bytesTransferred;
+    };
+
+}
+
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+
+namespace Win32xx
+{
+
+    ////////////////////////////////////////////////
+    // Definitions for the CAsyncTask class
+    //
+
+    // Called when the coroutine doesn't handle an exception. The exception
+    // isn't rethrown, so the coroutine finishes and its frame is destroyed.
+    // The exception is posted to the message loop of the thread that started
+    // the coroutine, and reported immediately if it can't be posted.
+    inline void CAsyncTask::promise_type::unhandled_exception() noexcept
+    {
+        std::exception_ptr exception = std::current_exception();
+        if (::GetCurrentThreadId() != threadID)
+        {
+            try
+            {
+                std::exception_ptr* pException = new std::exception_ptr(exception);
+                CWinApp* pApp = CWinApp::SetnGetThis();
+                if (pApp != 0 && pApp->PostThreadTask(threadID, StaticReport, pException))
+                    return;
+
+                delete pException;
+            }
+
+            catch (...)
+            {
+                // Report the coroutine's exception if it can't be posted.
+            }
+        }
+
+        ReportException(exception);
+    }
+
+    // Returns the handler set by SetExceptionHandler.
+    inline std::atomic<CAsyncTask::PFNEXCEPTIONPROC>& CAsyncTask::GetExceptionHandler()
+    {
+        static std::atomic<PFNEXCEPTIONPROC> handler(nullptr);
+        return handler;
+    }
+
+    // Passes an exception that wasn't handled by a coroutine to the
+    // handler. Calls std::terminate if there's no handler, or the handler
+    // throws an exception.
+    inline void CAsyncTask::ReportException(std::exception_ptr exception) noexcept
+    {
+        PFNEXCEPTIONPROC pfnHandler = GetExceptionHandler().load();
+        if (pfnHandler != nullptr)
+            pfnHandler(exception);
+        else
+        {
+            TRACE("*** Error: Unhandled exception in a CAsyncTask coroutine. ***\n");
+            std::terminate();
+        }
+    }
+
+    // Sets the function called with the exceptions that coroutines don't
+    // handle. The handler mustn't throw. Set it to nullptr to call
+    // std::terminate instead.
+    inline void CAsyncTask::SetExceptionHandler(PFNEXCEPTIONPROC pfnHandler)
+    {
+        GetExceptionHandler().store(pfnHandler);
+    }
+
+    // Reports the exception posted by unhandled_exception. Called by the
+    // message loop of the thread that started the coroutine.
+    inline void WINAPI CAsyncTask::StaticReport(LPVOID pException)
+    {
+        std::exception_ptr* pStored = static_cast<std::exception_ptr*>(pException);
+        std::exception_ptr exception = *pStored;
+        delete pStored;
+        ReportException(exception);
+    }
+
+
+    ////////////////////////////////////////////////
+    // Definitions for the CResumeBackground class
+    //
+
+    // Queues the coroutine to resume on a thread pool thread.
+    inline void CResumeBackground::await_suspend(std::coroutine_handle<> coroutine)
+    {
+        m_pool.QueueTask(StaticResume, coroutine.address());
+    }
+
+    // Resumes the coroutine. Called by a thread pool thread.
+    inline void WINAPI CResumeBackground::StaticResume(LPVOID pCoroutine)
+    {
+        std::coroutine_handle<>::from_address(pCoroutine).resume();
+    }
+
+
+    ////////////////////////////////////////////////
+    // Definitions for the CResumeForeground class
+    //
+
+    // Returns true if the coroutine is already running on the message
+    // loop's thread, or there is no message loop to resume on.
+    inline bool CResumeForeground::await_ready() const
+    {
+        TLSData* pTLSData = GetApp()->GetTlsData();
+        return (m_pPump == 0) || (pTLSData != 0 && pTLSData->pMessagePump == m_pPump);
+    }
+
+    // Posts the coroutine to the message loop. Returns false to resume
+    // the coroutine immediately if it can't be posted.
+    inline bool CResumeForeground::await_suspend(std::coroutine_handle<> coroutine)
+    {
+        return (m_pPump->PostTask(StaticResume, coroutine.address()) != FALSE);
+    }
+
+    // Resumes the coroutine. Called by the message loop.
+    inline void WINAPI CResumeForeground::StaticResume(LPVOID pCoroutine)
+    {
+        std::coroutine_handle<>::from_address(pCoroutine).resume();
+    }
+
+
+    ////////////////////////////////////////////////
+    // Definitions for the CWaitForHandle class
+    //
+
+    // Returns true if the handle is already signalled. Waiting on a mutex,
+    // semaphore or auto-reset event acquires it.
+    inline bool CWaitForHandle::await_ready() const
+    {
+        DWORD result = ::WaitForSingleObject(m_handle, 0);
+        return (result == WAIT_OBJECT_0 || result == WAIT_ABANDONED);
+    }
+
+    // Adds the handle to the message loop's wait handles. Threads without a
+    // message loop block until the handle is signalled, and return false to
+    // resume the coroutine immediately.
+    inline bool CWaitForHandle::await_suspend(std::coroutine_handle<> coroutine)
+    {
+        TLSData* pTLSData = GetApp()->GetTlsData();
+        m_pPump = (pTLSData != 0) ? pTLSData->pMessagePump : 0;
+        m_coroutine = coroutine;
+
+        if (m_pPump != 0 && m_pPump->AddWaitHandle(m_handle, StaticWaitProc, this))
+            return true;
+
+        ::WaitForSingleObject(m_handle, INFINITE);
+        return false;
+    }
+
+    // Called by the message loop when the handle is signalled.
+    inline BOOL WINAPI CWaitForHandle::StaticWaitProc(HANDLE handle, LPVOID pAwaiter)
+    {
+        CWaitForHandle* pWait = static_cast<CWaitForHandle*>(pAwaiter);
+
+        // The awaiter belongs to the coroutine's frame, which can be destroyed
+        // when the coroutine resumes. The coroutine can also await the handle
+        // again, so the handle is removed before the coroutine resumes.
+        std::coroutine_handle<> coroutine = pWait->m_coroutine;
+        pWait->m_pPump->RemoveWaitHandle(handle);
+        coroutine.resume();
+
+        return TRUE;
+    }
+
+
+    ////////////////////////////////////////////////
+    // Definitions for the CWaitForOverlapped class
+    //
+
+    // Retrieves the result of the overlapped operation.
+    inline BOOL CWaitForOverlapped::await_resume() const
+    {
+        return ::GetOverlappedResult(m_file, &m_overlapped, &m_bytesTransferred, FALSE);
+    }
+
+
+    ////////////////////////////////////////
+    // Global functions
+    //
+
+    // Returns an awaitable that resumes the coroutine on a thread pool thread.
+    inline CResumeBackground ResumeBackground(CThreadPool& pool = GetThreadPool())
+    {
+        return CResumeBackground(pool);
+    }
+
+    // Returns an awaitable that resumes the coroutine on the thread that runs
+    // the message loop of the CWinApp or CWinThread.
+    inline CResumeForeground ResumeForeground(CMessagePump& pump)
+    {
+        return CResumeForeground(&pump);
+    }
+
+    // Returns an awaitable that resumes the coroutine on the thread that
+    // created the window. The coroutine isn't suspended if that thread
+    // doesn't run a Win32++ message loop.
+    inline CResumeForeground ResumeForeground(const CWnd& wnd)
+    {
+        DWORD threadID = ::GetWindowThreadProcessId(wnd, NULL);
+        return CResumeForeground(GetApp()->GetMessagePump(threadID));
+    }
+
+    // Returns an awaitable that resumes the coroutine when the handle is signalled.
+    inline CWaitForHandle WaitForHandle(HANDLE handle)
+    {
+        return CWaitForHandle(handle);
+    }
+
+    // Returns an awaitable that resumes the coroutine when the overlapped
+    // I/O operation completes.
+    inline CWaitForOverlapped WaitForOverlapped(HANDLE file, OVERLAPPED& overlapped, DWORD& bytesTransferred)
+    {
+        return CWaitForOverlapped(file, overlapped, bytesTransferred);
+    }
+
+}
+
+#endif // defined (__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+
+#endif // _WIN32XX_COROUTINE_H_
@@ -56,10 +56,12 @@
 //    references or const references when used as function arguments. As a result there
 //    is no need for functions like LockBuffer and UnLockBuffer.
 //
-// 3) The Format functions only accepts POD (Plain Old Data) arguments. It does not
-//    accept arguments which are class or struct objects. In particular it does not
-//    accept CString objects, unless these are cast to LPCTSTR.
-//    This is demonstrates valid and invalid usage:
+// 3) The printf style Format functions only accepts POD (Plain Old Data) arguments. They
+//    do not accept arguments which are class or struct objects. In particular they do not
+//    accept CString objects, unless these are cast to LPCTSTR. Compilers that support
+//    variadic templates (WXX_VARIADIC_TEMPLATES is defined) can use FormatT and
+//    AppendFormatT instead, which also accept CString objects.
+//    This is demonstrates valid and invalid usage for the printf style functions:
 //      CString string1(_T("Hello World"));
 //      CString string2;
 //
@@ -96,6 +98,73 @@
 
 namespace Win32xx
 {
+    // The number of characters formatted on the stack before using the heap.
+    const int WXX_FORMAT_BUFFER_SIZE = 256;
+
+    // The number of characters in the first chunk of a CStringBuilderT.
+    const int WXX_BUILDER_CHUNK_SIZE = 256;
+
+    class CFormatArg;
+    template <class T> class CStringBuilderT;
+
+    /////////////////////////////////////////////////
+    // CFormatBuffer holds the text produced by the CStringT Format functions.
+    // The text is kept in a buffer on the stack, and only moves to the heap
+    // if it doesn't fit.
+    template <class T>
+    class CFormatBuffer
+    {
+    public:
+        CFormatBuffer() : m_length(0), m_isOverflow(false) {}
+
+        void Append(const T* text, int length);
+        void Append(T ch)               { Append(&ch, 1); }
+        void AppendTo(std::basic_string<T>& str) const;
+        void AssignTo(std::basic_string<T>& str);
+        void Commit(int length);
+        int  GetFreeSpace() const;
+        T*   Reserve(int length);
+
+    private:
+        CFormatBuffer(const CFormatBuffer&);              // Disable copy construction
+        CFormatBuffer& operator = (const CFormatBuffer&); // Disable assignment operator
+
+        T m_text[WXX_FORMAT_BUFFER_SIZE];
+        std::basic_string<T> m_overflow;    // Holds the text when it doesn't fit in m_text
+        int m_length;
+        bool m_isOverflow;
+    };
+
+    /////////////////////////////////////////////////
+    // CTextScan provides the character scanning used by the CStringT search
+    // and case conversion functions. It uses SSE2 when the processor supports
+    // it, like the text conversions. Define NO_TEXTCONV_SIMD to use only the
+    // scalar code.
+    class CTextScan
+    {
+    public:
+        static int  FindChar(const CHAR* str, int length, CHAR ch);
+        static int  FindChar(const WCHAR* str, int length, WCHAR ch);
+        static int  FindPair(const CHAR* str, int count, CHAR first, CHAR last, int offset);
+        static int  FindPair(const WCHAR* str, int count, WCHAR first, WCHAR last, int offset);
+        static void MakeLower(CHAR* str, int length);
+        static void MakeLower(WCHAR* str, int length);
+        static void MakeUpper(CHAR* str, int length);
+        static void MakeUpper(WCHAR* str, int length);
+
+    private:
+        static CHAR  ToLower(CHAR ch);
+        static WCHAR ToLower(WCHAR ch);
+        static CHAR  ToUpper(CHAR ch);
+        static WCHAR ToUpper(WCHAR ch);
+
+#ifdef WXX_TEXTCONV_SSE2
+        WXX_TARGET_SSE2 static int  FindPairSSE2(const CHAR* str, int count, CHAR first, CHAR last, int offset);
+        WXX_TARGET_SSE2 static int  FindPairSSE2(const WCHAR* str, int count, WCHAR first, WCHAR last, int offset);
+        WXX_TARGET_SSE2 static int  ChangeCaseSSE2(CHAR* str, int length, CHAR from, int delta);
+        WXX_TARGET_SSE2 static int  ChangeCaseSSE2(WCHAR* str, int length, WCHAR from, int delta);
+#endif
+    };
 
     /////////////////////////////////////////////////
     // CStringT is a class template used to implement
@@ -103,6 +172,8 @@ namespace Win32xx
     template <class T>
     class CStringT
     {
+        friend class CStringBuilderT<T>;
+
         // Friend functions allow the left hand side to be something other than CStringT
 
         // These specialized friend declarations are compatible with all supported compilers
@@ -136,6 +207,11 @@ namespace Win32xx
         CStringT(T ch, int repeat = 1);
         CStringT(const T * text, int length);
 
+#ifdef WXX_MOVE_SEMANTICS
+        CStringT(CStringT&& str) WXX_NOEXCEPT;
+        CStringT& operator = (CStringT&& str) WXX_NOEXCEPT;
+#endif
+
         CStringT& operator = (const CStringT& str);
         CStringT& operator = (const T ch);
         CStringT& operator = (const T* text);
@@ -160,6 +236,7 @@ namespace Win32xx
         BSTR     AllocSysString() const;
         void     AppendFormat(const T* format,...);
         void     AppendFormat(UINT formatID, ...);
+        void     AppendFormatV(const T* format, va_list args);
         void     Assign(const T* text, int count);
         int      Collate(const T* text) const;
         int      CollateNoCase(const T* text) const;
@@ -212,17 +289,34 @@ namespace Win32xx
         void     TrimRight(const T* targets);
         void     Truncate(int newLength);
 
+#ifdef WXX_VARIADIC_TEMPLATES
+        template <class... Args> void AppendFormatT(const T* format, const Args&... args);
+        template <class... Args> void FormatT(const T* format, const Args&... args);
+#endif
+
     protected:
         std::basic_string<T> m_str;
-        std::vector<T> m_buf;
 
     private:
+#ifdef WXX_VARIADIC_TEMPLATES
+        static bool AppendArg(CFormatBuffer<T>& buffer, const CFormatArg& arg, T type, UINT flags, int width, int precision);
+        static void AppendArgs(CFormatBuffer<T>& buffer, const T* format, const CFormatArg* args, int count);
+        static void AppendPadded(CFormatBuffer<T>& buffer, const T* text, int length, bool isNegative, UINT flags, int width);
+        static void AppendSpec(CFormatBuffer<T>& buffer, const CFormatArg& arg, T type, const T* flagText, int flagCount, UINT flags, int width, int precision);
+        static void AppendText(CFormatBuffer<T>& buffer, const T* format, ...);
+        static int  FormatInteger(T* text, ULONGLONG value, int base, bool isUpper);
+#endif
+        static void AppendTextV(CFormatBuffer<T>& buffer, const T* format, va_list args);
+        static int  FindText(const T* str, int length, const T* text, int textLength);
+        static int  FindTextHorspool(const T* str, int length, const T* text, int textLength);
+        static int  FormatLength(const T* format, va_list args);
+        static int  FormatText(T* text, int size, const T* format, va_list args);
+        int         ReplaceText(const T* oldText, int oldLength, const T* newText, int newLength);
+
         int     lstrlenT(const CHAR* text) const  { return lstrlenA(text); }
         int     lstrlenT(const WCHAR* text) const { return lstrlenW(text); }
 
-        // These functions return CHAR instead of int.
-        static CHAR ToLower(CHAR c) { return ::tolower(c) & 0xFF; }
-        static CHAR ToUpper(CHAR c) { return ::toupper(c) & 0xFF; }
+        int     m_bufferLength;     // The length requested by GetBuffer, or -1 if the buffer isn't locked
     };
 
     // CStringA is a char only version of CString
@@ -253,6 +347,23 @@ namespace Win32xx
         CString(LPCSTR text, int length)       : CStringT<TCHAR>(AtoT(text, CP_ACP, length), length) {}
         CString(LPCWSTR text, int length)      : CStringT<TCHAR>(WtoT(text, CP_ACP, length), length) {}
 
+#ifdef WXX_MOVE_SEMANTICS
+        CString(CString&& str) WXX_NOEXCEPT    : CStringT<TCHAR>(std::move(str)) {}
+
+        CString& operator = (CString&& str) WXX_NOEXCEPT
+        {
+            CStringT<TCHAR>::operator = (std::move(str));
+            return *this;
+        }
+
+        // Used by Left, Mid, Right etc. to take the result without copying it.
+        CString& operator = (CStringT<TCHAR>&& str) WXX_NOEXCEPT
+        {
+            CStringT<TCHAR>::operator = (std::move(str));
+            return *this;
+        }
+#endif
+
         CString(char ch, int repeat = 1)
         {
             for (int i = 0; i < repeat; ++i)
@@ -398,6 +509,115 @@ namespace Win32xx
 
     };
 
+    /////////////////////////////////////////////////
+    // CStringBuilderT assembles text from many pieces. The text is held in a
+    // list of chunks. Each new chunk is as large as the text before it, so
+    // the chunks grow geometrically, and appending never moves the text
+    // already added. ToString copies the text to a CStringT with a single
+    // allocation. MoveTo hands a single chunk to a CStringT without copying,
+    // and c_str joins the chunks so the text can be passed to functions
+    // such as SetWindowText.
+    template <class T>
+    class CStringBuilderT
+    {
+    public:
+        CStringBuilderT() : m_length(0) {}
+
+        CStringBuilderT& Append(const T* text);
+        CStringBuilderT& Append(const T* text, int length);
+        CStringBuilderT& Append(const CStringT<T>& str);
+        CStringBuilderT& Append(T ch, int repeat = 1);
+        CStringBuilderT& AppendFormat(const T* format, ...);
+        CStringBuilderT& AppendFormatV(const T* format, va_list args);
+        CStringBuilderT& AppendLine();
+        CStringBuilderT& AppendLine(const T* text);
+        CStringBuilderT& AppendLine(const CStringT<T>& str);
+        const T*    c_str();
+        void        Clear();
+        int         GetLength() const   { return m_length; }
+        bool        IsEmpty() const     { return m_length == 0; }
+        void        MoveTo(CStringT<T>& str);
+        CStringT<T> ToString() const;
+
+#ifdef WXX_VARIADIC_TEMPLATES
+        template <class... Args> CStringBuilderT& AppendFormatT(const T* format, const Args&... args);
+#endif
+
+    private:
+        CStringBuilderT(const CStringBuilderT&);              // Disable copy construction
+        CStringBuilderT& operator = (const CStringBuilderT&); // Disable assignment operator
+
+        std::basic_string<T>& AddChunk(int length);
+
+        std::list<std::basic_string<T> > m_chunks;
+        CStringT<T> m_format;       // Holds formatted text before it's appended
+        int m_length;
+    };
+
+    // CStringBuilderA is a char only version of CStringBuilder
+    typedef CStringBuilderT<CHAR> CStringBuilderA;
+
+    // CStringBuilderW is a WCHAR only version of CStringBuilder
+    typedef CStringBuilderT<WCHAR> CStringBuilderW;
+
+    // CStringBuilder builds TCHAR text for a CString
+    typedef CStringBuilderT<TCHAR> CStringBuilder;
+
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    /////////////////////////////////////////////////
+    // CFormatArg holds an argument passed to CStringT::FormatT and
+    // CStringT::AppendFormatT, along with its type.
+    class CFormatArg
+    {
+    public:
+        enum FormatArgType { FORMAT_INT, FORMAT_UINT, FORMAT_INT64, FORMAT_UINT64, FORMAT_CHAR,
+                             FORMAT_WCHAR, FORMAT_DOUBLE, FORMAT_STRING, FORMAT_WSTRING, FORMAT_POINTER };
+
+        // The flags of a format specifier.
+        enum FormatFlags { FLAG_LEFT = 1, FLAG_ZERO = 2, FLAG_OTHER = 4 };
+
+        CFormatArg(int value)                   : m_type(FORMAT_INT), m_length(-1)     { m_value.integer = value; }
+        CFormatArg(unsigned int value)          : m_type(FORMAT_UINT), m_length(-1)    { m_value.integer = value; }
+        CFormatArg(long value)                  : m_type(FORMAT_INT), m_length(-1)     { m_value.integer = value; }
+        CFormatArg(unsigned long value)         : m_type(FORMAT_UINT), m_length(-1)    { m_value.integer = value; }
+        CFormatArg(LONGLONG value)              : m_type(FORMAT_INT64), m_length(-1)   { m_value.integer = value; }
+        CFormatArg(ULONGLONG value)             : m_type(FORMAT_UINT64), m_length(-1)  { m_value.integer = static_cast<LONGLONG>(value); }
+        CFormatArg(CHAR ch)                     : m_type(FORMAT_CHAR), m_length(-1)    { m_value.integer = ch; }
+        CFormatArg(WCHAR ch)                    : m_type(FORMAT_WCHAR), m_length(-1)   { m_value.integer = ch; }
+        CFormatArg(double value)                : m_type(FORMAT_DOUBLE), m_length(-1)  { m_value.real = value; }
+        CFormatArg(long double value)           : m_type(FORMAT_DOUBLE), m_length(-1)  { m_value.real = static_cast<double>(value); }
+        CFormatArg(std::nullptr_t)              : m_type(FORMAT_POINTER), m_length(-1) { m_value.pointer = NULL; }
+        CFormatArg(const CHAR* text)            : m_type(FORMAT_STRING), m_length(-1)  { m_value.pointer = text; }
+        CFormatArg(const WCHAR* text)           : m_type(FORMAT_WSTRING), m_length(-1) { m_value.pointer = text; }
+        CFormatArg(const CStringT<CHAR>& str)   : m_type(FORMAT_STRING), m_length(str.GetLength())  { m_value.pointer = str.c_str(); }
+        CFormatArg(const CStringT<WCHAR>& str)  : m_type(FORMAT_WSTRING), m_length(str.GetLength()) { m_value.pointer = str.c_str(); }
+
+        template <class P>
+        CFormatArg(const P* pointer)            : m_type(FORMAT_POINTER), m_length(-1) { m_value.pointer = pointer; }
+
+        FormatArgType GetType() const { return m_type; }
+        bool GetText(const CHAR*& text, int& length) const;
+        bool GetText(const WCHAR*& text, int& length) const;
+        double GetDouble() const;
+        const void* GetPointer() const;
+        LONGLONG GetSigned() const;
+        ULONGLONG GetUnsigned() const;
+        bool IsInteger() const { return m_type <= FORMAT_WCHAR; }
+
+    private:
+        FormatArgType m_type;
+        int m_length;               // The length of a CStringT, or -1
+        union
+        {
+            LONGLONG integer;
+            double real;
+            const void* pointer;
+        } m_value;
+    };
+
+#endif // WXX_VARIADIC_TEMPLATES
+
 } // namespace Win32xx
 
 
@@ -407,13 +627,443 @@ namespace Win32xx
 namespace Win32xx
 {
 
+    ////////////////////////////////////////////////////
+    // Definition of the CFormatBuffer class template
+    //
+
+    // Appends length characters of text to the buffer.
+    template <class T>
+    inline void CFormatBuffer<T>::Append(const T* text, int length)
+    {
+        if (!m_isOverflow && (m_length + length <= WXX_FORMAT_BUFFER_SIZE))
+            memcpy(m_text + m_length, text, length * sizeof(T));
+        else
+            memcpy(Reserve(length), text, length * sizeof(T));
+
+        Commit(length);
+    }
+
+    // Appends the buffer's text to str.
+    template <class T>
+    inline void CFormatBuffer<T>::AppendTo(std::basic_string<T>& str) const
+    {
+        str.append(m_isOverflow ? m_overflow.c_str() : m_text, static_cast<size_t>(m_length));
+    }
+
+    // Assigns the buffer's text to str. Text on the heap is swapped rather than copied.
+    template <class T>
+    inline void CFormatBuffer<T>::AssignTo(std::basic_string<T>& str)
+    {
+        if (m_isOverflow)
+            str.swap(m_overflow);
+        else
+            str.assign(m_text, static_cast<size_t>(m_length));
+    }
+
+    // Adds length characters written to the space returned by Reserve to the text.
+    template <class T>
+    inline void CFormatBuffer<T>::Commit(int length)
+    {
+        m_length += length;
+        if (m_isOverflow)
+            m_overflow.resize(static_cast<size_t>(m_length));
+    }
+
+    // Returns the number of characters that can be written to the stack buffer,
+    // leaving space for a null terminator.
+    template <class T>
+    inline int CFormatBuffer<T>::GetFreeSpace() const
+    {
+        return m_isOverflow ? 0 : WXX_FORMAT_BUFFER_SIZE - m_length - 1;
+    }
+
+    // Returns a pointer to space for length characters and a null terminator
+    // following the text. The text moves to the heap if there isn't room on the stack.
+    template <class T>
+    inline T* CFormatBuffer<T>::Reserve(int length)
+    {
+        assert(length >= 0);
+        if (!m_isOverflow && (m_length + length + 1 <= WXX_FORMAT_BUFFER_SIZE))
+            return m_text + m_length;
+
+        if (!m_isOverflow)
+        {
+            m_overflow.reserve(static_cast<size_t>(m_length + length) * 2);
+            m_overflow.assign(m_text, static_cast<size_t>(m_length));
+            m_isOverflow = true;
+        }
+
+        m_overflow.resize(static_cast<size_t>(m_length + length + 1));
+        return &m_overflow[static_cast<size_t>(m_length)];
+    }
+
+
+    ////////////////////////////////////////
+    // Definitions for the CTextScan class
+    //
+
+    // Returns the position of the first occurrence of ch, or -1.
+    inline int CTextScan::FindChar(const CHAR* str, int length, CHAR ch)
+    {
+        return FindPair(str, length, ch, ch, 0);
+    }
+
+    // Returns the position of the first occurrence of ch, or -1.
+    inline int CTextScan::FindChar(const WCHAR* str, int length, WCHAR ch)
+    {
+        return FindPair(str, length, ch, ch, 0);
+    }
+
+    // Returns the first position, less than count, where str holds the first
+    // character, and the last character is offset characters further on.
+    // Returns -1 if there is no such position.
+    inline int CTextScan::FindPair(const CHAR* str, int count, CHAR first, CHAR last, int offset)
+    {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (CTextConv::IsSSE2Supported())
+            i = FindPairSSE2(str, count, first, last, offset);
+#endif
+
+        for (; i < count; ++i)
+        {
+            if (str[i] == first && str[i + offset] == last)
+                return i;
+        }
+
+        return -1;
+    }
+
+    // Returns the first position, less than count, where str holds the first
+    // character, and the last character is offset characters further on.
+    // Returns -1 if there is no such position.
+    inline int CTextScan::FindPair(const WCHAR* str, int count, WCHAR first, WCHAR last, int offset)
+    {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (CTextConv::IsSSE2Supported())
+            i = FindPairSSE2(str, count, first, last, offset);
+#endif
+
+        for (; i < count; ++i)
+        {
+            if (str[i] == first && str[i + offset] == last)
+                return i;
+        }
+
+        return -1;
+    }
+
+    // Converts the characters to lowercase. Blocks of ASCII characters are
+    // converted with SSE2, and other characters use the C runtime.
+    inline void CTextScan::MakeLower(CHAR* str, int length)
+    {
+        int i = 0;
+        while (i < length)
+        {
+#ifdef WXX_TEXTCONV_SSE2
+            if (CTextConv::IsSSE2Supported())
+                i += ChangeCaseSSE2(str + i, length - i, 'A', 'a' - 'A');
+#endif
+
+            int end = MIN(i + 16, length);
+            for (; i < end; ++i)
+                str[i] = ToLower(str[i]);
+        }
+    }
+
+    // Converts the characters to lowercase. Blocks of ASCII characters are
+    // converted with SSE2, and other characters use the C runtime.
+    inline void CTextScan::MakeLower(WCHAR* str, int length)
+    {
+        int i = 0;
+        while (i < length)
+        {
+#ifdef WXX_TEXTCONV_SSE2
+            if (CTextConv::IsSSE2Supported())
+                i += ChangeCaseSSE2(str + i, length - i, L'A', L'a' - L'A');
+#endif
+
+            int end = MIN(i + 16, length);
+            for (; i < end; ++i)
+                str[i] = ToLower(str[i]);
+        }
+    }
+
+    // Converts the characters to uppercase. Blocks of ASCII characters are
+    // converted with SSE2, and other characters use the C runtime.
+    inline void CTextScan::MakeUpper(CHAR* str, int length)
+    {
+        int i = 0;
+        while (i < length)
+        {
+#ifdef WXX_TEXTCONV_SSE2
+            if (CTextConv::IsSSE2Supported())
+                i += ChangeCaseSSE2(str + i, length - i, 'a', 'A' - 'a');
+#endif
+
+            int end = MIN(i + 16, length);
+            for (; i < end; ++i)
+                str[i] = ToUpper(str[i]);
+        }
+    }
+
+    // Converts the characters to uppercase. Blocks of ASCII characters are
+    // converted with SSE2, and other characters use the C runtime.
+    inline void CTextScan::MakeUpper(WCHAR* str, int length)
+    {
+        int i = 0;
+        while (i < length)
+        {
+#ifdef WXX_TEXTCONV_SSE2
+            if (CTextConv::IsSSE2Supported())
+                i += ChangeCaseSSE2(str + i, length - i, L'a', L'A' - L'a');
+#endif
+
+            int end = MIN(i + 16, length);
+            for (; i < end; ++i)
+                str[i] = ToUpper(str[i]);
+        }
+    }
+
+    // Returns the lowercase character. ASCII characters are converted directly.
+    inline CHAR CTextScan::ToLower(CHAR ch)
+    {
+        BYTE value = static_cast<BYTE>(ch);
+        if (value < 0x80)
+            return (value >= 'A' && value <= 'Z') ? static_cast<CHAR>(value + 'a' - 'A') : ch;
+
+        return static_cast<CHAR>(::tolower(value));
+    }
+
+    // Returns the lowercase character. ASCII characters are converted directly.
+    inline WCHAR CTextScan::ToLower(WCHAR ch)
+    {
+        if (ch < 0x80)
+            return (ch >= L'A' && ch <= L'Z') ? static_cast<WCHAR>(ch + L'a' - L'A') : ch;
+
+        return static_cast<WCHAR>(::towlower(ch));
+    }
+
+    // Returns the uppercase character. ASCII characters are converted directly.
+    inline CHAR CTextScan::ToUpper(CHAR ch)
+    {
+        BYTE value = static_cast<BYTE>(ch);
+        if (value < 0x80)
+            return (value >= 'a' && value <= 'z') ? static_cast<CHAR>(value + 'A' - 'a') : ch;
+
+        return static_cast<CHAR>(::toupper(value));
+    }
+
+    // Returns the uppercase character. ASCII characters are converted directly.
+    inline WCHAR CTextScan::ToUpper(WCHAR ch)
+    {
+        if (ch < 0x80)
+            return (ch >= L'a' && ch <= L'z') ? static_cast<WCHAR>(ch + L'A' - L'a') : ch;
+
+        return static_cast<WCHAR>(::towupper(ch));
+    }
+
+#ifdef WXX_TEXTCONV_SSE2
+
+    // Converts blocks of 16 ASCII characters, adding delta to the letters
+    // from 'from' to 'from' + 25. Returns the number of characters converted
+    // before a block containing a non-ASCII character was found.
+    inline int CTextScan::ChangeCaseSSE2(CHAR* str, int length, CHAR from, int delta)
+    {
+        const __m128i low = _mm_set1_epi8(static_cast<char>(from - 1));
+        const __m128i high = _mm_set1_epi8(static_cast<char>(from + 26));
+        const __m128i deltas = _mm_set1_epi8(static_cast<char>(delta));
+        int i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i* pBlock = reinterpret_cast<__m128i*>(str + i);
+            __m128i chars = _mm_loadu_si128(pBlock);
+            if (_mm_movemask_epi8(chars) != 0)
+                break;
+
+            __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(chars, low), _mm_cmplt_epi8(chars, high));
+            _mm_storeu_si128(pBlock, _mm_add_epi8(chars, _mm_and_si128(letters, deltas)));
+        }
+
+        return i;
+    }
+
+    // Converts blocks of 8 ASCII characters, adding delta to the letters
+    // from 'from' to 'from' + 25. Returns the number of characters converted
+    // before a block containing a non-ASCII character was found.
+    inline int CTextScan::ChangeCaseSSE2(WCHAR* str, int length, WCHAR from, int delta)
+    {
+        const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low = _mm_set1_epi16(static_cast<short>(from - 1));
+        const __m128i high = _mm_set1_epi16(static_cast<short>(from + 26));
+        const __m128i deltas = _mm_set1_epi16(static_cast<short>(delta));
+        int i = 0;
+        for (; i + 8 <= length; i += 8)
+        {
+            __m128i* pBlock = reinterpret_cast<__m128i*>(str + i);
+            __m128i chars = _mm_loadu_si128(pBlock);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, highBits), zero)) != 0xFFFF)
+                break;
+
+            __m128i letters = _mm_and_si128(_mm_cmpgt_epi16(chars, low), _mm_cmplt_epi16(chars, high));
+            _mm_storeu_si128(pBlock, _mm_add_epi16(chars, _mm_and_si128(letters, deltas)));
+        }
+
+        return i;
+    }
+
+    // Compares 16 positions at a time. Returns the position of the first
+    // candidate found, or the number of positions compared.
+    inline int CTextScan::FindPairSSE2(const CHAR* str, int count, CHAR first, CHAR last, int offset)
+    {
+        const __m128i firstChars = _mm_set1_epi8(first);
+        const __m128i lastChars = _mm_set1_epi8(last);
+        int i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i + offset));
+            __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(firstBlock, firstChars), _mm_cmpeq_epi8(lastBlock, lastChars));
+            int mask = _mm_movemask_epi8(matches);
+            if (mask != 0)
+            {
+                while ((mask & 1) == 0)
+                {
+                    mask >>= 1;
+                    ++i;
+                }
+                break;
+            }
+        }
+
+        return i;
+    }
+
+    // Compares 8 positions at a time. Returns the position of the first
+    // candidate found, or the number of positions compared.
+    inline int CTextScan::FindPairSSE2(const WCHAR* str, int count, WCHAR first, WCHAR last, int offset)
+    {
+        const __m128i firstChars = _mm_set1_epi16(static_cast<short>(first));
+        const __m128i lastChars = _mm_set1_epi16(static_cast<short>(last));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i + offset));
+            __m128i matches = _mm_and_si128(_mm_cmpeq_epi16(firstBlock, firstChars), _mm_cmpeq_epi16(lastBlock, lastChars));
+            int mask = _mm_movemask_epi8(matches);
+            if (mask != 0)
+            {
+                while ((mask & 3) == 0)
+                {
+                    mask >>= 2;
+                    ++i;
+                }
+                break;
+            }
+        }
+
+        return i;
+    }
+
+#endif // WXX_TEXTCONV_SSE2
+
+
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    ////////////////////////////////////////
+    // Definitions for the CFormatArg class
+    //
+
+    // Retrieves the text of a CHAR string argument.
+    inline bool CFormatArg::GetText(const CHAR*& text, int& length) const
+    {
+        if (m_type != FORMAT_STRING)
+            return false;
+
+        text = static_cast<const CHAR*>(m_value.pointer);
+        length = m_length;
+        return true;
+    }
+
+    // Retrieves the text of a WCHAR string argument.
+    inline bool CFormatArg::GetText(const WCHAR*& text, int& length) const
+    {
+        if (m_type != FORMAT_WSTRING)
+            return false;
+
+        text = static_cast<const WCHAR*>(m_value.pointer);
+        length = m_length;
+        return true;
+    }
+
+    // Returns the argument's value as a double.
+    inline double CFormatArg::GetDouble() const
+    {
+        if (m_type == FORMAT_DOUBLE)
+            return m_value.real;
+
+        if (m_type == FORMAT_UINT || m_type == FORMAT_UINT64)
+            return static_cast<double>(GetUnsigned());
+
+        return static_cast<double>(GetSigned());
+    }
+
+    // Returns the argument's value as a pointer.
+    inline const void* CFormatArg::GetPointer() const
+    {
+        if (m_type >= FORMAT_STRING)
+            return m_value.pointer;
+
+        return reinterpret_cast<const void*>(static_cast<UINT_PTR>(GetUnsigned()));
+    }
+
+    // Returns the argument's value as a signed integer. Values of 32 bit
+    // types are converted as printf's %d converts them.
+    inline LONGLONG CFormatArg::GetSigned() const
+    {
+        switch (m_type)
+        {
+        case FORMAT_INT64:
+        case FORMAT_UINT64:  return m_value.integer;
+        case FORMAT_DOUBLE:  return static_cast<LONGLONG>(m_value.real);
+        case FORMAT_STRING:
+        case FORMAT_WSTRING:
+        case FORMAT_POINTER: return static_cast<LONGLONG>(reinterpret_cast<INT_PTR>(m_value.pointer));
+        default:             return static_cast<int>(m_value.integer);
+        }
+    }
+
+    // Returns the argument's value as an unsigned integer. Values of 32 bit
+    // types are converted as printf's %u converts them.
+    inline ULONGLONG CFormatArg::GetUnsigned() const
+    {
+        switch (m_type)
+        {
+        case FORMAT_INT64:
+        case FORMAT_UINT64:  return static_cast<ULONGLONG>(m_value.integer);
+        case FORMAT_DOUBLE:  return static_cast<ULONGLONG>(static_cast<LONGLONG>(m_value.real));
+        case FORMAT_STRING:
+        case FORMAT_WSTRING:
+        case FORMAT_POINTER: return static_cast<ULONGLONG>(reinterpret_cast<UINT_PTR>(m_value.pointer));
+        default:             return static_cast<unsigned int>(m_value.integer);
+        }
+    }
+
+#endif // WXX_VARIADIC_TEMPLATES
+
+
     /////////////////////////////////////////////
     // Definition of the CStringT class template
     //
 
     // Constructor.
     template <class T>
-    inline CStringT<T>::CStringT()
+    inline CStringT<T>::CStringT() : m_bufferLength(-1)
     {
     }
 
@@ -425,14 +1075,14 @@ namespace Win32xx
 
     // Constructor. Assigns from a CStringT<T>.
     template <class T>
-    inline CStringT<T>::CStringT(const CStringT& str)
+    inline CStringT<T>::CStringT(const CStringT& str) : m_bufferLength(-1)
     {
         m_str.assign(str.m_str);
     }
 
     // Constructor. Assigns from from a const T* character array.
     template <class T>
-    inline CStringT<T>::CStringT(const T* text)
+    inline CStringT<T>::CStringT(const T* text) : m_bufferLength(-1)
     {
         assert(text != NULL);
         m_str.assign(text);
@@ -440,7 +1090,7 @@ namespace Win32xx
 
     // Constructor. Assigns from 1 or more T characters.
     template <class T>
-    inline CStringT<T>::CStringT(T ch, int repeat)
+    inline CStringT<T>::CStringT(T ch, int repeat) : m_bufferLength(-1)
     {
         T str[2] = {0};
         str[0] = ch;
@@ -450,12 +1100,38 @@ namespace Win32xx
     // Constructor. Assigns from a const T* possibly containing null characters.
     // Ensure the size of the text buffer holds length or more characters
     template <class T>
-    inline CStringT<T>::CStringT(const T* text, int length)
+    inline CStringT<T>::CStringT(const T* text, int length) : m_bufferLength(-1)
     {
         memcpy(GetBuffer(length), text, length*sizeof(T));
         ReleaseBuffer(length);
     }
 
+#ifdef WXX_MOVE_SEMANTICS
+
+    // Move constructor. Takes the contents of str without copying it.
+    // str is left empty.
+    template <class T>
+    inline CStringT<T>::CStringT(CStringT&& str) WXX_NOEXCEPT : m_str(std::move(str.m_str)), m_bufferLength(-1)
+    {
+        str.m_str.clear();
+    }
+
+    // Move assignment. Takes the contents of str without copying it.
+    // str is left empty.
+    template <class T>
+    inline CStringT<T>& CStringT<T>::operator = (CStringT<T>&& str) WXX_NOEXCEPT
+    {
+        if (this != &str)
+        {
+            m_str.swap(str.m_str);
+            str.m_str.clear();
+        }
+
+        return *this;
+    }
+
+#endif
+
     // Assign from a const CStringT<T>.
     template <class T>
     inline CStringT<T>& CStringT<T>::operator = (const CStringT<T>& str)
@@ -586,21 +1262,440 @@ namespace Win32xx
         if (bstr == 0)
             throw std::bad_alloc();
 
-        return bstr;
+        return bstr;
+    }
+
+    // Appends formatted data to an the CStringT content.
+    template <class T>
+    inline void CStringT<T>::AppendFormat(const T* format,...)
+    {
+        va_list args;
+        va_start(args, format);
+        AppendFormatV(format, args);
+        va_end(args);
+    }
+
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    // Appends formatted data to the CStringT content. Unlike AppendFormat,
+    // the arguments can include CStringT objects. The common integer, character
+    // and string specifiers are formatted without calling the C runtime.
+    template <class T>
+    template <class... Args>
+    inline void CStringT<T>::AppendFormatT(const T* format, const Args&... args)
+    {
+        const CFormatArg argArray[] = { CFormatArg(args)..., CFormatArg(0) };
+        CFormatBuffer<T> buffer;
+        AppendArgs(buffer, format, argArray, static_cast<int>(sizeof...(args)));
+        buffer.AppendTo(m_str);
+    }
+
+#endif
+
+    // Appends data formatted from a variable list of arguments to the CStringT content.
+    template <class T>
+    inline void CStringT<T>::AppendFormatV(const T* format, va_list args)
+    {
+        if (format)
+        {
+            CFormatBuffer<T> buffer;
+            AppendTextV(buffer, format, args);
+            buffer.AppendTo(m_str);
+        }
+    }
+
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    // Appends an argument to the buffer without calling the C runtime. This
+    // supports the %d, %i, %u, %x, %X, %c and %s specifiers with the '-' and
+    // '0' flags and a width. Returns false for other specifiers, including
+    // floating point specifiers, which depend on the locale.
+    template <class T>
+    inline bool CStringT<T>::AppendArg(CFormatBuffer<T>& buffer, const CFormatArg& arg, T type, UINT flags, int width, int precision)
+    {
+        if (flags & CFormatArg::FLAG_OTHER)
+            return false;
+
+        bool isWide = (sizeof(T) != sizeof(CHAR));
+        bool isNegative = false;
+        T text[48];
+        int length = 0;
+
+        switch (type)
+        {
+        case 'd':
+        case 'i':
+            {
+                if (precision >= 0 || !arg.IsInteger())
+                    return false;
+
+                LONGLONG value = arg.GetSigned();
+                isNegative = (value < 0);
+                ULONGLONG magnitude = isNegative ? 0 - static_cast<ULONGLONG>(value) : static_cast<ULONGLONG>(value);
+                length = FormatInteger(text, magnitude, 10, false);
+            }
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+            if (precision >= 0 || !arg.IsInteger())
+                return false;
+
+            length = FormatInteger(text, arg.GetUnsigned(), (type == 'u') ? 10 : 16, (type == 'X'));
+            break;
+        case 'c':
+            // A character of the other width is converted by the C runtime.
+            if (precision >= 0 || (flags & CFormatArg::FLAG_ZERO) || !arg.IsInteger() ||
+                arg.GetType() == (isWide ? CFormatArg::FORMAT_CHAR : CFormatArg::FORMAT_WCHAR))
+                return false;
+
+            text[0] = static_cast<T>(arg.GetSigned());
+            length = 1;
+            break;
+        case 's':
+        case 'S':
+            {
+                // A string of the other width is converted by the C runtime.
+                const T* str = NULL;
+                int strLength = -1;
+                if (precision >= 0 || (flags & CFormatArg::FLAG_ZERO) || !arg.GetText(str, strLength) || str == NULL)
+                    return false;
+
+                if (strLength < 0)
+                    strLength = static_cast<int>(std::char_traits<T>::length(str));
+
+                AppendPadded(buffer, str, strLength, false, flags, width);
+                return true;
+            }
+        default:
+            return false;
+        }
+
+        AppendPadded(buffer, text, length, isNegative, flags, width);
+        return true;
+    }
+
+    // Appends the arguments to the buffer as specified by format. Specifiers
+    // have the form %[flags][width][.precision][size]type. The size is known
+    // from each argument's type, except that %h and %hh convert an integer
+    // to a short and a char as the C runtime does.
+    template <class T>
+    inline void CStringT<T>::AppendArgs(CFormatBuffer<T>& buffer, const T* format, const CFormatArg* args, int count)
+    {
+        assert(format != NULL);
+        int index = 0;
+
+        while (*format != 0)
+        {
+            // Append the text up to the next specifier.
+            const T* text = format;
+            while (*format != 0 && *format != '%')
+                ++format;
+
+            if (format > text)
+                buffer.Append(text, static_cast<int>(format - text));
+
+            if (*format == 0)
+                break;
+
+            const T* spec = format++;
+            if (*format == '%')
+            {
+                buffer.Append(*format++);
+                continue;
+            }
+
+            // Flags
+            UINT flags = 0;
+            const T* flagText = format;
+            for ( ; ; ++format)
+            {
+                if (*format == '-')
+                    flags |= CFormatArg::FLAG_LEFT;
+                else if (*format == '0')
+                    flags |= CFormatArg::FLAG_ZERO;
+                else if (*format == '+' || *format == ' ' || *format == '#')
+                    flags |= CFormatArg::FLAG_OTHER;
+                else
+                    break;
+            }
+            int flagCount = static_cast<int>(format - flagText);
+
+            // Width. A negative width from '*' left aligns the text.
+            int width = -1;
+            if (*format == '*')
+            {
+                ++format;
+                width = (index < count) ? static_cast<int>(args[index++].GetSigned()) : 0;
+                if (width < 0)
+                {
+                    flags |= CFormatArg::FLAG_LEFT;
+                    width = -width;
+                }
+            }
+            else
+            {
+                for ( ; *format >= '0' && *format <= '9'; ++format)
+                    width = MIN(MAX(width, 0) * 10 + (*format - '0'), 9999);
+            }
+
+            // Precision. A negative precision from '*' is ignored.
+            int precision = -1;
+            if (*format == '.')
+            {
+                ++format;
+                if (*format == '*')
+                {
+                    ++format;
+                    precision = (index < count) ? static_cast<int>(args[index++].GetSigned()) : 0;
+                    precision = MAX(precision, -1);
+                }
+                else
+                {
+                    precision = 0;
+                    for ( ; *format >= '0' && *format <= '9'; ++format)
+                        precision = MIN(precision * 10 + (*format - '0'), 9999);
+                }
+            }
+
+            // Size
+            int shortCount = 0;
+            for ( ; ; ++format)
+            {
+                if (*format == 'h')
+                    ++shortCount;
+
+                if (*format == 'I' && ((format[1] == '3' && format[2] == '2') || (format[1] == '6' && format[2] == '4')))
+                    format += 2;
+                else if (*format != 'h' && *format != 'l' && *format != 'L' && *format != 'I' &&
+                         *format != 'w' && *format != 'z' && *format != 'j' && *format != 't')
+                    break;
+            }
+
+            // Type. An unknown type is copied to the text without using an argument.
+            T type = *format;
+            switch (type)
+            {
+            case 'c': case 'C': case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            case 'n': case 'p': case 's': case 'S':
+                ++format;
+                break;
+            default:
+                buffer.Append(spec, static_cast<int>(format - spec));
+                continue;
+            }
+
+            assert(index < count);   // Too few arguments for the format.
+            if (index >= count)
+                continue;
+
+            CFormatArg arg = args[index++];
+            bool isInteger = (type == 'd' || type == 'i' || type == 'o' || type == 'u' || type == 'x' || type == 'X');
+            if (shortCount > 0 && isInteger && arg.IsInteger())
+            {
+                bool isSigned = (type == 'd' || type == 'i');
+                LONGLONG value = arg.GetSigned();
+                if (shortCount == 1)
+                    arg = isSigned ? CFormatArg(static_cast<int>(static_cast<short>(value))) :
+                                     CFormatArg(static_cast<unsigned int>(static_cast<unsigned short>(value)));
+                else
+                    arg = isSigned ? CFormatArg(static_cast<int>(static_cast<signed char>(value))) :
+                                     CFormatArg(static_cast<unsigned int>(static_cast<unsigned char>(value)));
+            }
+
+            if (!AppendArg(buffer, arg, type, flags, width, precision))
+                AppendSpec(buffer, arg, type, flagText, flagCount, flags, width, precision);
+        }
+    }
+
+    // Appends text to the buffer, padded with spaces or zeros to width characters.
+    // The minus sign of a negative number precedes any zeros.
+    template <class T>
+    inline void CStringT<T>::AppendPadded(CFormatBuffer<T>& buffer, const T* text, int length, bool isNegative, UINT flags, int width)
+    {
+        int padding = width - length - (isNegative ? 1 : 0);
+        bool isLeft = (flags & CFormatArg::FLAG_LEFT) != 0;
+        bool isZero = !isLeft && (flags & CFormatArg::FLAG_ZERO);
+
+        for (int i = 0; !isLeft && !isZero && i < padding; ++i)
+            buffer.Append(T(' '));
+
+        if (isNegative)
+            buffer.Append(T('-'));
+
+        for (int i = 0; isZero && i < padding; ++i)
+            buffer.Append(T('0'));
+
+        buffer.Append(text, length);
+
+        for (int i = 0; isLeft && i < padding; ++i)
+            buffer.Append(T(' '));
+    }
+
+    // Appends an argument formatted by the C runtime. The size and type of
+    // the specifier are chosen to match the argument's type.
+    template <class T>
+    inline void CStringT<T>::AppendSpec(CFormatBuffer<T>& buffer, const CFormatArg& arg, T type, const T* flagText,
+                                        int flagCount, UINT flags, int width, int precision)
+    {
+        T spec[32];
+        int length = 0;
+        spec[length++] = '%';
+        for (int i = 0; i < MIN(flagCount, 8); ++i)
+            spec[length++] = flagText[i];
+
+        if (flags & CFormatArg::FLAG_LEFT)
+            spec[length++] = '-';
+
+        if (width >= 0)
+            length += FormatInteger(spec + length, static_cast<ULONGLONG>(width), 10, false);
+
+        if (precision >= 0)
+        {
+            spec[length++] = '.';
+            length += FormatInteger(spec + length, static_cast<ULONGLONG>(precision), 10, false);
+        }
+
+        // A %s specifier with an argument that isn't a string uses the argument's type.
+        CFormatArg::FormatArgType argType = arg.GetType();
+        bool isString = (argType == CFormatArg::FORMAT_STRING || argType == CFormatArg::FORMAT_WSTRING);
+        if ((type == 's' || type == 'S') && !isString)
+        {
+            if (argType == CFormatArg::FORMAT_DOUBLE)
+                type = 'g';
+            else if (argType == CFormatArg::FORMAT_POINTER)
+                type = 'p';
+            else if (argType == CFormatArg::FORMAT_CHAR || argType == CFormatArg::FORMAT_WCHAR)
+                type = 'c';
+            else if (argType == CFormatArg::FORMAT_UINT || argType == CFormatArg::FORMAT_UINT64)
+                type = 'u';
+            else
+                type = 'd';
+        }
+
+        switch (type)
+        {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            // Integers are formatted as 64 bit values.
+            spec[length++] = 'I';
+            spec[length++] = '6';
+            spec[length++] = '4';
+            spec[length++] = type;
+            spec[length] = 0;
+            if (type == 'd' || type == 'i')
+                AppendText(buffer, spec, arg.GetSigned());
+            else
+                AppendText(buffer, spec, arg.GetUnsigned());
+            break;
+        case 'a':
+        case 'A':
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+            spec[length++] = (type == 'F') ? T('f') : type;
+            spec[length] = 0;
+            AppendText(buffer, spec, arg.GetDouble());
+            break;
+        case 'c':
+        case 'C':
+            {
+                // %hc and %lc specify a CHAR and a WCHAR.
+                bool isWideChar = (argType == CFormatArg::FORMAT_WCHAR) ||
+                    (argType != CFormatArg::FORMAT_CHAR && sizeof(T) != sizeof(CHAR));
+                spec[length++] = isWideChar ? T('l') : T('h');
+                spec[length++] = 'c';
+                spec[length] = 0;
+                AppendText(buffer, spec, static_cast<int>(arg.GetSigned()));
+            }
+            break;
+        case 's':
+        case 'S':
+            // %hs and %ls specify a CHAR and a WCHAR string.
+            spec[length++] = (argType == CFormatArg::FORMAT_STRING) ? T('h') : T('l');
+            spec[length++] = 's';
+            spec[length] = 0;
+            AppendText(buffer, spec, arg.GetPointer());
+            break;
+        case 'p':
+            spec[length++] = 'p';
+            spec[length] = 0;
+            AppendText(buffer, spec, arg.GetPointer());
+            break;
+        default:
+            // %n isn't supported.
+            break;
+        }
+    }
+
+    // Appends text formatted by the C runtime from a variable list of arguments to the buffer.
+    template <class T>
+    inline void CStringT<T>::AppendText(CFormatBuffer<T>& buffer, const T* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        AppendTextV(buffer, format, args);
+        va_end(args);
+    }
+
+    // Writes the digits of value to text. Returns the number of digits written.
+    template <class T>
+    inline int CStringT<T>::FormatInteger(T* text, ULONGLONG value, int base, bool isUpper)
+    {
+        const char* digits = isUpper ? "0123456789ABCDEF" : "0123456789abcdef";
+        T reversed[24];
+        int length = 0;
+        do
+        {
+            reversed[length++] = static_cast<T>(digits[value % base]);
+            value /= base;
+        } while (value != 0);
+
+        for (int i = 0; i < length; ++i)
+            text[i] = reversed[length - 1 - i];
+
+        return length;
     }
 
-    // Appends formatted data to an the CStringT content.
+#endif // WXX_VARIADIC_TEMPLATES
+
+    // Appends text formatted from a variable list of arguments to the buffer.
+    // The text is formatted into the buffer's free space on the stack. If it
+    // doesn't fit, it's measured and formatted again into space of that size.
     template <class T>
-    inline void CStringT<T>::AppendFormat(const T* format,...)
+    inline void CStringT<T>::AppendTextV(CFormatBuffer<T>& buffer, const T* format, va_list args)
     {
-        CStringT str;
+        int length = -1;
+        int space = buffer.GetFreeSpace();
+        if (space > 0)
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            length = FormatText(buffer.Reserve(space), space + 1, format, argsCopy);
+            va_end(argsCopy);
+        }
 
-        va_list args;
-        va_start(args, format);
-        str.FormatV(format, args);
-        va_end(args);
+        if (length < 0)
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            length = FormatLength(format, argsCopy);
+            va_end(argsCopy);
+
+            if (length > 0)
+                length = FormatText(buffer.Reserve(length), length + 1, format, args);
+        }
 
-        m_str.append(str);
+        if (length > 0)
+            buffer.Commit(length);
     }
 
     // Assigns the specified number of characters from text to the CStringT.
@@ -687,6 +1782,11 @@ namespace Win32xx
     inline int CStringT<CHAR>::CompareNoCase(const CHAR* text) const
     {
         assert(text != 0);
+
+        // Identical strings are equal in any locale.
+        if (m_str.compare(text) == 0)
+            return 0;
+
         return lstrcmpiA(m_str.c_str(), text);
     }
 
@@ -695,6 +1795,11 @@ namespace Win32xx
     inline int CStringT<WCHAR>::CompareNoCase(const WCHAR* text) const
     {
         assert(text != 0);
+
+        // Identical strings are equal in any locale.
+        if (m_str.compare(text) == 0)
+            return 0;
+
         return lstrcmpiW(m_str.c_str(), text);
     }
 
@@ -724,8 +1829,12 @@ namespace Win32xx
     {
         assert(index >= 0);
 
-        size_t s = m_str.find(ch, static_cast<size_t>(index));
-        return static_cast<int>(s);
+        int length = GetLength();
+        if (index >= length)
+            return -1;
+
+        int pos = CTextScan::FindChar(m_str.c_str() + index, length - index, ch);
+        return (pos < 0) ? -1 : pos + index;
     }
 
     // Finds a substring within the string.
@@ -735,8 +1844,12 @@ namespace Win32xx
         assert(text != 0);
         assert(index >= 0);
 
-        size_t s = m_str.find(text, static_cast<size_t>(index));
-        return static_cast<int>(s);
+        int length = GetLength();
+        if (index > length)
+            return -1;
+
+        int pos = FindText(m_str.c_str() + index, length - index, text, lstrlenT(text));
+        return (pos < 0) ? -1 : pos + index;
     }
 
     // Finds the first matching character from a set.
@@ -749,6 +1862,71 @@ namespace Win32xx
         return static_cast<int>(s);
     }
 
+    // Returns the position of the first occurrence of text within str, or -1.
+    // Long text is found with the Horspool algorithm. Otherwise only the
+    // positions where both the first and last characters match are compared.
+    template <class T>
+    inline int CStringT<T>::FindText(const T* str, int length, const T* text, int textLength)
+    {
+        if (textLength == 0)
+            return 0;
+
+        if (textLength > length)
+            return -1;
+
+        if (textLength >= 32)
+            return FindTextHorspool(str, length, text, textLength);
+
+        int offset = textLength - 1;
+        int count = length - offset;
+        int pos = 0;
+        while (pos < count)
+        {
+            int found = CTextScan::FindPair(str + pos, count - pos, text[0], text[offset], offset);
+            if (found < 0)
+                return -1;
+
+            pos += found;
+            if (memcmp(str + pos, text, offset * sizeof(T)) == 0)
+                return pos;
+
+            ++pos;
+        }
+
+        return -1;
+    }
+
+    // Returns the position of the first occurrence of text within str, or -1.
+    // The text's length must be from 1 to length. The Horspool algorithm skips
+    // ahead based on the character aligned with the end of the text. WCHAR
+    // characters are looked up by their low byte, which is a safe shift.
+    template <class T>
+    inline int CStringT<T>::FindTextHorspool(const T* str, int length, const T* text, int textLength)
+    {
+        int shift[256];
+        int last = textLength - 1;
+        int i;
+        for (i = 0; i < 256; ++i)
+            shift[i] = textLength;
+
+        for (i = 0; i < last; ++i)
+            shift[static_cast<BYTE>(text[i])] = last - i;
+
+        T lastChar = text[last];
+        int end = length - textLength;
+        int pos = 0;
+        while (pos <= end)
+        {
+            T ch = str[pos + last];
+            if (ch == lastChar && memcmp(str + pos, text, last * sizeof(T)) == 0)
+                return pos;
+
+            pos += shift[static_cast<BYTE>(ch)];
+        }
+
+        return -1;
+    }
+
     // Formats the string as sprintf does.
     template <class T>
     inline void CStringT<T>::Format(const T* format,...)
@@ -759,58 +1937,120 @@ namespace Win32xx
         va_end(args);
     }
 
-    // Formats the string using a variable list of arguments.
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    // Formats the string as sprintf does. Unlike Format, the arguments can
+    // include CStringT objects. The common integer, character and string
+    // specifiers are formatted without calling the C runtime.
+    template <class T>
+    template <class... Args>
+    inline void CStringT<T>::FormatT(const T* format, const Args&... args)
+    {
+        const CFormatArg argArray[] = { CFormatArg(args)..., CFormatArg(0) };
+        CFormatBuffer<T> buffer;
+        AppendArgs(buffer, format, argArray, static_cast<int>(sizeof...(args)));
+        buffer.AssignTo(m_str);
+    }
+
+#endif
+
+    // Returns the length of the text formatted from a variable list of arguments.
     template <>
-    inline void CStringT<CHAR>::FormatV(const CHAR*  format, va_list args)
+    inline int CStringT<CHAR>::FormatLength(const CHAR* format, va_list args)
     {
+#if (defined (_MSC_VER) && (_MSC_VER < 1300)) || defined (__BORLANDC__)
 
-        if (format)
+        // _vscprintf isn't available, so the text is formatted into
+        // larger buffers until it fits.
+        std::vector<CHAR> buffer;
+        int result = -1;
+        for (int size = WXX_FORMAT_BUFFER_SIZE * 2; result < 0; size *= 2)
         {
-            int result = -1;
-            size_t length = 256;
+            buffer.assign(static_cast<size_t>(size), 0);
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            result = FormatText(&buffer.front(), size, format, argsCopy);
+            va_end(argsCopy);
+        }
 
-            // A vector is used to store the CHAR array
-            std::vector<CHAR> buffer;
+        return result;
+#else
+        return _vscprintf(format, args);
+#endif
+    }
 
-            while (-1 == result)
-            {
-                buffer.assign( size_t(length)+1, 0 );
+    // Returns the length of the text formatted from a variable list of arguments.
+    template <>
+    inline int CStringT<WCHAR>::FormatLength(const WCHAR* format, va_list args)
+    {
+#if (defined (_MSC_VER) && (_MSC_VER < 1300)) || defined (__BORLANDC__)
 
-#if !defined (_MSC_VER) ||  ( _MSC_VER < 1400 )
-                result = _vsnprintf(&buffer.front(), length, format, args);
+        // _vscwprintf isn't available, so the text is formatted into
+        // larger buffers until it fits.
+        std::vector<WCHAR> buffer;
+        int result = -1;
+        for (int size = WXX_FORMAT_BUFFER_SIZE * 2; result < 0; size *= 2)
+        {
+            buffer.assign(static_cast<size_t>(size), 0);
+            va_list argsCopy;
+            va_copy(argsCopy, args);
+            result = FormatText(&buffer.front(), size, format, argsCopy);
+            va_end(argsCopy);
+        }
+
+        return result;
 #else
-                result = _vsnprintf_s(&buffer.front(), length, length -1, format, args);
+        return _vscwprintf(format, args);
 #endif
-                length *= 2;
-            }
-            m_str.assign(&buffer.front());
-        }
     }
 
-    // Formats the string using a variable list of arguments.
+    // Formats text from a variable list of arguments into a buffer of size characters.
+    // Returns the number of characters written, excluding the null terminator, or -1
+    // if the text doesn't fit.
     template <>
-    inline void CStringT<WCHAR>::FormatV(const WCHAR*  format, va_list args)
+    inline int CStringT<CHAR>::FormatText(CHAR* text, int size, const CHAR* format, va_list args)
     {
+        assert(size > 0);
 
-        if (format)
-        {
-            int result = -1;
-            size_t length = 256;
+#if !defined (_MSC_VER) ||  ( _MSC_VER < 1400 )
+        int result = _vsnprintf(text, static_cast<size_t>(size - 1), format, args);
+        text[size - 1] = 0;
+#else
+        int result = _vsnprintf_s(text, static_cast<size_t>(size), static_cast<size_t>(size - 1), format, args);
+#endif
 
-            // A vector is used to store the WCHAR array
-            std::vector<WCHAR> buffer;
+        return result;
+    }
+
+    // Formats text from a variable list of arguments into a buffer of size characters.
+    // Returns the number of characters written, excluding the null terminator, or -1
+    // if the text doesn't fit.
+    template <>
+    inline int CStringT<WCHAR>::FormatText(WCHAR* text, int size, const WCHAR* format, va_list args)
+    {
+        assert(size > 0);
 
-            while (-1 == result)
-            {
-                buffer.assign( size_t(length)+1, 0 );
 #if !defined (_MSC_VER) ||  ( _MSC_VER < 1400 )
-                result = _vsnwprintf(&buffer.front(), length, format, args);
+        int result = _vsnwprintf(text, static_cast<size_t>(size - 1), format, args);
+        text[size - 1] = 0;
 #else
-                result = _vsnwprintf_s(&buffer.front(), length, length -1, format, args);
+        int result = _vsnwprintf_s(text, static_cast<size_t>(size), static_cast<size_t>(size - 1), format, args);
 #endif
-                length *= 2;
-            }
-            m_str.assign(&buffer.front());
+
+        return result;
+    }
+
+    // Formats the string using a variable list of arguments. The text is
+    // formatted on the stack, so the string's existing buffer is reused
+    // when it's large enough.
+    template <class T>
+    inline void CStringT<T>::FormatV(const T* format, va_list args)
+    {
+        if (format)
+        {
+            CFormatBuffer<T> buffer;
+            AppendTextV(buffer, format, args);
+            buffer.AssignTo(m_str);
         }
     }
 
@@ -876,30 +2116,25 @@ namespace Win32xx
 
     // Creates a buffer of minBufLength characters (+1 extra for NULL termination) and returns
     // a pointer to this buffer. This buffer can be used by any function which accepts a LPTSTR.
-    // Care must be taken not to exceed the length of the buffer. Use ReleaseBuffer to safely
-    // copy this buffer back to the CStringT object.
-    // Note: The buffer uses a vector. Vectors are required to be contiguous in memory under
-    //       the current standard, whereas std::strings do not have this requirement.
+    // Care must be taken not to exceed the length of the buffer. Use ReleaseBuffer to set the
+    // length of the CStringT object once the buffer has been written.
+    // Note: The buffer is the string's own storage, so no copy is made. The buffer is valid
+    //       until ReleaseBuffer is called or the CStringT is modified.
+    //       GetLength isn't valid until ReleaseBuffer is called. Until then, it includes the
+    //       unused part of the buffer and the extra null character.
     template <class T>
     inline T* CStringT<T>::GetBuffer(int minBufLength)
     {
         assert (minBufLength >= 0);
+        m_bufferLength = minBufLength;
 
+        // Existing characters beyond minBufLength are truncated, and
+        // the remainder of the buffer is filled with null characters.
         T ch = 0;
-        m_buf.assign(size_t(minBufLength) + 1, ch);
-        typename std::basic_string<T>::iterator it_end;
-
-        if (m_str.length() >= static_cast<size_t>(minBufLength))
-        {
-            it_end = m_str.begin();
-            std::advance(it_end, minBufLength);
-        }
-        else
-            it_end = m_str.end();
-
-        std::copy(m_str.begin(), it_end, m_buf.begin());
+        m_str.resize(static_cast<size_t>(minBufLength) + 1, ch);
+        m_str[static_cast<size_t>(minBufLength)] = ch;
 
-        return &m_buf.front();
+        return &m_str[0];
     }
 
     // Sets the string to the value of the specified environment variable.
@@ -1035,17 +2270,11 @@ namespace Win32xx
     }
 
     // Converts all the characters in this string to lowercase characters.
-    template <>
-    inline void CStringT<CHAR>::MakeLower()
-    {
-        std::transform(m_str.begin(), m_str.end(), m_str.begin(), ToLower);
-    }
-
-    // Converts all the characters in this string to lowercase characters.
-    template <>
-    inline void CStringT<WCHAR>::MakeLower()
+    template <class T>
+    inline void CStringT<T>::MakeLower()
     {
-        std::transform(m_str.begin(), m_str.end(), m_str.begin(), ::towlower);
+        if (!m_str.empty())
+            CTextScan::MakeLower(&m_str[0], GetLength());
     }
 
     // Reverses the string.
@@ -1056,17 +2285,11 @@ namespace Win32xx
     }
 
     // Converts all the characters in this string to uppercase characters.
-    template <>
-    inline void CStringT<CHAR>::MakeUpper()
-    {
-        std::transform(m_str.begin(), m_str.end(), m_str.begin(), ToUpper);
-    }
-
-    // Converts all the characters in this string to uppercase characters.
-    template <>
-    inline void CStringT<WCHAR>::MakeUpper()
+    template <class T>
+    inline void CStringT<T>::MakeUpper()
     {
-        std::transform(m_str.begin(), m_str.end(), m_str.begin(), ::towupper);
+        if (!m_str.empty())
+            CTextScan::MakeUpper(&m_str[0], GetLength());
     }
 
     // Retrieves the middle part of a string.
@@ -1093,30 +2316,32 @@ namespace Win32xx
         return str;
     }
 
-    // This copies the contents of the buffer (acquired by GetBuffer) to this CStringT.
-    // The default length of -1 copies from the buffer until a null terminator is reached.
+    // This sets the length of this CStringT after its buffer (acquired by GetBuffer) has been written.
+    // The default length of -1 uses the characters in the buffer up to the first null terminator.
     // If the buffer doesn't contain a null terminator, you must specify the buffer's length.
+    // Each call to ReleaseBuffer must follow a call to GetBuffer.
     template <class T>
     inline void CStringT<T>::ReleaseBuffer( int newLength /*= -1*/ )
     {
+        // The buffer holds the length requested by GetBuffer, followed by the
+        // null terminator. Without a GetBuffer, the whole string is the buffer.
+        assert(m_bufferLength >= 0);
+        int bufLength = static_cast<int>(m_str.size());
+        if (m_bufferLength >= 0)
+            bufLength = MIN(m_bufferLength, bufLength);
+
+        m_bufferLength = -1;
 
         if (-1 == newLength)
         {
-            newLength = lstrlenT(&m_buf.front());
+            newLength = lstrlenT(m_str.c_str());
         }
 
-        assert(m_buf.size() > 0);
-        assert(newLength <= static_cast<int>(m_buf.size() -1));
-        newLength = MIN(newLength, static_cast<int>(m_buf.size() -1));
-
-        T ch = 0;
-        m_str.assign(static_cast<size_t>(newLength), ch);
-
-        typename std::vector<T>::iterator it_end = m_buf.begin();
-        std::advance(it_end, static_cast<T>(newLength));
+        assert(newLength <= bufLength);
+        newLength = MIN(newLength, bufLength);
+        newLength = MAX(newLength, 0);
 
-        std::copy(m_buf.begin(), it_end, m_str.begin());
-        m_buf.clear();
+        m_str.resize(static_cast<size_t>(newLength));
     }
 
     // Removes each occurrence of the specified substring from the string.
@@ -1125,35 +2350,17 @@ namespace Win32xx
     {
         assert(text != 0);
 
-        int count = 0;
-        size_t pos = 0;
-        size_t len = lstrlenT(text);
-        if (len > 0)
-        {
-            while ((pos = m_str.find(text, pos)) != std::string::npos)
-            {
-                m_str.erase(pos, len);
-                ++count;
-            }
-        }
-
-        return count;
+        int len = lstrlenT(text);
+        return (len > 0) ? ReplaceText(text, len, NULL, 0) : 0;
     }
 
     // Removes each occurrence of the specified character from the string.
     template <class T>
     inline int CStringT<T>::Remove(T ch)
     {
-        int count = 0;
-        size_t pos = 0;
-
-        while ((pos = m_str.find(ch, pos)) != std::string::npos)
-        {
-            m_str.erase(pos, 1);
-            ++count;
-        }
-
-        return count;
+        size_t oldSize = m_str.size();
+        m_str.erase(std::remove(m_str.begin(), m_str.end(), ch), m_str.end());
+        return static_cast<int>(oldSize - m_str.size());
     }
 
     // Replaces each occurrence of the old character with the new character.
@@ -1182,19 +2389,93 @@ namespace Win32xx
         assert(oldText);
         assert(newText);
 
-        int count = 0;
-        size_t pos = 0;
-        size_t lenOld = static_cast<size_t>(lstrlenT(oldText));
-        size_t lenNew = static_cast<size_t>(lstrlenT(newText));
+        int lenOld = lstrlenT(oldText);
+        int lenNew = lstrlenT(newText);
         if (lenOld > 0 && lenNew > 0)
+            return ReplaceText(oldText, lenOld, newText, lenNew);
+
+        return 0;
+    }
+
+    // Replaces each occurrence of oldText with newText in a single pass, and
+    // returns the number of replacements. Text that doesn't grow is replaced
+    // in place. Otherwise the matches are counted and the result is built
+    // with a single allocation.
+    template <class T>
+    inline int CStringT<T>::ReplaceText(const T* oldText, int oldLength, const T* newText, int newLength)
+    {
+        assert(oldLength > 0);
+
+        // Copy the text if it's part of this string.
+        const T* begin = m_str.c_str();
+        const T* end = begin + m_str.size();
+        std::basic_string<T> oldCopy;
+        std::basic_string<T> newCopy;
+        if (oldText >= begin && oldText <= end)
+        {
+            oldCopy.assign(oldText, static_cast<size_t>(oldLength));
+            oldText = oldCopy.c_str();
+        }
+        if (newText >= begin && newText <= end)
+        {
+            newCopy.assign(newText, static_cast<size_t>(newLength));
+            newText = newCopy.c_str();
+        }
+
+        int length = GetLength();
+        int pos = FindText(begin, length, oldText, oldLength);
+        if (pos < 0)
+            return 0;
+
+        int count = 0;
+        int read = 0;
+        if (newLength <= oldLength)
+        {
+            // Move the text between the matches down as they're replaced.
+            T* str = &m_str[0];
+            int write = 0;
+            while (pos >= 0)
+            {
+                memmove(str + write, str + read, pos * sizeof(T));
+                write += pos;
+                if (newLength > 0)
+                    memcpy(str + write, newText, newLength * sizeof(T));
+
+                write += newLength;
+                read += pos + oldLength;
+                ++count;
+                pos = FindText(str + read, length - read, oldText, oldLength);
+            }
+
+            memmove(str + write, str + read, (length - read) * sizeof(T));
+            m_str.resize(static_cast<size_t>(write + length - read));
+        }
+        else
         {
-            while ((pos = m_str.find(oldText, pos)) != std::string::npos)
+            // Count the matches to size the result.
+            int next = pos;
+            while (next >= 0)
             {
-                m_str.replace(pos, lenOld, newText);
-                pos += lenNew;
                 ++count;
+                read += next + oldLength;
+                next = FindText(begin + read, length - read, oldText, oldLength);
+            }
+
+            std::basic_string<T> result;
+            result.reserve(static_cast<size_t>(length) + static_cast<size_t>(count) * (newLength - oldLength));
+            read = 0;
+            while (pos >= 0)
+            {
+                result.append(begin + read, static_cast<size_t>(pos));
+                result.append(newText, static_cast<size_t>(newLength));
+                read += pos + oldLength;
+                pos = FindText(begin + read, length - read, oldText, oldLength);
             }
+
+            result.append(begin + read, static_cast<size_t>(length - read));
+            m_str.swap(result);
         }
+
         return count;
     }
 
@@ -1439,6 +2720,224 @@ namespace Win32xx
         }
     }
 
+    ///////////////////////////////////////////////////
+    // Definitions for the CStringBuilderT class template
+    //
+
+    // Appends the text.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::Append(const T* text)
+    {
+        assert(text != 0);
+        return Append(text, static_cast<int>(std::char_traits<T>::length(text)));
+    }
+
+    // Appends length characters of text. The text fills the last chunk, and
+    // any text that doesn't fit is added to a new chunk.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::Append(const T* text, int length)
+    {
+        assert(length >= 0);
+        if (length > 0)
+        {
+            if (m_chunks.empty())
+                AddChunk(length);
+
+            std::basic_string<T>& chunk = m_chunks.back();
+            int space = static_cast<int>(chunk.capacity() - chunk.size());
+            int part = MIN(space, length);
+            chunk.append(text, static_cast<size_t>(part));
+            if (part < length)
+                AddChunk(length - part).append(text + part, static_cast<size_t>(length - part));
+
+            m_length += length;
+        }
+
+        return *this;
+    }
+
+    // Appends the string.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::Append(const CStringT<T>& str)
+    {
+        return Append(str.c_str(), str.GetLength());
+    }
+
+    // Appends the character repeat times.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::Append(T ch, int repeat /* = 1 */)
+    {
+        assert(repeat >= 0);
+        if (repeat > 0)
+        {
+            if (m_chunks.empty())
+                AddChunk(repeat);
+
+            std::basic_string<T>& chunk = m_chunks.back();
+            int space = static_cast<int>(chunk.capacity() - chunk.size());
+            int part = MIN(space, repeat);
+            chunk.append(static_cast<size_t>(part), ch);
+            if (part < repeat)
+                AddChunk(repeat - part).append(static_cast<size_t>(repeat - part), ch);
+
+            m_length += repeat;
+        }
+
+        return *this;
+    }
+
+    // Appends formatted text, as sprintf does.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendFormat(const T* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        AppendFormatV(format, args);
+        va_end(args);
+        return *this;
+    }
+
+#ifdef WXX_VARIADIC_TEMPLATES
+
+    // Appends formatted text. Unlike AppendFormat, the arguments can include
+    // CString objects, and common specifiers are formatted without the C runtime.
+    template <class T>
+    template <class... Args>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendFormatT(const T* format, const Args&... args)
+    {
+        m_format.FormatT(format, args...);
+        return Append(m_format);
+    }
+
+#endif
+
+    // Appends formatted text, using a list of arguments.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendFormatV(const T* format, va_list args)
+    {
+        m_format.FormatV(format, args);
+        return Append(m_format);
+    }
+
+    // Appends a carriage return and line feed.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendLine()
+    {
+        const T newLine[] = { '\r', '\n' };
+        return Append(newLine, 2);
+    }
+
+    // Appends the text, followed by a carriage return and line feed.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendLine(const T* text)
+    {
+        Append(text);
+        return AppendLine();
+    }
+
+    // Appends the string, followed by a carriage return and line feed.
+    template <class T>
+    inline CStringBuilderT<T>& CStringBuilderT<T>::AppendLine(const CStringT<T>& str)
+    {
+        Append(str);
+        return AppendLine();
+    }
+
+    // Adds a chunk with space for at least length characters, and returns it.
+    // A new chunk is as large as the text already added, up to 1M characters.
+    template <class T>
+    inline std::basic_string<T>& CStringBuilderT<T>::AddChunk(int length)
+    {
+        const int maxChunkSize = 1024 * 1024;
+        int size = MAX(WXX_BUILDER_CHUNK_SIZE, MIN(m_length, maxChunkSize));
+
+        m_chunks.push_back(std::basic_string<T>());
+        std::basic_string<T>& chunk = m_chunks.back();
+        chunk.reserve(static_cast<size_t>(MAX(size, length)));
+        return chunk;
+    }
+
+    // Returns the text as a null terminated string. The chunks are joined
+    // first if there is more than one. The pointer is valid until the text
+    // is changed.
+    template <class T>
+    inline const T* CStringBuilderT<T>::c_str()
+    {
+        if (m_chunks.size() > 1)
+        {
+            std::basic_string<T> text;
+            text.reserve(static_cast<size_t>(m_length));
+            typename std::list<std::basic_string<T> >::const_iterator it;
+            for (it = m_chunks.begin(); it != m_chunks.end(); ++it)
+                text.append(*it);
+
+            m_chunks.clear();
+            m_chunks.push_back(std::basic_string<T>());
+            m_chunks.back().swap(text);
+        }
+
+        if (m_chunks.empty())
+            AddChunk(0);
+
+        return m_chunks.front().c_str();
+    }
+
+    // Removes the text. The chunk with the largest capacity is kept for reuse.
+    template <class T>
+    inline void CStringBuilderT<T>::Clear()
+    {
+        if (!m_chunks.empty())
+        {
+            typename std::list<std::basic_string<T> >::iterator largest = m_chunks.begin();
+            typename std::list<std::basic_string<T> >::iterator it;
+            for (it = m_chunks.begin(); it != m_chunks.end(); ++it)
+            {
+                if (it->capacity() > largest->capacity())
+                    largest = it;
+            }
+
+            // Move the largest chunk to the end, and erase the others.
+            m_chunks.splice(m_chunks.end(), m_chunks, largest);
+            m_chunks.erase(m_chunks.begin(), --m_chunks.end());
+            m_chunks.back().clear();
+        }
+
+        m_length = 0;
+    }
+
+    // Moves the text to str, and clears the builder. Text held in a single
+    // chunk is handed to str without copying.
+    template <class T>
+    inline void CStringBuilderT<T>::MoveTo(CStringT<T>& str)
+    {
+        if (m_chunks.size() == 1)
+            str.m_str.swap(m_chunks.front());
+        else
+        {
+            str.m_str.clear();
+            str.m_str.reserve(static_cast<size_t>(m_length));
+            typename std::list<std::basic_string<T> >::const_iterator it;
+            for (it = m_chunks.begin(); it != m_chunks.end(); ++it)
+                str.m_str.append(*it);
+        }
+
+        Clear();
+    }
+
+    // Returns a copy of the text, made with a single allocation.
+    template <class T>
+    inline CStringT<T> CStringBuilderT<T>::ToString() const
+    {
+        CStringT<T> str;
+        str.m_str.reserve(static_cast<size_t>(m_length));
+        typename std::list<std::basic_string<T> >::const_iterator it;
+        for (it = m_chunks.begin(); it != m_chunks.end(); ++it)
+            str.m_str.append(*it);
+
+        return str;
+    }
+
+
     /////////////////////////////
     // Global ToCString functions
     //
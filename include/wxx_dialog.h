@@ -236,24 +236,28 @@ namespace Win32xx
     inline CDialog::CDialog() : m_isModal(FALSE),
         m_resourceName(NULL), m_pDlgTemplate(NULL)
     {
+        EnablePreTranslate();
     }
 
     // Constructor that specifies the dialog's resource
     inline CDialog::CDialog(LPCTSTR resourceName) : m_isModal(FALSE),
                         m_resourceName(resourceName), m_pDlgTemplate(NULL)
     {
+        EnablePreTranslate();
     }
 
     // Constructor that specifies the dialog's resource ID
     inline CDialog::CDialog(UINT resourceID) : m_isModal(FALSE),
                         m_resourceName(MAKEINTRESOURCE (resourceID)), m_pDlgTemplate(NULL)
     {
+        EnablePreTranslate();
     }
 
     // Constructor for indirect dialogs, created from a dialog box template in memory.
     inline CDialog::CDialog(LPCDLGTEMPLATE pDlgTemplate) : m_isModal(FALSE),
                         m_resourceName(NULL), m_pDlgTemplate(pDlgTemplate)
     {
+        EnablePreTranslate();
     }
 
     inline CDialog::~CDialog()
@@ -400,7 +404,7 @@ namespace Win32xx
 
         case WM_ERASEBKGND:
             {
-                CDC dc(reinterpret_cast<HDC>(wparam));
+                CDCView dc(reinterpret_cast<HDC>(wparam));
                 return OnEraseBkgnd(dc);
             }
 
@@ -864,14 +864,13 @@ namespace Win32xx
                 // Acquire the DC for our NonClient painting
                 CWindowDC dc(*this);
 
-                // Create and set up our memory DC
+                // Create and set up our memory DC. It uses the thread's paint buffer.
                 CRect rc = GetWindowRect();
-                CMemDC memDC(dc);
                 int rcAdjust = (GetExStyle() & WS_EX_CLIENTEDGE) ? 2 : 0;
                 int Width = MAX(rc.Width() - rcAdjust, 0);
 
                 int Height = m_pDocker->m_ncHeight + rcAdjust;
-                memDC.CreateCompatibleBitmap(dc, Width, Height);
+                CBufferedDC memDC(dc, CRect(rcAdjust, rcAdjust, rcAdjust + Width, rcAdjust + Height));
                 m_isOldFocusStored = Focus;
 
                 // Set the font for the title
@@ -910,7 +909,7 @@ namespace Win32xx
                     Draw3DBorder(rc);
 
                 // Copy the Memory DC to the window's DC
-                dc.BitBlt(rcAdjust, rcAdjust, Width, Height, memDC, rcAdjust, rcAdjust, SRCCOPY);
+                memDC.Flush();
             }
         }
     }
@@ -731,7 +731,7 @@ namespace Win32xx
                     else
                         rc.InflateRect(0, -1);
 
-                    CDC drawDC(lpNMCustomDraw->nmcd.hdc);
+                    CDCView drawDC(lpNMCustomDraw->nmcd.hdc);
                     if (state & (CDIS_HOT | CDIS_SELECTED))
                     {
                         if ((state & CDIS_SELECTED) || (pMenubar->GetButtonState(item) & TBSTATE_PRESSED))
@@ -744,7 +744,9 @@ namespace Win32xx
                         }
 
                         // Draw border.
-                        CPen pen(PS_SOLID, 1, GetMenuBarTheme().clrOutline);
+                        CGDICache* pCache = GetApp()->GetGDICache();
+                        COLORREF outline = GetMenuBarTheme().clrOutline;
+                        CPen pen = pCache ? pCache->GetPen(PS_SOLID, 1, outline) : CPen(PS_SOLID, 1, outline);
                         CPen oldPen = drawDC.SelectObject(pen);
                         drawDC.MoveTo(rc.left, rc.bottom);
                         drawDC.LineTo(rc.left, rc.top);
@@ -805,7 +807,7 @@ namespace Win32xx
                 // An item is about to be drawn.
                 case CDDS_ITEMPREPAINT:
                     {
-                        CDC drawDC(pCustomDraw->nmcd.hdc);
+                        CDCView drawDC(pCustomDraw->nmcd.hdc);
                         CRect rc = pCustomDraw->nmcd.rc;
                         int state = pCustomDraw->nmcd.uItemState;
                         DWORD item = static_cast<DWORD>(pCustomDraw->nmcd.dwItemSpec);
@@ -998,7 +1000,7 @@ namespace Win32xx
         {
             // Draw the gutter.
             CRect gutter = GetMenuMetrics().GetGutterRect(pDIS->rcItem);
-            CDC drawDC(pDIS->hDC);
+            CDCView drawDC(pDIS->hDC);
             const MenuTheme& mbt = GetMenuBarTheme();
             drawDC.GradientFill(mbt.clrPressed1, mbt.clrPressed2, gutter, TRUE);
 
@@ -1038,15 +1040,16 @@ namespace Win32xx
         bool isDisabled = (pDIS->itemState & ODS_GRAYED) != FALSE;
         bool isSelected = (pDIS->itemState & ODS_SELECTED) != FALSE;
         CRect drawRect = pDIS->rcItem;
-        CDC drawDC(pDIS->hDC);
+        CDCView drawDC(pDIS->hDC);
         const MenuTheme& mbt = GetMenuBarTheme();
 
         if ((isSelected) && (!isDisabled))
         {
             // draw selected item background.
-            CBrush brush(mbt.clrHot1);
+            CGDICache* pCache = GetApp()->GetGDICache();
+            CBrush brush = pCache ? pCache->GetBrush(mbt.clrHot1) : CBrush(mbt.clrHot1);
             CBrush oldBrush = drawDC.SelectObject(brush);
-            CPen pen(PS_SOLID, 1, mbt.clrOutline);
+            CPen pen = pCache ? pCache->GetPen(PS_SOLID, 1, mbt.clrOutline) : CPen(PS_SOLID, 1, mbt.clrOutline);
             CPen oldPen = drawDC.SelectObject(pen);
             drawDC.Rectangle(drawRect.left, drawRect.top, drawRect.right, drawRect.bottom);
             drawDC.SelectObject(oldBrush);
@@ -1069,7 +1072,7 @@ namespace Win32xx
         UINT fType = pmid->mii.fType;
         const MenuTheme& mbt = GetMenuBarTheme();
         CRect bkRect;
-        CDC drawDC(pDIS->hDC);
+        CDCView drawDC(pDIS->hDC);
 
         // Draw the checkmark's background rectangle first.
         int xIcon = GetMenuMetrics().m_sizeCheck.cx;
@@ -2247,6 +2250,9 @@ namespace Win32xx
     template <class T>
     inline LRESULT CFrameT<T>::OnSysColorChange(UINT msg, WPARAM, LPARAM)
     {
+        // Discard the cached pens, brushes and fonts.
+        GetApp()->TrimGDICache();
+
         // Honour theme color changes
         if (GetReBar().IsWindow())
         {
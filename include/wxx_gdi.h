@@ -46,6 +46,15 @@
 //  itself as appropriate. Any failure to create the new GDI object throws an
 //  exception.
 //
+// CDCView provides the drawing functions of CDC for a device context that is
+//  owned by someone else, such as the HDC passed with WM_ERASEBKGND or
+//  WM_DRAWITEM. It's cheaper to construct than a CDC, because its data isn't
+//  allocated from the heap.
+//
+// CDIBSection is a bitmap whose 32 bit pixels can be accessed directly
+//  through a CDIBView. Image filters can modify its pixels in place, and it
+//  can be selected into a CMemDC and drawn without converting its format.
+//
 // The CDC class is sufficient for most GDI programming needs. Sometimes
 //  however we need to have the GDI object separated from the device context.
 //  Wrapper classes for GDI objects are provided for this purpose. The classes
@@ -127,6 +136,13 @@
 //     the destructor is called deleting their GDI object if Win32++ created it.
 //  * When the CDC object's destructor is called, any GDI objects created by one of
 //     the CDC member functions (CDC::CreatePen for example) will be deleted.
+//  * CDC::CreatePen, CDC::CreateSolidBrush and CDC::CreateFontIndirect share the
+//     pens, brushes and fonts held in the thread's CGDICache. Cached objects are
+//     deleted when they're removed from the cache and no longer selected.
+//  * CBufferedDC provides double buffered painting. It draws to the thread's
+//     CPaintBuffer, which is reused rather than created for each paint.
+//  * CWnd::OnDrawRegion receives the update region as a CUpdateRegion. Use
+//     CUpdateRegion::Intersects to skip drawing what doesn't need painting.
 //  * Bitmaps can only be selected into one device context at a time.
 //  * Other GDI resources can be selected into more than one device context at a time.
 //  * Palettes use SelectPalatte to select them into device the context.
@@ -166,6 +182,7 @@
 #include "wxx_wincore0.h"
 #include "wxx_exception.h"
 #include "wxx_metafile.h"
+#include "wxx_pixels.h"
 
 // Disable macros from Windowsx.h
 #undef CopyRgn
@@ -179,6 +196,8 @@ namespace Win32xx
     // such as bitmaps, brushes, palettes, fonts, pens and regions.
     class CGDIObject
     {
+        friend class CSelectedObject;   // CSelectedObject uses ReleaseData
+
     public:
         CGDIObject();
         CGDIObject(const CGDIObject& rhs);
@@ -194,12 +213,16 @@ namespace Win32xx
 
     protected:
         void    Release();
-        void    SetManaged(bool isManaged) const { m_pData->isManagedObject = isManaged; }
+        void    SetManaged(bool isManaged) const;
 
     private:
-        void    AddToMap();
+        void    AddToMap() const;
         BOOL    RemoveFromMap();
 
+        static void DeleteData(CGDI_Data* pData);
+        static CGDI_Data* NewData();
+        static void ReleaseData(CGDI_Data* pData);
+
         CGDI_Data* m_pData;
     };
 
@@ -244,6 +267,67 @@ namespace Win32xx
     };
 
 
+    //////////////////////////////////////////////////////////////////
+    // CDIBView provides direct access to a rectangle of pixels in a
+    // 32 bit DIB section. Rows are numbered from the top, whether the
+    // DIB is top-down or bottom-up. Each pixel is a RGBQUAD. A view
+    // doesn't own the pixels, so it mustn't be used after the DIB
+    // section is deleted.
+    class CDIBView
+    {
+    public:
+        CDIBView();
+        CDIBView(HBITMAP bitmap);
+        CDIBView(BYTE* pBits, int width, int height, int stride);
+
+        void  ConvertToDisabled(COLORREF mask) const;
+        void  GrayScale() const;
+        void  Tint(int red, int green, int blue) const;
+
+        // Accessors
+        BYTE* GetBits() const   { return m_pBits; }
+        int   GetHeight() const { return m_height; }
+        RGBQUAD* GetRow(int row) const;
+        int   GetStride() const { return m_stride; }
+        CDIBView GetView(const RECT& rc) const;
+        int   GetWidth() const  { return m_width; }
+        BOOL  IsEmpty() const   { return (m_pBits == 0); }
+
+    private:
+        BYTE* m_pBits;      // The first byte of the top row
+        int m_width;        // The width in pixels
+        int m_height;       // The number of rows
+        int m_stride;       // The number of bytes from one row to the next, which can be negative
+    };
+
+
+    //////////////////////////////////////////////////////////////////
+    // CDIBSection manages a 32 bit top-down DIB section. Its pixels can
+    // be accessed directly with GetView, so image filters modify them in
+    // place rather than copying them with GetDIBits and SetDIBits. Like
+    // other bitmaps, it can be selected into a CMemDC and drawn with BitBlt.
+    // Note: Call GetView again after drawing on the DIB section with GDI.
+    //       GetView calls GdiFlush to complete any pending GDI drawing.
+    class CDIBSection : public CBitmap
+    {
+    public:
+        CDIBSection();
+        CDIBSection(HBITMAP bitmap);
+        CDIBSection(int width, int height);
+        virtual ~CDIBSection();
+
+        HBITMAP Create(int width, int height);
+        HBITMAP CreateCopy(HBITMAP bitmap);
+
+        // Accessors
+        BYTE*  GetBits() const;
+        DIBSECTION GetDIBSectionData() const;
+        int    GetStride() const;
+        CDIBView GetView() const;
+        CDIBView GetView(const RECT& rc) const;
+    };
+
+
     /////////////////////////////////////
     // CBrush manages a brush GDI object.
     class CBrush : public CGDIObject
@@ -376,29 +460,53 @@ namespace Win32xx
     };
 
 
+    //////////////////////////////////////////////////////////////////
+    // CSelectedObject holds a reference to a GDI object selected into a
+    // device context, so the GDI object isn't deleted while it's
+    // selected. Unlike a CGDIObject, an empty CSelectedObject has no
+    // data, so constructing a CDC doesn't allocate data for each slot.
+    class CSelectedObject
+    {
+    public:
+        CSelectedObject() : m_pData(0) {}
+        ~CSelectedObject() { Release(); }
+        CSelectedObject& operator = (const CGDIObject& object);
+
+        void Release();
+
+    private:
+        CSelectedObject(const CSelectedObject&);                // Disable copy construction
+        CSelectedObject& operator = (const CSelectedObject&);   // Disable assignment operator
+
+        CGDI_Data* m_pData;
+    };
+
+
     // A structure that contains the data members for CDC.
     struct CDC_Data
     {
         // Constructor
         CDC_Data() : dc(0), count(1L), isManagedHDC(FALSE), wnd(0),
-                     savedDCState(0), isPaintDC(false)
+                     savedDCState(0), isPaintDC(false), isViewData(false), pMaps(0)
         {
             ZeroMemory(&ps, sizeof(ps));
         }
 
-        CBitmap bitmap;
-        CBrush  brush;
-        CFont   font;
-        CPalette palette;
-        CPen    pen;
-        CRgn    rgn;
+        CSelectedObject bitmap; // The objects selected by this CDC
+        CSelectedObject brush;
+        CSelectedObject font;
+        CSelectedObject palette;
+        CSelectedObject pen;
+        CSelectedObject rgn;
         HDC     dc;             // The HDC belonging to this CDC
         long    count;          // Reference count
         bool    isManagedHDC;   // Delete/Release the HDC on destruction
         HWND    wnd;            // The HWND of a Window or Client window DC
         int     savedDCState;   // The save state of the HDC.
         bool    isPaintDC;
+        bool    isViewData;     // The data belongs to a CDCView
         PAINTSTRUCT ps;
+        HandleMaps* pMaps;      // The maps holding this HDC, if any
     };
 
 
@@ -738,9 +846,11 @@ namespace Win32xx
   #endif // (_WIN32_WINNT >= 0x0500) && !defined(__GNUC__)
 
     protected:
+        CDC(HDC dc, CDC_Data* pViewData);      // Constructs a CDC for a CDCView
+
         PAINTSTRUCT* GetPaintStruct() const { return &m_pData->ps; }
         void Release();
-        void SetManaged(bool isManaged) { m_pData->isManagedHDC = isManaged; }
+        void SetManaged(bool isManaged);
         void SetPaintDC(bool isPaintDC) { m_pData->isPaintDC = isPaintDC; }
         void SetWindow(HWND wnd) { m_pData->wnd = wnd; }
 
@@ -749,6 +859,9 @@ namespace Win32xx
         void Initialize();
         BOOL RemoveFromMap();
 
+        static void DeleteData(CDC_Data* pData);
+        static CDC_Data* NewData();
+
         CDC_Data* m_pData;      // pointer to the class's data members
     };
 
@@ -912,6 +1025,37 @@ namespace Win32xx
     };
 
 
+    // Holds the data of a CDCView. CDCView inherits this before CDC, so
+    // the data is constructed before the CDC and destroyed after it.
+    struct CDCView_Data
+    {
+        CDC_Data viewData;
+    };
+
+
+    //////////////////////////////////////////////////////////////////////
+    // CDCView wraps a device context owned by someone else, such as the
+    // HDC passed with WM_ERASEBKGND, WM_DRAWITEM or NM_CUSTOMDRAW. It has
+    // the drawing API of CDC, but doesn't allocate data from the heap or
+    // add the HDC to the map. The state of the device context is saved
+    // when the CDCView is constructed, and restored when it's destroyed.
+    // Restoring the state deselects the objects selected by the CDCView.
+    // Note: A CDCView can be passed to functions that take a CDC&. A CDC
+    //       copied from a CDCView has its own data from the heap, so it can
+    //       outlive the CDCView. The copy doesn't select the objects
+    //       selected by the CDCView.
+    class CDCView : private CDCView_Data, public CDC
+    {
+    public:
+        explicit CDCView(HDC dc) : CDC(dc, &viewData) {}
+        virtual ~CDCView() {}
+
+    private:
+        CDCView(const CDCView&);                // Disable copy construction
+        CDCView& operator = (const CDCView&);   // Disable assignment operator
+    };
+
+
     ///////////////////////////////////////////////
     // CMetaFileDC manages a GDI device context for
     // a Windows-format metafile.
@@ -1062,6 +1206,198 @@ namespace Win32xx
     };
 
 
+    // The attributes that identify an object in a CGDICache.
+    struct GDICacheKey
+    {
+        GDICacheKey() : type(0), style(0), width(0), color(0)
+        {
+            ZeroMemory(&logFont, sizeof(logFont));
+        }
+
+        bool operator < (const GDICacheKey& rhs) const;
+
+        DWORD    type;      // OBJ_BRUSH, OBJ_FONT or OBJ_PEN
+        int      style;     // The pen style
+        int      width;     // The pen width
+        COLORREF color;     // The pen or brush color
+        LOGFONT  logFont;   // The font attributes
+    };
+
+    // An object held by a CGDICache.
+    struct GDICacheEntry
+    {
+        GDICacheEntry(const CGDIObject& gdiObject, LONGLONG use) : object(gdiObject), lastUse(use) {}
+
+        CGDIObject object;  // A copy of the cached pen, brush or font
+        LONGLONG lastUse;   // When the object was last requested
+    };
+
+    // The statistics recorded by a CGDICache.
+    struct GDICacheStats
+    {
+        GDICacheStats() : hits(0), misses(0), evictions(0) {}
+
+        LONGLONG hits;      // Requests returned from the cache
+        LONGLONG misses;    // Requests that created a GDI object
+        LONGLONG evictions; // Objects removed from the cache
+    };
+
+    // The default number of objects held by a CGDICache.
+    const size_t WXX_GDI_CACHE_LIMIT = 128;
+
+
+    ////////////////////////////////////////////////////////////////////
+    // CGDICache holds the pens, brushes and fonts used by a thread, so
+    // redrawing doesn't create and delete the same GDI objects each time.
+    // Requesting an object with the same attributes returns a copy of the
+    // same CPen, CBrush or CFont. When the cache is full, the least
+    // recently used object is removed. A removed GDI object is deleted
+    // when the last copy of it is destroyed.
+    // CDC::CreatePen, CDC::CreateSolidBrush and CDC::CreateFontIndirect
+    // use the cache. Use CWinApp::GetGDICache to retrieve the calling
+    // thread's cache. Only threads with TLS data, such as threads that
+    // create windows, have a cache. It's deleted when the thread's
+    // CWinThread message loop ends, or when CWinApp is destroyed.
+    // Note: The objects returned are shared, so they must not be modified
+    //       or deleted.
+    class CGDICache
+    {
+    public:
+        CGDICache() : m_limit(WXX_GDI_CACHE_LIMIT), m_useCount(0) {}
+        ~CGDICache() {}
+
+        CBrush GetBrush(COLORREF color);
+        CFont  GetFont(const LOGFONT& logFont);
+        size_t GetLimit() const { return m_limit; }
+        CPen   GetPen(int style, int width, COLORREF color);
+        size_t GetSize() const { return m_objects.size(); }
+        GDICacheStats GetStats() const { return m_stats; }
+        void   ResetStats() { m_stats = GDICacheStats(); }
+        void   SetLimit(size_t limit);
+        void   Trim(size_t maxObjects = 0);
+
+    private:
+        CGDICache(const CGDICache&);                // Disable copy construction
+        CGDICache& operator = (const CGDICache&);   // Disable assignment operator
+
+        void    Add(const GDICacheKey& key, const CGDIObject& object);
+        HGDIOBJ Find(const GDICacheKey& key);
+
+        std::map<GDICacheKey, GDICacheEntry> m_objects;
+        GDICacheStats m_stats;
+        size_t m_limit;         // The maximum number of objects held
+        LONGLONG m_useCount;    // Incremented for each request
+    };
+
+
+    // The time in milliseconds a paint buffer's bitmap is kept while it
+    // isn't used.
+    const UINT WXX_PAINT_BUFFER_TIMEOUT = 10000;
+
+
+    ////////////////////////////////////////////////////////////////////
+    // CPaintBuffer holds the bitmap a thread uses as the back buffer for
+    // double buffered painting. The bitmap grows to the largest size
+    // requested, and is reused rather than created for each paint. If
+    // the bitmap is already in use, such as when painting is nested,
+    // GetBitmap returns a new bitmap instead. The bitmap is deleted once
+    // it hasn't been used for WXX_PAINT_BUFFER_TIMEOUT milliseconds, so
+    // the next paint creates a bitmap of the size it needs. CBufferedDC
+    // uses the paint buffer. Use CWinApp::GetPaintBuffer to retrieve the
+    // calling thread's paint buffer.
+    class CPaintBuffer
+    {
+    public:
+        CPaintBuffer() : m_bitsPixel(0), m_isInUse(FALSE), m_releaseTime(0), m_timer(0) {}
+        ~CPaintBuffer();
+
+        CBitmap GetBitmap(HDC dc, int width, int height);
+        CSize   GetSize() const   { return m_size; }
+        BOOL    IsInUse() const   { return m_isInUse; }
+        void    ReleaseBitmap(HBITMAP bitmap);
+        void    Trim();
+
+    private:
+        CPaintBuffer(const CPaintBuffer&);                // Disable copy construction
+        CPaintBuffer& operator = (const CPaintBuffer&);   // Disable assignment operator
+
+        static void CALLBACK IdleTimerProc(HWND wnd, UINT msg, UINT_PTR eventID, DWORD time);
+
+        CBitmap m_bitmap;       // The shared back buffer
+        CSize m_size;           // The size of m_bitmap
+        int m_bitsPixel;        // The color depth of m_bitmap
+        BOOL m_isInUse;         // TRUE while m_bitmap is selected into a CBufferedDC
+        DWORD m_releaseTime;    // The tick count when m_bitmap was last released
+        UINT_PTR m_timer;       // thread timer that deletes m_bitmap when it's idle
+    };
+
+
+    ////////////////////////////////////////////////////////////////////
+    // CBufferedDC is a memory DC used to paint part of a device context
+    // without flicker. Draw to the CBufferedDC using the co-ordinates of
+    // the device context. The drawing is clipped to the specified
+    // rectangle, and only that rectangle is copied to the device context
+    // when the CBufferedDC is destroyed, or when Flush is called. The
+    // CBufferedDC's bitmap is the thread's CPaintBuffer, so painting
+    // doesn't create a bitmap each time.
+    // Note: The rectangle is specified in device units.
+    class CBufferedDC : public CMemDC
+    {
+    public:
+        CBufferedDC(HDC dc, const RECT& rc);
+        virtual ~CBufferedDC();
+
+        void Flush();
+        const CRect& GetRect() const { return m_rect; }
+
+    private:
+        CBufferedDC(const CBufferedDC&);                // Disable copy construction
+        CBufferedDC& operator = (const CBufferedDC&);   // Disable assignment operator
+
+        CBitmap m_buffer;       // The bitmap selected into this DC
+        HDC m_targetDC;         // The device context to copy the drawing to
+        CRect m_rect;           // The part of the target DC that's painted
+        BOOL m_isFlushed;       // TRUE once the drawing has been copied
+    };
+
+
+    // The maximum number of rectangles held by a CUpdateRegion.
+    const int WXX_MAX_UPDATE_RECTS = 32;
+
+
+    ////////////////////////////////////////////////////////////////////
+    // CUpdateRegion describes the part of a window that needs painting
+    // as a list of rectangles. CWnd::OnDrawRegion receives the update
+    // region, so a window can skip drawing the things that don't
+    // intersect it. A region with more than WXX_MAX_UPDATE_RECTS
+    // rectangles is represented by its bounding rectangle, so testing
+    // whether something intersects the region is always cheap. The
+    // rectangles are stored without allocating memory.
+    class CUpdateRegion
+    {
+    public:
+        CUpdateRegion() : m_count(0) {}
+        CUpdateRegion(const RECT& rc) : m_count(0) { SetRect(rc); }
+
+        void  DPtoLP(HDC dc);
+        const CRect& GetBounds() const      { return m_bounds; }
+        int   GetCount() const              { return m_count; }
+        const CRect& GetRect(int index) const;
+        void  InflateRect(int dx, int dy);
+        BOOL  Intersects(const RECT& rc) const;
+        BOOL  IsEmpty() const               { return (m_count == 0); }
+        void  SetRect(const RECT& rc);
+        void  SetRegion(HRGN rgn);
+        void  SetUpdateRgn(HWND wnd);
+
+    private:
+        void  UpdateBounds();
+
+        CRect m_rects[WXX_MAX_UPDATE_RECTS];  // The rectangles that make up the region
+        CRect m_bounds;                       // The bounding rectangle of the region
+        int   m_count;                        // The number of rectangles
+    };
+
 }
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1077,7 +1413,7 @@ namespace Win32xx
     // Constructs the CGDIObject
     inline CGDIObject::CGDIObject()
     {
-        m_pData = new CGDI_Data;
+        m_pData = NewData();
     }
 
     // Note: A copy of a CGDIObject is a clone of the original.
@@ -1113,19 +1449,27 @@ namespace Win32xx
         Attach(object);
     }
 
-    // Store the HDC and CDC pointer in the HDC map
-    inline void CGDIObject::AddToMap()
+    // Store the HGDIOBJ and CGDI_Data pointer in the thread's map. Only
+    // managed GDI objects are added, so only one CGDIObject's data can be
+    // mapped to the GDI object.
+    inline void CGDIObject::AddToMap() const
     {
         assert(m_pData->hGDIObject);
 
-        GetApp()->AddCGDIData(m_pData->hGDIObject, m_pData);
+        CGDI_Data* pMappedData = GetApp()->AddCGDIData(m_pData->hGDIObject, m_pData);
+        if (pMappedData != m_pData)
+        {
+            // The GDI object is already managed by another CGDIObject.
+            TRACE("*** Warning in CGDIObject::AddToMap: the GDI object is already managed ***\n");
+            assert(pMappedData == m_pData);
+            ReleaseData(pMappedData);
+        }
     }
 
     // Attaches a GDI HANDLE to the CGDIObject.
     inline void CGDIObject::Attach(HGDIOBJ object)
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_gdiLock);
 
         if (m_pData && object != m_pData->hGDIObject)
         {
@@ -1133,23 +1477,24 @@ namespace Win32xx
             if (m_pData->hGDIObject != 0)
             {
                 Release();
-                m_pData = new CGDI_Data;
+                m_pData = NewData();
             }
 
             if (object)
             {
-                // Add the GDI object to this CCGDIObject.
+                // Share the data of a CGDIObject that manages this GDI object,
+                // so the GDI object isn't deleted while it's used here.
+                // GetCGDIData increments the reference count.
                 CGDI_Data* pCGDIData = GetApp()->GetCGDIData(object);
                 if (pCGDIData)
                 {
-                    delete m_pData;
+                    ReleaseData(m_pData);
                     m_pData = pCGDIData;
-                    InterlockedIncrement(&m_pData->count);
                 }
                 else
                 {
+                    // The data is added to the map when the object is managed.
                     m_pData->hGDIObject = object;
-                    AddToMap();
                 }
             }
         }
@@ -1168,6 +1513,21 @@ namespace Win32xx
         }
     }
 
+    // Destroys the data, and returns its memory to the calling thread's
+    // free list. Threads without TLS data return it to the heap.
+    inline void CGDIObject::DeleteData(CGDI_Data* pData)
+    {
+        pData->~CGDI_Data();
+        CResourceCounter::Remove(RESOURCE_GDI_DATA);
+
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        TLSData* pTLSData = pApp ? pApp->GetTlsData() : 0;
+        if (pTLSData != 0)
+            pTLSData->gdiDataPool.Free(pData);
+        else
+            ::operator delete(pData);
+    }
+
     // Detaches the HGDIOBJ from this CGDIObject and all its copies.
     // The CGDIObject and its copies are returned to the default state.
     // Note: We rarely need to detach the HGDIOBJ from CGDIObject.
@@ -1175,6 +1535,7 @@ namespace Win32xx
     //       when the last copy of the CDC goes out of scope.
     //       This also applies to classes inherited from CGDIObject, namely
     //       CBitmap, CBrush, CFont, CPalette, CPen and CRgn.
+    //       The resource telemetry counts a detached HGDIOBJ as destroyed.
     inline HGDIOBJ CGDIObject::Detach()
     {
         assert(m_pData);
@@ -1185,15 +1546,8 @@ namespace Win32xx
         m_pData->hGDIObject = 0;
         SetManaged(false);
 
-        if (m_pData->count > 0)
-        {
-            if (InterlockedDecrement(&m_pData->count) == 0)
-            {
-                delete m_pData;
-            }
-        }
-
-        m_pData = new CGDI_Data;
+        ReleaseData(m_pData);
+        m_pData = NewData();
         return object;
     }
 
@@ -1212,27 +1566,59 @@ namespace Win32xx
         return m_pData ? ::GetObject(m_pData->hGDIObject, count, pObject) : 0;
     }
 
+    // Constructs the data for a CGDIObject. The memory of released data is
+    // reused if the calling thread's free list has any.
+    inline CGDI_Data* CGDIObject::NewData()
+    {
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        TLSData* pTLSData = pApp ? pApp->GetTlsData() : 0;
+        void* pBlock = (pTLSData != 0) ?
+            pTLSData->gdiDataPool.Allocate(sizeof(CGDI_Data), pTLSData->gdiStats) :
+            ::operator new(sizeof(CGDI_Data));
+
+        CResourceCounter::Add(RESOURCE_GDI_DATA);
+        return new (pBlock) CGDI_Data;
+    }
+
     // Decrements the reference count.
     // Destroys m_pData if the reference count is zero.
     inline void CGDIObject::Release()
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_gdiLock);
+        if (m_pData == 0)
+            return;
 
-        if (m_pData && InterlockedDecrement(&m_pData->count) == 0)
+        ReleaseData(m_pData);
+        m_pData = 0;
+    }
+
+    // Decrements the reference count of the data. When the reference count
+    // reaches zero, a managed GDI object is deleted and the data is destroyed.
+    inline void CGDIObject::ReleaseData(CGDI_Data* pData)
+    {
+        bool isLastCopy = false;
         {
-            if (m_pData->hGDIObject != 0)
+            // Hold the lock of the map containing this object, so another
+            // thread can't attach to it while it's removed from the map.
+            CThreadLock mapLock(GetApp()->GetMapLock(pData->pMaps));
+            if (InterlockedDecrement(&pData->count) == 0)
             {
-                if (m_pData->isManagedObject)
-                {
-                    ::DeleteObject(m_pData->hGDIObject);
-                }
+                CWinApp* pApp = CWinApp::SetnGetThis();
+                if (pApp != NULL)
+                    pApp->RemoveCGDIData(pData);
 
-                RemoveFromMap();
+                isLastCopy = true;
             }
+        }
 
-            delete m_pData;
-            m_pData = 0;
+        if (isLastCopy)
+        {
+            if (pData->hGDIObject != 0 && pData->isManagedObject)
+            {
+                ::DeleteObject(pData->hGDIObject);
+            }
+
+            DeleteData(pData);
         }
     }
 
@@ -1243,23 +1629,23 @@ namespace Win32xx
         CWinApp* pApp = CWinApp::SetnGetThis();
         if (pApp != NULL)          // Is the CWinApp object still valid?
         {
-            // Allocate an iterator for our HDC map
-            std::map<HGDIOBJ, CGDI_Data*, CompareGDI>::iterator m;
-
-            CThreadLock mapLock(pApp->m_gdiLock);
-            m = pApp->m_mapCGDIData.find(m_pData->hGDIObject);
-            if (m != pApp->m_mapCGDIData.end())
-            {
-                // Erase the CGDIObject pointer entry from the map
-                pApp->m_mapCGDIData.erase(m);
-                success = TRUE;
-            }
-
+            // Erase the CGDIObject data entry from the map
+            success = pApp->RemoveCGDIData(m_pData);
         }
 
         return success;
     }
 
+    // Sets whether the GDI object is deleted when the last copy of the
+    // CGDIObject is destroyed. A managed GDI object is added to the map,
+    // so a CGDIObject attached to it later shares this CGDIObject's data.
+    inline void CGDIObject::SetManaged(bool isManaged) const
+    {
+        m_pData->isManagedObject = isManaged;
+        if (isManaged && m_pData->hGDIObject != 0 && m_pData->pMaps == 0)
+            AddToMap();
+    }
+
 
     ///////////////////////////////////////////////
     // Definitions for the CBitmap class
@@ -1376,58 +1762,36 @@ namespace Win32xx
     // The mask is the transparent color. Pixels with this color are not converted.
     // Supports 32 bit, 24 bit, 16 bit and 8 bit colors.
     // For 16 and 8 bit colors, ensure the mask is a color in the current palette.
+    // The pixels of a 32 bit DIB section, such as a CDIBSection, are modified in place.
     inline void CBitmap::ConvertToDisabled(COLORREF mask) const
     {
+        // Modify the pixels of a 32 bit DIB section in place.
+        CDIBView view(reinterpret_cast<HBITMAP>(GetHandle()));
+        if (!view.IsEmpty())
+        {
+            view.ConvertToDisabled(mask);
+            return;
+        }
+
         BITMAP data = GetBitmapData();
 
         // Requires 8 bits per pixel
         if (data.bmBitsPixel < 8)
             return;
 
-        // Copy the image data into the 'bits' byte array.
+        // Copy the image data into the 'bits' byte array as 32 bit pixels.
         CWindowDC dc(HWND_DESKTOP);
         CBitmapInfoPtr pbmi(*this);
         BITMAPINFOHEADER& bmiHeader = pbmi->bmiHeader;
-        bmiHeader.biBitCount = 24;
+        bmiHeader.biBitCount = 32;
         UINT scanLines = static_cast<UINT>(data.bmHeight);
-        VERIFY(dc.GetDIBits(*this, 0, scanLines, NULL, pbmi, DIB_RGB_COLORS));
-        DWORD size = pbmi->bmiHeader.biSizeImage;
-        std::vector<byte> vBits(size, 0);
+        std::vector<byte> vBits(size_t(data.bmWidth) * 4 * scanLines, 0);
         byte* bits = &vBits.front();
         VERIFY(dc.GetDIBits(*this, 0, scanLines, bits, pbmi, DIB_RGB_COLORS));
 
-        UINT widthBytes = bmiHeader.biSizeImage / bmiHeader.biHeight;
-        int yOffset = 0;
-        int xOffset;
-        size_t index;
-
-        for (int row = 0; row < bmiHeader.biHeight; ++row)
-        {
-            xOffset = 0;
-
-            for (int column = 0; column < bmiHeader.biWidth; ++column)
-            {
-                // Calculate index
-                index = size_t(yOffset) + size_t(xOffset);
-
-                // skip for colors matching the mask
-                if ((bits[index + 0] != GetRValue(mask)) &&
-                    (bits[index + 1] != GetGValue(mask)) &&
-                    (bits[index + 2] != GetBValue(mask)))
-                {
-                    BYTE byGray = BYTE(95 + (bits[index + 2] * 3 + bits[index + 1] * 6 + bits[index + 0]) / 20);
-                    bits[index] = byGray;
-                    bits[index + 1] = byGray;
-                    bits[index + 2] = byGray;
-                }
-
-                // Increment the horizontal offset
-                xOffset += bmiHeader.biBitCount >> 3;
-            }
-
-            // Increment vertical offset
-            yOffset += widthBytes;
-        }
+        CPixelOperation operation(CPixelOperation::DISABLED, bits, data.bmWidth, data.bmHeight);
+        operation.SetMask(mask);
+        operation.Process();
 
         VERIFY(dc.SetDIBits(*this, 0, scanLines, bits, pbmi, DIB_RGB_COLORS));
     }
@@ -1564,8 +1928,17 @@ namespace Win32xx
     }
 
     // Convert a bitmap image to gray scale.
+    // The pixels of a 32 bit DIB section, such as a CDIBSection, are modified in place.
     inline void CBitmap::GrayScaleBitmap()
     {
+        // Modify the pixels of a 32 bit DIB section in place.
+        CDIBView view(reinterpret_cast<HBITMAP>(GetHandle()));
+        if (!view.IsEmpty())
+        {
+            view.GrayScale();
+            return;
+        }
+
         // Requires 8 bits per pixel
         BITMAP data = GetBitmapData();
         if (data.bmBitsPixel < 8)
@@ -1574,45 +1947,19 @@ namespace Win32xx
         // Create our LPBITMAPINFO object
         CBitmapInfoPtr pbmi(*this);
         BITMAPINFOHEADER& bmiHeader = pbmi->bmiHeader;
-        bmiHeader.biBitCount = 24;
+        bmiHeader.biBitCount = 32;
 
         // Create the reference DC for GetDIBits to use
         CMemDC memDC(0);
 
-        // Use GetDIBits to create a DIB from our DDB, and extract the color data
+        // Use GetDIBits to create a 32 bit DIB from our DDB, and extract the color data
         UINT scanLines = static_cast<UINT>(bmiHeader.biHeight);
-        VERIFY(GetDIBits(memDC, 0, scanLines, NULL, pbmi, DIB_RGB_COLORS));
-        std::vector<byte> vBits(bmiHeader.biSizeImage, 0);
+        std::vector<byte> vBits(size_t(bmiHeader.biWidth) * 4 * scanLines, 0);
         byte* pByteArray = &vBits[0];
+        VERIFY(GetDIBits(memDC, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS));
 
-        memDC.GetDIBits(*this, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS);
-        UINT widthBytes = bmiHeader.biSizeImage/bmiHeader.biHeight;
-
-        int yOffset = 0;
-        int xOffset;
-        size_t index;
-
-        for (int row=0; row < bmiHeader.biHeight; ++row)
-        {
-            xOffset = 0;
-
-            for (int column=0; column < bmiHeader.biWidth; ++column)
-            {
-                // Calculate index
-                index = size_t(yOffset) + size_t(xOffset);
-
-                BYTE byGray = (BYTE) ((pByteArray[index] + pByteArray[index +1]*6 + pByteArray[index +2] *3)/10);
-                pByteArray[index]   = byGray;
-                pByteArray[index +1] = byGray;
-                pByteArray[index +2] = byGray;
-
-                // Increment the horizontal offset
-                xOffset += bmiHeader.biBitCount >> 3;
-            }
-
-            // Increment vertical offset
-            yOffset += widthBytes;
-        }
+        CPixelOperation operation(CPixelOperation::GRAYSCALE, pByteArray, bmiHeader.biWidth, bmiHeader.biHeight);
+        operation.Process();
 
         // Save the modified color back into our source DDB
         VERIFY(SetDIBits(memDC, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS));
@@ -1621,79 +1968,37 @@ namespace Win32xx
     // Modifies the color of the Device Dependent Bitmap, by the color.
     // correction values specified. The correction values can range from -255 to +255.
     // This function gains its speed by accessing the bitmap color information
-    // directly, rather than using GetPixel/SetPixel.
+    // directly, rather than using GetPixel/SetPixel. Large bitmaps are
+    // processed in parallel. The pixels of a 32 bit DIB section, such as
+    // a CDIBSection, are modified in place.
     inline void CBitmap::TintBitmap (int cRed, int cGreen, int cBlue)
     {
+        // Modify the pixels of a 32 bit DIB section in place.
+        CDIBView view(reinterpret_cast<HBITMAP>(GetHandle()));
+        if (!view.IsEmpty())
+        {
+            view.Tint(cRed, cGreen, cBlue);
+            return;
+        }
+
         // Create our LPBITMAPINFO object
         CBitmapInfoPtr pbmi(*this);
         BITMAPINFOHEADER& bmiHeader = pbmi->bmiHeader;
-        bmiHeader.biBitCount = 24;
+        bmiHeader.biBitCount = 32;
 
         // Create the reference DC for GetDIBits to use
         CMemDC memDC(0);
 
-        // Use GetDIBits to create a DIB from our DDB, and extract the color data
+        // Use GetDIBits to create a 32 bit DIB from our DDB, and extract the color data
         UINT scanLines = static_cast<UINT>(bmiHeader.biHeight);
-        VERIFY(GetDIBits(memDC, 0, scanLines, NULL, pbmi, DIB_RGB_COLORS));
-        std::vector<byte> vBits(bmiHeader.biSizeImage, 0);
+        std::vector<byte> vBits(size_t(bmiHeader.biWidth) * 4 * scanLines, 0);
         byte* pByteArray = &vBits[0];
-
         VERIFY(GetDIBits(memDC, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS));
-        UINT widthBytes = bmiHeader.biSizeImage/bmiHeader.biHeight;
-
-        // Ensure sane color correction values
-        cBlue  = MIN(cBlue, 255);
-        cBlue  = MAX(cBlue, -255);
-        cRed   = MIN(cRed, 255);
-        cRed   = MAX(cRed, -255);
-        cGreen = MIN(cGreen, 255);
-        cGreen = MAX(cGreen, -255);
-
-        // Pre-calculate the RGB modification values
-        int b1 = 256 - cBlue;
-        int g1 = 256 - cGreen;
-        int r1 = 256 - cRed;
-
-        int b2 = 256 + cBlue;
-        int g2 = 256 + cGreen;
-        int r2 = 256 + cRed;
 
         // Modify the color
-        int yOffset = 0;
-        int xOffset;
-        size_t index;
-        for (int Row=0; Row < bmiHeader.biHeight; ++Row)
-        {
-            xOffset = 0;
-
-            for (int Column=0; Column < bmiHeader.biWidth; ++Column)
-            {
-                // Calculate index
-                index = size_t(yOffset) + size_t(xOffset);
-
-                // Adjust the color values
-                if (cBlue > 0)
-                    pByteArray[index]   = (BYTE)(cBlue + (((pByteArray[index] *b1)) >>8));
-                else if (cBlue < 0)
-                    pByteArray[index]   = (BYTE)((pByteArray[index] *b2) >>8);
-
-                if (cGreen > 0)
-                    pByteArray[index+1] = (BYTE)(cGreen + (((pByteArray[index+1] *g1)) >>8));
-                else if (cGreen < 0)
-                    pByteArray[index+1] = (BYTE)((pByteArray[index+1] *g2) >>8);
-
-                if (cRed > 0)
-                    pByteArray[index+2] = (BYTE)(cRed + (((pByteArray[index+2] *r1)) >>8));
-                else if (cRed < 0)
-                    pByteArray[index+2] = (BYTE)((pByteArray[index+2] *r2) >>8);
-
-                // Increment the horizontal offset
-                xOffset += bmiHeader.biBitCount >> 3;
-            }
-
-            // Increment vertical offset
-            yOffset += widthBytes;
-        }
+        CPixelOperation operation(CPixelOperation::TINT, pByteArray, bmiHeader.biWidth, bmiHeader.biHeight);
+        operation.SetTint(cRed, cGreen, cBlue);
+        operation.Process();
 
         // Save the modified color back into our source DDB
         VERIFY(SetDIBits(memDC, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS));
@@ -1732,6 +2037,218 @@ namespace Win32xx
     }
 
 
+    ///////////////////////////////////////////////
+    // Definitions of the CDIBView class
+    //
+
+    // Constructs an empty view.
+    inline CDIBView::CDIBView() : m_pBits(0), m_width(0), m_height(0), m_stride(0)
+    {
+    }
+
+    // Constructs a view of all the pixels of a 32 bit DIB section.
+    // The view is empty for other bitmaps.
+    inline CDIBView::CDIBView(HBITMAP bitmap) : m_pBits(0), m_width(0), m_height(0), m_stride(0)
+    {
+        DIBSECTION ds;
+        ZeroMemory(&ds, sizeof(ds));
+        if (bitmap && (::GetObject(bitmap, sizeof(ds), &ds) == sizeof(ds)) &&
+            (ds.dsBm.bmBits != 0) && (ds.dsBm.bmBitsPixel == 32))
+        {
+            // Complete any GDI drawing before the pixels are accessed.
+            ::GdiFlush();
+
+            m_pBits = static_cast<BYTE*>(ds.dsBm.bmBits);
+            m_width = ds.dsBm.bmWidth;
+            m_height = ds.dsBm.bmHeight;
+            m_stride = ds.dsBm.bmWidthBytes;
+
+            // A bottom-up DIB stores the top row last.
+            if (ds.dsBmih.biHeight > 0)
+            {
+                m_pBits += ptrdiff_t(m_height - 1) * m_stride;
+                m_stride = -m_stride;
+            }
+        }
+    }
+
+    // Constructs a view of 32 bit pixels in memory.
+    inline CDIBView::CDIBView(BYTE* pBits, int width, int height, int stride)
+        : m_pBits(pBits), m_width(width), m_height(height), m_stride(stride)
+    {
+        assert(pBits);
+    }
+
+    // Converts the pixels to the pale gray used for disabled images.
+    // Pixels with the mask color are not converted.
+    inline void CDIBView::ConvertToDisabled(COLORREF mask) const
+    {
+        if (!IsEmpty())
+        {
+            CPixelOperation operation(CPixelOperation::DISABLED, m_pBits, m_width, m_height, m_stride);
+            operation.SetMask(mask);
+            operation.Process();
+        }
+    }
+
+    // Returns a pointer to the first pixel of the specified row.
+    inline RGBQUAD* CDIBView::GetRow(int row) const
+    {
+        assert(m_pBits);
+        assert(row >= 0 && row < m_height);
+        return reinterpret_cast<RGBQUAD*>(m_pBits + ptrdiff_t(row) * m_stride);
+    }
+
+    // Returns a view of the pixels within the rectangle. The rectangle
+    // is clipped to this view.
+    inline CDIBView CDIBView::GetView(const RECT& rc) const
+    {
+        CRect view = CRect(0, 0, m_width, m_height) & rc;
+        if (IsEmpty() || view.IsRectEmpty())
+            return CDIBView();
+
+        BYTE* pBits = m_pBits + ptrdiff_t(view.top) * m_stride + ptrdiff_t(view.left) * 4;
+        return CDIBView(pBits, view.Width(), view.Height(), m_stride);
+    }
+
+    // Converts the pixels to gray scale.
+    inline void CDIBView::GrayScale() const
+    {
+        if (!IsEmpty())
+        {
+            CPixelOperation operation(CPixelOperation::GRAYSCALE, m_pBits, m_width, m_height, m_stride);
+            operation.Process();
+        }
+    }
+
+    // Modifies the color of the pixels by the color correction values.
+    // The correction values can range from -255 to +255.
+    inline void CDIBView::Tint(int red, int green, int blue) const
+    {
+        if (!IsEmpty())
+        {
+            CPixelOperation operation(CPixelOperation::TINT, m_pBits, m_width, m_height, m_stride);
+            operation.SetTint(red, green, blue);
+            operation.Process();
+        }
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CDIBSection class
+    //
+    inline CDIBSection::CDIBSection()
+    {
+    }
+
+    // Constructs a CDIBSection for an existing DIB section.
+    inline CDIBSection::CDIBSection(HBITMAP bitmap)
+    {
+        Attach(bitmap);
+    }
+
+    // Constructs a DIB section with the specified size.
+    inline CDIBSection::CDIBSection(int width, int height)
+    {
+        try
+        {
+            Create(width, height);
+        }
+
+        catch(...)
+        {
+            Release();  // Cleanup
+            throw;      // Rethrow
+        }
+    }
+
+    inline CDIBSection::~CDIBSection()
+    {
+    }
+
+    // Creates a 32 bit top-down DIB section with the specified size.
+    // The pixels are initialized to 0.
+    inline HBITMAP CDIBSection::Create(int width, int height)
+    {
+        assert(width > 0 && height > 0);
+
+        BITMAPINFO bmi;
+        ZeroMemory(&bmi, sizeof(bmi));
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = width;
+        bmi.bmiHeader.biHeight = -height;   // top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        LPVOID pBits = 0;
+        HBITMAP bitmap = CreateDIBSection(0, &bmi, DIB_RGB_COLORS, &pBits, 0, 0);
+        if (bitmap == 0)
+            throw CResourceException(GetApp()->MsgGdiBitmap());
+
+        return bitmap;
+    }
+
+    // Creates a 32 bit top-down DIB section with a copy of the specified
+    // bitmap's image. The bitmap must not be selected into a device context.
+    inline HBITMAP CDIBSection::CreateCopy(HBITMAP bitmap)
+    {
+        assert(bitmap);
+        BITMAP data;
+        VERIFY(::GetObject(bitmap, sizeof(data), &data));
+        HBITMAP dib = Create(data.bmWidth, data.bmHeight);
+
+        // Copy the image directly into the DIB section's pixels.
+        DIBSECTION ds = GetDIBSectionData();
+        BITMAPINFO bmi;
+        ZeroMemory(&bmi, sizeof(bmi));
+        bmi.bmiHeader = ds.dsBmih;
+        CMemDC memDC(0);
+        UINT scanLines = static_cast<UINT>(data.bmHeight);
+        VERIFY(::GetDIBits(memDC, bitmap, 0, scanLines, ds.dsBm.bmBits, &bmi, DIB_RGB_COLORS));
+
+        return dib;
+    }
+
+    // Returns a pointer to the first byte of the pixels, after completing
+    // any pending GDI drawing. The rows of a CDIBSection are stored from
+    // the top down.
+    inline BYTE* CDIBSection::GetBits() const
+    {
+        ::GdiFlush();
+        return static_cast<BYTE*>(GetDIBSectionData().dsBm.bmBits);
+    }
+
+    // Retrieves the DIBSECTION structure describing the DIB section.
+    // Refer to GetObject in the Windows API documentation for more information.
+    inline DIBSECTION CDIBSection::GetDIBSectionData() const
+    {
+        assert(GetHandle() != 0);
+        DIBSECTION ds;
+        ZeroMemory(&ds, sizeof(ds));
+        VERIFY(::GetObject(GetHandle(), sizeof(ds), &ds));
+        return ds;
+    }
+
+    // Returns the number of bytes in each row of pixels.
+    inline int CDIBSection::GetStride() const
+    {
+        return GetDIBSectionData().dsBm.bmWidthBytes;
+    }
+
+    // Returns a view of all the pixels.
+    inline CDIBView CDIBSection::GetView() const
+    {
+        return CDIBView(reinterpret_cast<HBITMAP>(GetHandle()));
+    }
+
+    // Returns a view of the pixels within the rectangle.
+    inline CDIBView CDIBSection::GetView(const RECT& rc) const
+    {
+        return GetView().GetView(rc);
+    }
+
+
     ///////////////////////////////////////////////
     // Definitions of the CBrush class
     //
@@ -2427,12 +2944,41 @@ namespace Win32xx
         return ::PtInRegion(reinterpret_cast<HRGN>(GetHandle()), pt.x, pt.y);
     }
 
-    // Determines whether the specified rect is inside the specified region.
-    // Refer to RectInRegion in the Windows API documentation for more information.
-    inline BOOL CRgn::RectInRegion(const RECT& rc) const
+    // Determines whether the specified rect is inside the specified region.
+    // Refer to RectInRegion in the Windows API documentation for more information.
+    inline BOOL CRgn::RectInRegion(const RECT& rc) const
+    {
+        assert(GetHandle() != 0);
+        return ::RectInRegion(reinterpret_cast<HRGN>(GetHandle()), &rc);
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CSelectedObject class
+    //
+
+    // Holds a reference to the data of the specified GDI object.
+    inline CSelectedObject& CSelectedObject::operator = (const CGDIObject& object)
+    {
+        CGDI_Data* pData = object.m_pData;
+        if (pData != m_pData)
+        {
+            InterlockedIncrement(&pData->count);
+            Release();
+            m_pData = pData;
+        }
+
+        return *this;
+    }
+
+    // Releases the reference to the GDI object's data, if any.
+    inline void CSelectedObject::Release()
     {
-        assert(GetHandle() != 0);
-        return ::RectInRegion(reinterpret_cast<HRGN>(GetHandle()), &rc);
+        if (m_pData != 0)
+        {
+            CGDIObject::ReleaseData(m_pData);
+            m_pData = 0;
+        }
     }
 
 
@@ -2443,7 +2989,7 @@ namespace Win32xx
     inline CDC::CDC()
     {
         // Allocate memory for our data members
-        m_pData = new CDC_Data;
+        m_pData = NewData();
     }
 
     // This constructor assigns a pre-existing HDC to the CDC.
@@ -2452,8 +2998,30 @@ namespace Win32xx
     // CDC MyCDC = SomeHDC;
     inline CDC::CDC(HDC dc)
     {
-        m_pData = new CDC_Data;
-        Attach(dc);
+        // Share the data of a CDC already attached to this HDC.
+        // GetCDCData increments the reference count.
+        m_pData = (dc != 0) ? GetApp()->GetCDCData(dc) : 0;
+        if (m_pData == 0)
+        {
+            m_pData = NewData();
+            if (dc != 0)
+            {
+                m_pData->dc = dc;
+                m_pData->savedDCState = SaveDC();
+                AddToMap();
+            }
+        }
+    }
+
+    // Constructs a CDC that uses the data of a CDCView. The data isn't
+    // allocated from the heap, and the HDC isn't added to the map.
+    inline CDC::CDC(HDC dc, CDC_Data* pViewData)
+    {
+        m_pData = pViewData;
+        m_pData->isViewData = true;
+        m_pData->dc = dc;
+        if (dc != 0)
+            m_pData->savedDCState = SaveDC();
     }
 
     // Note: this assignment operator permits a call like this:
@@ -2467,10 +3035,20 @@ namespace Win32xx
     // The copy constructor is called when a temporary copy of the CDC needs to be created.
     // This can happen when a CDC is passed by value in a function call. Each CDC copy manages
     // the same Device Context and GDI objects.
+    // Note: The data of a CDCView belongs to the CDCView, so a copy of a CDCView
+    //       attaches its HDC to new data instead of sharing it.
     inline CDC::CDC(const CDC& rhs) // Copy constructor
     {
-        m_pData = rhs.m_pData;
-        InterlockedIncrement(&m_pData->count);
+        if (rhs.m_pData->isViewData)
+        {
+            m_pData = NewData();
+            Attach(rhs.m_pData->dc);
+        }
+        else
+        {
+            m_pData = rhs.m_pData;
+            InterlockedIncrement(&m_pData->count);
+        }
     }
 
     // Note: A copy of a CDC is a clone of the original.
@@ -2479,9 +3057,20 @@ namespace Win32xx
     {
         if (this != &rhs)
         {
-            InterlockedIncrement(&rhs.m_pData->count);
-            Release();
-            m_pData = rhs.m_pData;
+            if (rhs.m_pData->isViewData)
+            {
+                // The data of a CDCView isn't shared.
+                HDC dc = rhs.m_pData->dc;
+                Release();
+                m_pData = NewData();
+                Attach(dc);
+            }
+            else
+            {
+                InterlockedIncrement(&rhs.m_pData->count);
+                Release();
+                m_pData = rhs.m_pData;
+            }
         }
 
         return *this;
@@ -2492,50 +3081,79 @@ namespace Win32xx
         Release();
     }
 
-    // Store the HDC and CDC pointer in the HDC map
+    // Store the HDC and CDC_Data pointer in the thread's map. If another
+    // thread attached a CDC to the HDC after it was looked up, this CDC
+    // shares that CDC's data instead.
     inline void CDC::AddToMap()
     {
         assert(m_pData->dc != 0);
 
-        GetApp()->AddCDCData(m_pData->dc, m_pData);
+        CDC_Data* pMappedData = GetApp()->AddCDCData(m_pData->dc, m_pData);
+        if (pMappedData != m_pData)
+        {
+            // A HDC owned by this CDC can't be mapped to another CDC.
+            assert(!m_pData->isManagedHDC);
+            ::RestoreDC(m_pData->dc, m_pData->savedDCState);
+            m_pData->dc = 0;
+            Release();
+            m_pData = pMappedData;
+        }
     }
 
     // Attaches a HDC to the CDC object.
     inline void CDC::Attach(HDC dc)
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_gdiLock);
 
         if (m_pData && dc != m_pData->dc)
         {
-            if (m_pData->dc)
+            // Share the data of a CDC already attached to this HDC, so the
+            // HDC's state is saved and restored once, and a managed HDC isn't
+            // released or deleted while it's used here. The map is searched
+            // before any data is allocated. GetCDCData increments the
+            // reference count.
+            CDC_Data* pCDCData = (dc != 0) ? GetApp()->GetCDCData(dc) : 0;
+            if (pCDCData)
             {
                 Release();
-
-                // Assign values to our data members
-                m_pData = new CDC_Data;
+                m_pData = pCDCData;
             }
-
-            if (dc)
+            else
             {
-                CDC_Data* pCDCData = GetApp()->GetCDCData(dc);
-                if (pCDCData)
+                if (m_pData->dc)
                 {
-                    delete m_pData;
-                    m_pData = pCDCData;
-                    InterlockedIncrement(&m_pData->count);
+                    Release();
+
+                    // Assign values to our data members
+                    m_pData = NewData();
                 }
-                else
+
+                if (dc)
                 {
                     m_pData->dc = dc;
-
-                    AddToMap();
                     m_pData->savedDCState = SaveDC();
+                    AddToMap();
                 }
             }
         }
     }
 
+    // Destroys the data, and returns its memory to the calling thread's free
+    // list. Destroying the data releases the GDI objects it holds. Threads
+    // without TLS data return the memory to the heap.
+    inline void CDC::DeleteData(CDC_Data* pData)
+    {
+        pData->~CDC_Data();
+        CResourceCounter::Remove(RESOURCE_DC_DATA);
+
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        TLSData* pTLSData = pApp ? pApp->GetTlsData() : 0;
+        if (pTLSData != 0)
+            pTLSData->dcDataPool.Free(pData);
+        else
+            ::operator delete(pData);
+    }
+
     // Detaches the HDC from this CDC object and all its copies.
     // The CDC object and its copies are returned to the default state.
     // The detached HDC is left untouched.
@@ -2545,6 +3163,7 @@ namespace Win32xx
     //       Use Detach to keep changes made to the device context, such as
     //       when handling WM_CTLCOLORBTN, WM_CTLCOLOREDIT, WM_CTLCOLORDLG,
     //       WM_CTLCOLORLISTBOX, WM_CTLCOLORSCROLLBAR or WM_CTLCOLORSTATIC.
+    //       The resource telemetry counts a detached HDC as destroyed.
     inline HDC CDC::Detach()
     {
         assert(m_pData);
@@ -2556,14 +3175,15 @@ namespace Win32xx
 
         if (m_pData->count > 0)
         {
-            if (InterlockedDecrement(&m_pData->count) == 0)
+            // The data of a CDCView is destroyed with the CDCView.
+            if (InterlockedDecrement(&m_pData->count) == 0 && !m_pData->isViewData)
             {
-                delete m_pData;
+                DeleteData(m_pData);
             }
         }
 
         // Assign values to our data members
-        m_pData = new CDC_Data;
+        m_pData = NewData();
 
         return dc;
     }
@@ -2689,22 +3309,51 @@ namespace Win32xx
         SetBkColor(oldBkColor);
     }
 
+    // Constructs the data for a CDC. The memory of released data is reused
+    // if the calling thread's free list has any.
+    inline CDC_Data* CDC::NewData()
+    {
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        TLSData* pTLSData = pApp ? pApp->GetTlsData() : 0;
+        void* pBlock = (pTLSData != 0) ?
+            pTLSData->dcDataPool.Allocate(sizeof(CDC_Data), pTLSData->gdiStats) :
+            ::operator new(sizeof(CDC_Data));
+
+        CResourceCounter::Add(RESOURCE_DC_DATA);
+        return new (pBlock) CDC_Data;
+    }
+
     // Decrements the reference count.
     // Destroys m_pData if the reference count is zero.
     inline void CDC::Release()
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_gdiLock);
 
-        if (m_pData->count > 0)
+        bool isLastCopy = false;
         {
-            if (InterlockedDecrement(&m_pData->count) == 0)
+            // Hold the lock of the map containing this HDC, so another
+            // thread can't attach to it while it's removed from the map.
+            CThreadLock mapLock(GetApp()->GetMapLock(m_pData->pMaps));
+            if (m_pData->count > 0)
             {
-                Destroy();
-                delete m_pData;
-                m_pData = 0;
+                if (InterlockedDecrement(&m_pData->count) == 0)
+                {
+                    RemoveFromMap();
+                    isLastCopy = true;
+                }
             }
         }
+
+        if (isLastCopy)
+        {
+            Destroy();
+
+            // The data of a CDCView is destroyed with the CDCView.
+            if (!m_pData->isViewData)
+                DeleteData(m_pData);
+
+            m_pData = 0;
+        }
     }
 
     inline BOOL CDC::RemoveFromMap()
@@ -2714,18 +3363,8 @@ namespace Win32xx
         CWinApp* pApp = CWinApp::SetnGetThis();
         if (pApp != NULL)          // Is the CWinApp object still valid?
         {
-            // Allocate an iterator for our Data map
-            std::map<HDC, CDC_Data*, CompareHDC>::iterator m;
-
-            CThreadLock mapLock(pApp->m_gdiLock);
-            m = pApp->m_mapCDCData.find(m_pData->dc);
-            if (m != pApp->m_mapCDCData.end())
-            {
-                // Erase the CDC data entry from the map
-                pApp->m_mapCDCData.erase(m);
-                success = TRUE;
-            }
-
+            // Erase the CDC data entry from the map
+            success = pApp->RemoveCDCData(m_pData);
         }
 
         return success;
@@ -2813,6 +3452,25 @@ namespace Win32xx
         return static_cast<int> (reinterpret_cast<INT_PTR>(rgnType));
     }
 
+    // Sets whether the HDC is released or deleted when the last copy of the
+    // CDC is destroyed. The HDC is added to the map if it isn't already, so
+    // a CDC attached to it later shares this CDC's data. The resource
+    // telemetry only counts managed device contexts.
+    inline void CDC::SetManaged(bool isManaged)
+    {
+        if (m_pData->pMaps != 0 && m_pData->isManagedHDC != isManaged)
+        {
+            if (isManaged)
+                CResourceCounter::Add(RESOURCE_DC);
+            else
+                CResourceCounter::Remove(RESOURCE_DC);
+        }
+
+        m_pData->isManagedHDC = isManaged;
+        if (m_pData->dc != 0 && m_pData->pMaps == 0)
+            AddToMap();
+    }
+
     // Select a palette into the device context.
     // Refer to SelectPalette in the Windows API documentation for more information.
     inline HPALETTE CDC::SelectPalette(const HPALETTE palette, BOOL forceBkgnd) const
@@ -3085,14 +3743,15 @@ namespace Win32xx
         m_pData->brush = brush;
     }
 
-    // Creates the brush with the specified color, and selects it into the device context.
+    // Selects a brush with the specified color into the device context.
+    // The brush is retrieved from the thread's CGDICache.
     // Refer to CreateSolidBrush in the Windows API documentation for more information.
     inline void CDC::CreateSolidBrush(COLORREF color)
     {
         assert(m_pData->dc != 0);
 
-        CBrush brush;
-        brush.CreateSolidBrush(color);
+        CGDICache* pCache = GetApp()->GetGDICache();
+        CBrush brush = pCache ? pCache->GetBrush(color) : CBrush(color);
         SelectObject(brush);
         m_pData->brush = brush;
     }
@@ -3192,14 +3851,15 @@ namespace Win32xx
     /////////////////
     // Font functions
 
-    // Creates a logical font and selects it into the device context.
+    // Selects a logical font with the specified attributes into the device context.
+    // The font is retrieved from the thread's CGDICache.
     // Refer to CreateFontIndirect in the Windows API documentation for more information.
     inline void CDC::CreateFontIndirect(const LOGFONT& lf)
     {
         assert(m_pData->dc != 0);
 
-        CFont font;
-        font.CreateFontIndirect(lf);
+        CGDICache* pCache = GetApp()->GetGDICache();
+        CFont font = pCache ? pCache->GetFont(lf) : CFont(lf);
         SelectObject(font);
         m_pData->font = font;
     }
@@ -3366,14 +4026,15 @@ namespace Win32xx
     ////////////////
     // Pen functions
 
-    // Creates the pen and selects it into the device context.
+    // Selects a pen with the specified style, width and color into the device context.
+    // The pen is retrieved from the thread's CGDICache.
     // Refer to CreatePen in the Windows API documentation for more information.
     inline void CDC::CreatePen (int style, int width, COLORREF color)
     {
         assert(m_pData->dc != 0);
 
-        CPen pen;
-        pen.CreatePen(style, width, color);
+        CGDICache* pCache = GetApp()->GetGDICache();
+        CPen pen = pCache ? pCache->GetPen(style, width, color) : CPen(style, width, color);
         SelectObject(pen);
         m_pData->pen = pen;
     }
@@ -5000,6 +5661,426 @@ namespace Win32xx
 
   #endif // (_WIN32_WINNT >= 0x0500) && !defined(__GNUC__)
 
+
+    ///////////////////////////////////////////////
+    // Definitions of the GDICacheKey struct
+    //
+
+    // Orders the keys by type, then pen and brush attributes, then font attributes.
+    inline bool GDICacheKey::operator < (const GDICacheKey& rhs) const
+    {
+        if (type != rhs.type)   return (type < rhs.type);
+        if (style != rhs.style) return (style < rhs.style);
+        if (width != rhs.width) return (width < rhs.width);
+        if (color != rhs.color) return (color < rhs.color);
+
+        // Compare the LOGFONT members before the face name as bytes. The face
+        // name is compared as a string, ignoring any characters after the null.
+        int result = memcmp(&logFont, &rhs.logFont, offsetof(LOGFONT, lfFaceName));
+        if (result != 0) return (result < 0);
+        return (_tcsncmp(logFont.lfFaceName, rhs.logFont.lfFaceName, LF_FACESIZE) < 0);
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CGDICache class
+    //
+
+    // Adds the object to the cache. The least recently used object is
+    // removed first if the cache is full.
+    inline void CGDICache::Add(const GDICacheKey& key, const CGDIObject& object)
+    {
+        if (m_limit == 0)
+            return;
+
+        if (m_objects.size() >= m_limit)
+            Trim(m_limit - 1);
+
+        m_objects.insert(std::make_pair(key, GDICacheEntry(object, ++m_useCount)));
+    }
+
+    // Returns the handle of the cached object with the specified key,
+    // or 0 if the cache doesn't have it.
+    inline HGDIOBJ CGDICache::Find(const GDICacheKey& key)
+    {
+        std::map<GDICacheKey, GDICacheEntry>::iterator it = m_objects.find(key);
+        if (it == m_objects.end())
+        {
+            ++m_stats.misses;
+            return 0;
+        }
+
+        ++m_stats.hits;
+        (*it).second.lastUse = ++m_useCount;
+        return (*it).second.object.GetHandle();
+    }
+
+    // Returns a solid brush of the specified color.
+    inline CBrush CGDICache::GetBrush(COLORREF color)
+    {
+        GDICacheKey key;
+        key.type = OBJ_BRUSH;
+        key.color = color;
+
+        HGDIOBJ object = Find(key);
+        if (object != 0)
+            return CBrush(reinterpret_cast<HBRUSH>(object));
+
+        CBrush brush(color);
+        Add(key, brush);
+        return brush;
+    }
+
+    // Returns a font with the specified attributes.
+    inline CFont CGDICache::GetFont(const LOGFONT& logFont)
+    {
+        GDICacheKey key;
+        key.type = OBJ_FONT;
+        key.logFont = logFont;
+
+        HGDIOBJ object = Find(key);
+        if (object != 0)
+            return CFont(reinterpret_cast<HFONT>(object));
+
+        CFont font(logFont);
+        Add(key, font);
+        return font;
+    }
+
+    // Returns a pen with the specified style, width and color.
+    inline CPen CGDICache::GetPen(int style, int width, COLORREF color)
+    {
+        GDICacheKey key;
+        key.type = OBJ_PEN;
+        key.style = style;
+        key.width = width;
+        key.color = color;
+
+        HGDIOBJ object = Find(key);
+        if (object != 0)
+            return CPen(reinterpret_cast<HPEN>(object));
+
+        CPen pen(style, width, color);
+        Add(key, pen);
+        return pen;
+    }
+
+    // Sets the maximum number of objects held by the cache. A limit
+    // of 0 disables the cache.
+    inline void CGDICache::SetLimit(size_t limit)
+    {
+        m_limit = limit;
+        Trim(limit);
+    }
+
+    // Removes the least recently used objects until no more than maxObjects
+    // remain. Call Trim with the default argument to empty the cache, such
+    // as when the system colors or fonts change.
+    inline void CGDICache::Trim(size_t maxObjects /*= 0*/)
+    {
+        while (m_objects.size() > maxObjects)
+        {
+            std::map<GDICacheKey, GDICacheEntry>::iterator oldest = m_objects.begin();
+            if (maxObjects > 0)
+            {
+                std::map<GDICacheKey, GDICacheEntry>::iterator it;
+                for (it = m_objects.begin(); it != m_objects.end(); ++it)
+                {
+                    if ((*it).second.lastUse < (*oldest).second.lastUse)
+                        oldest = it;
+                }
+            }
+
+            m_objects.erase(oldest);
+            ++m_stats.evictions;
+        }
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CPaintBuffer class
+    //
+
+    inline CPaintBuffer::~CPaintBuffer()
+    {
+        if (m_timer != 0)
+            ::KillTimer(0, m_timer);
+    }
+
+    // Returns a bitmap compatible with the specified device context that's
+    // at least the specified size. The bitmap must be returned with
+    // ReleaseBitmap once the painting is done.
+    inline CBitmap CPaintBuffer::GetBitmap(HDC dc, int width, int height)
+    {
+        assert(width > 0 && height > 0);
+
+        if (m_isInUse)
+        {
+            // The buffer is already being used, so return a bitmap of its own.
+            CBitmap bitmap;
+            bitmap.CreateCompatibleBitmap(dc, width, height);
+            return bitmap;
+        }
+
+        // Start again with a bitmap of the size required if the color depth
+        // has changed, or the bitmap hasn't been used for a while.
+        int bitsPixel = ::GetDeviceCaps(dc, BITSPIXEL) * ::GetDeviceCaps(dc, PLANES);
+        if (bitsPixel != m_bitsPixel ||
+            ::GetTickCount() - m_releaseTime >= WXX_PAINT_BUFFER_TIMEOUT)
+            Trim();
+
+        if (m_bitmap.GetHandle() == 0 || width > m_size.cx || height > m_size.cy)
+        {
+            m_size.cx = MAX(m_size.cx, width);
+            m_size.cy = MAX(m_size.cy, height);
+            m_bitmap.CreateCompatibleBitmap(dc, m_size.cx, m_size.cy);
+            m_bitsPixel = bitsPixel;
+        }
+
+        m_isInUse = TRUE;
+        return m_bitmap;
+    }
+
+    // Called by the thread timer. Deletes the bitmap if it hasn't been used
+    // for WXX_PAINT_BUFFER_TIMEOUT milliseconds.
+    inline void CALLBACK CPaintBuffer::IdleTimerProc(HWND, UINT, UINT_PTR eventID, DWORD)
+    {
+        CWinApp* pApp = GetApp();
+        TLSData* pTLSData = pApp ? pApp->GetTlsData() : 0;
+        CPaintBuffer* pBuffer = pTLSData ? pTLSData->pPaintBuffer : 0;
+        if (pBuffer == 0 || pBuffer->m_timer != eventID)
+            ::KillTimer(0, eventID);
+        else if (!pBuffer->m_isInUse &&
+                 ::GetTickCount() - pBuffer->m_releaseTime >= WXX_PAINT_BUFFER_TIMEOUT)
+            pBuffer->Trim();
+    }
+
+    // Returns a bitmap retrieved with GetBitmap. A thread timer is started
+    // to delete the bitmap once it's no longer used.
+    inline void CPaintBuffer::ReleaseBitmap(HBITMAP bitmap)
+    {
+        if (bitmap == m_bitmap.GetHandle())
+        {
+            m_isInUse = FALSE;
+            m_releaseTime = ::GetTickCount();
+            if (m_timer == 0)
+                m_timer = ::SetTimer(0, 0, WXX_PAINT_BUFFER_TIMEOUT, IdleTimerProc);
+        }
+    }
+
+    // Deletes the buffer's bitmap. Called when the display settings change,
+    // and when the bitmap hasn't been used for a while. The bitmap isn't
+    // deleted while it's in use.
+    inline void CPaintBuffer::Trim()
+    {
+        if (!m_isInUse)
+        {
+            m_bitmap = CBitmap();
+            m_size = CSize(0, 0);
+            m_bitsPixel = 0;
+
+            if (m_timer != 0)
+            {
+                ::KillTimer(0, m_timer);
+                m_timer = 0;
+            }
+        }
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CBufferedDC class
+    //
+
+    // Selects the thread's paint buffer into the memory DC, and clips the
+    // drawing to the specified rectangle of the device context.
+    inline CBufferedDC::CBufferedDC(HDC dc, const RECT& rc)
+        : CMemDC(dc), m_targetDC(dc), m_rect(rc), m_isFlushed(FALSE)
+    {
+        int width = MAX(1, m_rect.Width());
+        int height = MAX(1, m_rect.Height());
+        CPaintBuffer* pBuffer = GetApp()->GetPaintBuffer();
+        if (pBuffer != 0)
+            m_buffer = pBuffer->GetBitmap(dc, width, height);
+        else
+            m_buffer.CreateCompatibleBitmap(dc, width, height);
+
+        try
+        {
+            SelectObject(m_buffer);
+        }
+
+        catch(...)
+        {
+            if (pBuffer != 0)
+                pBuffer->ReleaseBitmap(m_buffer);
+
+            throw;      // Rethrow
+        }
+
+        // Drawing at the rectangle's top left corner draws to the buffer's
+        // top left corner.
+        SetViewportOrgEx(-m_rect.left, -m_rect.top);
+        IntersectClipRect(m_rect);
+    }
+
+    // Copies the drawing to the device context, and returns the paint
+    // buffer.
+    inline CBufferedDC::~CBufferedDC()
+    {
+        Flush();
+        CPaintBuffer* pBuffer = GetApp()->GetPaintBuffer();
+        if (pBuffer != 0)
+            pBuffer->ReleaseBitmap(m_buffer);
+    }
+
+    // Copies the drawing to the device context. The drawing is only copied
+    // once, even if Flush is called again.
+    inline void CBufferedDC::Flush()
+    {
+        if (!m_isFlushed && !m_rect.IsRectEmpty())
+        {
+            // The viewport origin might have been changed while drawing.
+            SetViewportOrgEx(0, 0);
+            ::BitBlt(m_targetDC, m_rect.left, m_rect.top, m_rect.Width(), m_rect.Height(),
+                     GetHDC(), 0, 0, SRCCOPY);
+        }
+
+        m_isFlushed = TRUE;
+    }
+
+
+    ///////////////////////////////////////////////
+    // Definitions of the CUpdateRegion class
+    //
+
+    // Converts the rectangles from device to logical co-ordinates, using
+    // the mapping mode, viewport and window of the specified DC.
+    inline void CUpdateRegion::DPtoLP(HDC dc)
+    {
+        for (int i = 0; i < m_count; ++i)
+        {
+            VERIFY(::DPtoLP(dc, reinterpret_cast<LPPOINT>(&m_rects[i]), 2));
+            m_rects[i].NormalizeRect();
+        }
+
+        UpdateBounds();
+    }
+
+    // Returns the rectangle at the specified index.
+    inline const CRect& CUpdateRegion::GetRect(int index) const
+    {
+        assert(index >= 0 && index < m_count);
+        return m_rects[index];
+    }
+
+    // Enlarges each rectangle. Use this to allow for the width of pens,
+    // or drawing that extends beyond the bounds being tested.
+    inline void CUpdateRegion::InflateRect(int dx, int dy)
+    {
+        for (int i = 0; i < m_count; ++i)
+            m_rects[i].InflateRect(dx, dy);
+
+        UpdateBounds();
+    }
+
+    // Returns TRUE if the specified rectangle intersects the region. The
+    // bounding rectangle is tested first, so most tests are quick.
+    inline BOOL CUpdateRegion::Intersects(const RECT& rc) const
+    {
+        if (rc.left >= m_bounds.right || rc.right <= m_bounds.left ||
+            rc.top >= m_bounds.bottom || rc.bottom <= m_bounds.top)
+            return FALSE;
+
+        for (int i = 0; i < m_count; ++i)
+        {
+            const CRect& r = m_rects[i];
+            if (rc.left < r.right && r.left < rc.right && rc.top < r.bottom && r.top < rc.bottom)
+                return TRUE;
+        }
+
+        return FALSE;
+    }
+
+    // Sets the region to the specified rectangle.
+    inline void CUpdateRegion::SetRect(const RECT& rc)
+    {
+        m_count = 0;
+        if (!::IsRectEmpty(&rc))
+            m_rects[m_count++] = rc;
+
+        UpdateBounds();
+    }
+
+    // Sets the region to the rectangles of the specified region. A region
+    // with too many rectangles is replaced by its bounding rectangle.
+    inline void CUpdateRegion::SetRegion(HRGN rgn)
+    {
+        assert(rgn);
+
+        // Retrieve the rectangles into a buffer on the stack.
+        struct RegionBuffer
+        {
+            RGNDATAHEADER header;
+            RECT rects[WXX_MAX_UPDATE_RECTS];
+        } buffer;
+
+        DWORD size = ::GetRegionData(rgn, 0, NULL);
+        if (size > 0 && size <= sizeof(buffer) &&
+            ::GetRegionData(rgn, sizeof(buffer), reinterpret_cast<LPRGNDATA>(&buffer)) != 0)
+        {
+            m_count = static_cast<int>(MIN(buffer.header.nCount, DWORD(WXX_MAX_UPDATE_RECTS)));
+            for (int i = 0; i < m_count; ++i)
+                m_rects[i] = buffer.rects[i];
+
+            UpdateBounds();
+        }
+        else
+        {
+            CRect rcBox;
+            ::GetRgnBox(rgn, &rcBox);
+            SetRect(rcBox);
+        }
+    }
+
+    // Sets the region to the window's update region. Call this before
+    // BeginPaint, as BeginPaint validates the update region.
+    inline void CUpdateRegion::SetUpdateRgn(HWND wnd)
+    {
+        assert(::IsWindow(wnd));
+
+        HRGN rgn = ::CreateRectRgn(0, 0, 0, 0);
+        int type = rgn ? ::GetUpdateRgn(wnd, rgn, FALSE) : ERROR;
+        if (type == COMPLEXREGION)
+            SetRegion(rgn);
+        else if (type == SIMPLEREGION)
+        {
+            CRect rc;
+            ::GetRgnBox(rgn, &rc);
+            SetRect(rc);
+        }
+        else if (type == NULLREGION)
+            SetRect(CRect());
+        else
+        {
+            // Repaint the whole client area if the region isn't available.
+            CRect rc;
+            ::GetClientRect(wnd, &rc);
+            SetRect(rc);
+        }
+
+        if (rgn)
+            ::DeleteObject(rgn);
+    }
+
+    // Calculates the bounding rectangle of the region's rectangles.
+    inline void CUpdateRegion::UpdateBounds()
+    {
+        m_bounds.SetRectEmpty();
+        for (int i = 0; i < m_count; ++i)
+            m_bounds.UnionRect(m_bounds, m_rects[i]);
+    }
+
 } // namespace Win32xx
 
 #endif // _WIN32XX_GDI_H_
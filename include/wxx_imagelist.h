@@ -126,7 +126,7 @@ namespace Win32xx
         operator HIMAGELIST () const;
 
     private:
-        void AddToMap() const;
+        void AddToMap();
         void Release();
         BOOL RemoveFromMap() const;
 
@@ -180,12 +180,19 @@ namespace Win32xx
         Release();
     }
 
-    // Store the HIMAGELIST and CImageList pointer in the HIMAGELIST map
-    inline void CImageList::AddToMap() const
+    // Store the HIMAGELIST and CImageList pointer in the HIMAGELIST map. If
+    // another thread attached a CImageList to the image list after it was
+    // looked up, this CImageList shares that CImageList's data instead.
+    inline void CImageList::AddToMap()
     {
         assert(m_pData->images);
 
-        GetApp()->AddCImlData(m_pData->images, m_pData);
+        CIml_Data* pMappedData = GetApp()->AddCImlData(m_pData->images, m_pData);
+        if (pMappedData != m_pData)
+        {
+            delete m_pData;
+            m_pData = pMappedData;
+        }
     }
 
     inline BOOL CImageList::RemoveFromMap() const
@@ -195,18 +202,8 @@ namespace Win32xx
         CWinApp* pApp = CWinApp::SetnGetThis();
         if (pApp != NULL)          // Is the CWinApp object still valid?
         {
-            // Allocate an iterator for our CImageList data
-            std::map<HIMAGELIST, CIml_Data*, CompareHIMAGELIST>::iterator m;
-
-            CThreadLock mapLock(pApp->m_wndLock);
-            m = pApp->m_mapCImlData.find(m_pData->images);
-            if (m != pApp->m_mapCImlData.end())
-            {
-                // Erase the CImageList data entry from the map
-                pApp->m_mapCImlData.erase(m);
-                success = TRUE;
-            }
-
+            // Erase the CImageList data entry from the map
+            success = pApp->RemoveCImlData(m_pData);
         }
 
         return success;
@@ -257,7 +254,6 @@ namespace Win32xx
     inline void CImageList::Attach(HIMAGELIST images)
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_wndLock);
 
         if (images != m_pData->images)
         {
@@ -270,13 +266,13 @@ namespace Win32xx
 
             if (images)
             {
-                // Add the image list to this CImageList
+                // Add the image list to this CImageList.
+                // GetCImlData increments the reference count.
                 CIml_Data* pCImlData = GetApp()->GetCImlData(images);
                 if (pCImlData)
                 {
                     delete m_pData;
                     m_pData = pCImlData;
-                    InterlockedIncrement(&m_pData->count);
                 }
                 else
                 {
@@ -644,18 +640,24 @@ namespace Win32xx
     inline void CImageList::Release()
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_wndLock);
 
-        if (InterlockedDecrement(&m_pData->count) == 0)
+        bool isLastCopy = false;
         {
-            if (m_pData->images != 0)
+            // Hold the lock of the map containing this image list, so another
+            // thread can't attach to it while it's removed from the map.
+            CThreadLock mapLock(GetApp()->GetMapLock(m_pData->pMaps));
+            if (InterlockedDecrement(&m_pData->count) == 0)
             {
-                if (m_pData->isManagedHiml)
-                {
-                    ImageList_Destroy(m_pData->images);
-                }
-
                 RemoveFromMap();
+                isLastCopy = true;
+            }
+        }
+
+        if (isLastCopy)
+        {
+            if (m_pData->images != 0 && m_pData->isManagedHiml)
+            {
+                ImageList_Destroy(m_pData->images);
             }
 
             delete m_pData;
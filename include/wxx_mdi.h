@@ -245,6 +245,9 @@ namespace Win32xx
     {
         // Assign the MDI client window.
         SetMDIClient(m_mdiClient);
+
+        // Use PreTranslateMessage for MDI accelerators.
+        T::EnablePreTranslate();
     }
 
     // Create the MDI frame.
@@ -366,7 +369,7 @@ namespace Win32xx
                 // Draw over MDI Max button
                 if (IsMDIChildMaxed() && (item == 0))
                 {
-                    CDC drawDC(lpNMCustomDraw->nmcd.hdc);
+                    CDCView drawDC(lpNMCustomDraw->nmcd.hdc);
                     CWnd* pActiveChild = GetActiveMDIChild();
                     assert(pActiveChild);
                     if (pActiveChild)
@@ -393,7 +396,7 @@ namespace Win32xx
                 if (IsMDIChildMaxed())
                 {
                     // Draw the MDI Minimize, Restore and Close buttons.
-                    CDC dc(lpNMCustomDraw->nmcd.hdc);
+                    CDCView dc(lpNMCustomDraw->nmcd.hdc);
                     pMenubar->DrawAllMDIButtons(dc);
                 }
             }
@@ -159,7 +159,7 @@ namespace Win32xx
         operator HMENU () const;
 
     private:
-        void AddToMap() const;
+        void AddToMap();
         void Release();
         BOOL RemoveFromMap() const;
         CMenu_Data* m_pData;
@@ -241,13 +241,20 @@ namespace Win32xx
         Release();
     }
 
-    // Store the HMENU and CMenu pointer in the HMENU map
-    inline void CMenu::AddToMap() const
+    // Store the HMENU and CMenu pointer in the HMENU map. If another thread
+    // attached a CMenu to the menu after it was looked up, this CMenu shares
+    // that CMenu's data instead.
+    inline void CMenu::AddToMap()
     {
         assert(m_pData);
         assert(IsMenu(m_pData->menu));
 
-        GetApp()->AddCMenuData(m_pData->menu, m_pData);
+        CMenu_Data* pMappedData = GetApp()->AddCMenuData(m_pData->menu, m_pData);
+        if (pMappedData != m_pData)
+        {
+            delete m_pData;
+            m_pData = pMappedData;
+        }
     }
 
     // Decrements the reference count.
@@ -255,18 +262,24 @@ namespace Win32xx
     inline void CMenu::Release()
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_wndLock);
 
-        if (InterlockedDecrement(&m_pData->count) == 0)
+        bool isLastCopy = false;
         {
-            if (m_pData->menu != 0)
+            // Hold the lock of the map containing this menu, so another
+            // thread can't attach to it while it's removed from the map.
+            CThreadLock mapLock(GetApp()->GetMapLock(m_pData->pMaps));
+            if (InterlockedDecrement(&m_pData->count) == 0)
             {
-                if (m_pData->isManagedMenu)
-                {
-                    ::DestroyMenu(m_pData->menu);
-                }
-
                 RemoveFromMap();
+                isLastCopy = true;
+            }
+        }
+
+        if (isLastCopy)
+        {
+            if (m_pData->menu != 0 && m_pData->isManagedMenu)
+            {
+                ::DestroyMenu(m_pData->menu);
             }
 
             delete m_pData;
@@ -282,18 +295,8 @@ namespace Win32xx
 
         if (pApp != NULL)          // Is the CWinApp object still valid?
         {
-            // Allocate an iterator for our HMENU map
-            std::map<HMENU, CMenu_Data*, CompareHMENU>::iterator m;
-
-            CThreadLock mapLock(pApp->m_wndLock);
-            m = pApp->m_mapCMenuData.find(m_pData->menu);
-            if (m != pApp->m_mapCMenuData.end())
-            {
-                // Erase the Menu pointer entry from the map
-                pApp->m_mapCMenuData.erase(m);
-                success = TRUE;
-            }
-
+            // Erase the Menu data entry from the map
+            success = pApp->RemoveCMenuData(m_pData);
         }
 
         return success;
@@ -323,7 +326,6 @@ namespace Win32xx
     inline void CMenu::Attach(HMENU menu)
     {
         assert(m_pData);
-        CThreadLock mapLock(GetApp()->m_wndLock);
 
         if (menu != m_pData->menu)
         {
@@ -336,13 +338,13 @@ namespace Win32xx
 
             if (menu)
             {
-                // Add the menu to this CMenu
+                // Add the menu to this CMenu.
+                // GetCMenuData increments the reference count.
                 CMenu_Data* pCMenuData = GetApp()->GetCMenuData(menu);
                 if (pCMenuData)
                 {
                     delete m_pData;
                     m_pData = pCMenuData;
-                    InterlockedIncrement(&m_pData->count);
                 }
                 else
                 {
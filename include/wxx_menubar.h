@@ -168,6 +168,8 @@ namespace Win32xx
         m_isAltMode    = FALSE;
         m_prevFocus    = 0;
         m_popupMenu    = 0;
+
+        EnablePreTranslate();
     }
 
     inline CMenuBar::~CMenuBar()
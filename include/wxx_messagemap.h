@@ -0,0 +1,239 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// wxx_messagemap.h
+//  This file contains the declaration and definition of the CMessageMapT
+//  class template. CMessageMapT provides table driven message dispatch
+//  for classes that inherit from CWnd. The handlers are declared in a
+//  static table, and a single hashed lookup selects the handler for a
+//  message. Messages that have no entry in the table are passed on to
+//  the base class's WndProc, so the existing OnXxx virtual functions
+//  continue to work.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+class CMyWindow : public CMessageMapT<CMyWindow>
+{
+public:
+    // Returns the message map. The table is terminated by an entry
+    // with a NULL handler.
+    static const MessageEntry* GetMessageMap()
+    {
+        static const MessageEntry messageMap[] =
+        {
+            { WM_LBUTTONDOWN, &CMyWindow::OnLButtonDown },
+            { WM_SIZE,        &CMyWindow::OnSize },
+            { 0, 0 }
+        };
+
+        return messageMap;
+    }
+
+private:
+    LRESULT OnLButtonDown(UINT msg, WPARAM wparam, LPARAM lparam);
+    LRESULT OnSize(UINT msg, WPARAM wparam, LPARAM lparam);
+};
+
+*/
+
+
+#ifndef _WIN32XX_MESSAGEMAP_H_
+#define _WIN32XX_MESSAGEMAP_H_
+
+#include "wxx_wincore.h"
+
+
+namespace Win32xx
+{
+
+    ////////////////////////////////////////////////////////////////
+    // CMessageMapT is the class template used to provide table
+    // driven message dispatch. T is the class that inherits from
+    // CMessageMapT, and TBase is the CWnd derived class it extends.
+    // T supplies the static GetMessageMap function. T should not
+    // override WndProc. A handler can call WndProcDefault if default
+    // processing is also required.
+    template <class T, class TBase = CWnd>
+    class CMessageMapT : public TBase
+    {
+    public:
+        // An entry in the message map.
+        struct MessageEntry
+        {
+            typedef LRESULT (T::*PFNMSGHANDLER)(UINT msg, WPARAM wparam, LPARAM lparam);
+
+            UINT msg;                   // The window message
+            PFNMSGHANDLER pfnHandler;   // The member function that handles the message
+        };
+
+        CMessageMapT() : m_pTable(0) {}
+        virtual ~CMessageMapT() {}
+
+    protected:
+        virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
+
+    private:
+        CMessageMapT(const CMessageMapT&);              // Disable copy construction
+        CMessageMapT& operator = (const CMessageMapT&); // Disable assignment operator
+
+        // The hash table built from the message map.
+        struct MessageTable
+        {
+            const MessageEntry* pEntries;   // The message map supplied by T
+            UINT entryCount;                // The number of entries in the map
+            BOOL isHashed;                  // FALSE if the map is too large to hash
+            BYTE slots[256];                // Index + 1 of an entry, or 0 if empty
+        };
+
+        static const MessageTable* GetMessageTable();
+        static UINT HashMessage(UINT msg) { return (msg * 0x9E3779B1U) >> 24; }
+
+        const MessageTable* m_pTable;   // This class's message table, cached on first use
+    };
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+
+    //////////////////////////////////////////////////
+    // Definitions for the CMessageMapT class template
+    //
+
+    // Returns the message table for T. The table is built from the
+    // message map the first time it is requested, and is shared by
+    // all the objects of type T.
+    template <class T, class TBase>
+    inline const typename CMessageMapT<T, TBase>::MessageTable* CMessageMapT<T, TBase>::GetMessageTable()
+    {
+        // Both are zero initialized before any code runs.
+        static MessageTable table;
+        static LONG lock;
+
+        // A spin lock guards the table while it is built.
+        while (::InterlockedExchange(&lock, 1) != 0)
+            ::Sleep(0);
+
+        if (table.pEntries == 0)
+        {
+            const MessageEntry* pEntries = T::GetMessageMap();
+            assert(pEntries);
+
+            UINT count = 0;
+            while (pEntries[count].pfnHandler != 0)
+                ++count;
+
+            // Keep the table at most half full so each probe sequence is short.
+            table.entryCount = count;
+            table.isHashed = (count <= 128);
+            if (table.isHashed)
+            {
+                for (UINT i = 0; i < count; ++i)
+                {
+                    UINT slot = HashMessage(pEntries[i].msg);
+                    while (table.slots[slot] != 0 && pEntries[table.slots[slot] - 1].msg != pEntries[i].msg)
+                        slot = (slot + 1) & 0xFF;
+
+                    // The first entry for a message takes precedence.
+                    if (table.slots[slot] == 0)
+                        table.slots[slot] = static_cast<BYTE>(i + 1);
+                }
+            }
+
+            table.pEntries = pEntries;
+        }
+
+        ::InterlockedExchange(&lock, 0);
+        return &table;
+    }
+
+    // Dispatches the message to its handler in the message map. Messages
+    // without a handler are passed to the base class's WndProc.
+    template <class T, class TBase>
+    inline LRESULT CMessageMapT<T, TBase>::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
+    {
+        if (m_pTable == 0)
+            m_pTable = GetMessageTable();
+
+        const MessageEntry* pEntries = m_pTable->pEntries;
+        typename MessageEntry::PFNMSGHANDLER pfnHandler = 0;
+
+        if (m_pTable->isHashed)
+        {
+            UINT slot = HashMessage(msg);
+            for (UINT index = m_pTable->slots[slot]; index != 0; index = m_pTable->slots[slot])
+            {
+                if (pEntries[index - 1].msg == msg)
+                {
+                    pfnHandler = pEntries[index - 1].pfnHandler;
+                    break;
+                }
+
+                slot = (slot + 1) & 0xFF;
+            }
+        }
+        else
+        {
+            for (UINT i = 0; i < m_pTable->entryCount; ++i)
+            {
+                if (pEntries[i].msg == msg)
+                {
+                    pfnHandler = pEntries[i].pfnHandler;
+                    break;
+                }
+            }
+        }
+
+        if (pfnHandler != 0)
+            return (static_cast<T*>(this)->*pfnHandler)(msg, wparam, lparam);
+
+        return TBase::WndProc(msg, wparam, lparam);
+    }
+
+}
+
+
+#endif // _WIN32XX_MESSAGEMAP_H_
+
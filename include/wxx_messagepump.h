@@ -43,6 +43,177 @@
 
 namespace Win32xx
 {
+    // CMessagePump constructor.
+    inline CMessagePump::CMessagePump() : m_accel(0), m_accelWnd(0), m_nextTaskID(1),
+        m_pTaskHead(0), m_pBatch(0), m_taskWnd(0), m_isWakePosted(FALSE), m_frequency(1)
+    {
+        ZeroMemory(&m_taskStats, sizeof(m_taskStats));
+
+        LARGE_INTEGER frequency;
+        if (::QueryPerformanceFrequency(&frequency))
+            m_frequency = frequency.QuadPart;
+    }
+
+    // CMessagePump destructor.
+    inline CMessagePump::~CMessagePump()
+    {
+        // The task window is normally destroyed when Run returns. A window
+        // can only be destroyed by its own thread, so otherwise it is
+        // detached from this object and destroyed when its thread ends.
+        if (m_taskWnd != 0)
+        {
+            ::SetWindowLongPtr(m_taskWnd, GWLP_USERDATA, 0);
+            if (::GetWindowThreadProcessId(m_taskWnd, NULL) == ::GetCurrentThreadId())
+                ::DestroyWindow(m_taskWnd);
+        }
+
+        // Delete the tasks that didn't run.
+        TaskNode* lists[2] = { m_pBatch, m_pTaskHead };
+        for (int i = 0; i < 2; ++i)
+        {
+            TaskNode* pNode = lists[i];
+            while (pNode != 0)
+            {
+                TaskNode* pNext = pNode->pNext;
+                delete pNode;
+                pNode = pNext;
+            }
+        }
+    }
+
+    // Adds a task that runs while the message queue is empty. Tasks with a
+    // higher priority run first, and tasks with the same priority take turns.
+    // The budget is the time slice, in milliseconds, a task can use before
+    // the message loop checks for messages again. The task function returns
+    // TRUE while it has more work to do. A task that returns FALSE runs again
+    // after the next message is processed or a wait handle is signalled.
+    // Returns the task's ID, used by RemoveIdleTask.
+    // Note: Idle tasks should only be added and removed by the thread that
+    //       runs this message loop.
+    inline UINT CMessagePump::AddIdleTask(PFNIDLETASK pfnTask, LPVOID pParam, int priority /*= 0*/, DWORD budget /*= 10*/)
+    {
+        assert(pfnTask);
+
+        IdleTask task;
+        task.id = m_nextTaskID++;
+        task.pfnTask = pfnTask;
+        task.pParam = pParam;
+        task.priority = priority;
+        task.budget = budget;
+        task.isPending = TRUE;
+
+        // Insert the task after the tasks with the same or higher priority.
+        std::vector<IdleTask>::iterator it = m_idleTasks.begin();
+        while (it != m_idleTasks.end() && (*it).priority >= priority)
+            ++it;
+
+        m_idleTasks.insert(it, task);
+        return task.id;
+    }
+
+    // Adds a kernel handle for the message loop to wait on. Suitable handles
+    // include those of a CEvent, CMutex, CSemaphore or thread. The wait
+    // procedure is called by this thread when the handle is signalled, and
+    // returns TRUE to continue waiting on the handle. Up to
+    // MAXIMUM_WAIT_OBJECTS - 1 handles can be added.
+    // Note: Wait handles should only be added and removed by the thread that
+    //       runs this message loop.
+    inline BOOL CMessagePump::AddWaitHandle(HANDLE handle, PFNWAITPROC pfnWait, LPVOID pParam)
+    {
+        assert(handle);
+        assert(pfnWait);
+
+        WaitProc proc;
+        proc.pfnWait = pfnWait;
+        proc.pParam = pParam;
+
+        // Update the wait procedure if the handle has already been added.
+        for (size_t i = 0; i < m_waitHandles.size(); ++i)
+        {
+            if (m_waitHandles[i] == handle)
+            {
+                m_waitProcs[i] = proc;
+                return TRUE;
+            }
+        }
+
+        if (m_waitHandles.size() >= MAXIMUM_WAIT_OBJECTS - 1)
+            return FALSE;
+
+        m_waitHandles.push_back(handle);
+        m_waitProcs.push_back(proc);
+        return TRUE;
+    }
+
+    // Creates the message-only window that runs the posted tasks. It belongs
+    // to the thread that runs the message loop, so the tasks also run while
+    // a modal dialog, menu or message box runs its own message loop.
+    inline void CMessagePump::CreateTaskWindow()
+    {
+        if (m_taskWnd != 0)
+            return;
+
+        HINSTANCE instance = GetApp()->GetInstanceHandle();
+        LPCTSTR className = _T("Win32++ Task Window");
+        WNDCLASS wc;
+        ZeroMemory(&wc, sizeof(wc));
+        if (!::GetClassInfo(instance, className, &wc))
+        {
+            // Registration fails harmlessly if another thread registered the class first.
+            wc.hInstance     = instance;
+            wc.lpfnWndProc   = CMessagePump::StaticTaskWndProc;
+            wc.lpszClassName = className;
+            ::RegisterClass(&wc);
+        }
+
+        HWND wnd = ::CreateWindowEx(0, className, NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, 0, instance, NULL);
+        if (wnd == 0)
+        {
+            TRACE("*** Warning in CMessagePump::CreateTaskWindow: posted tasks can't run ***\n");
+            return;
+        }
+
+        ::SetWindowLongPtr(wnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+        ::InterlockedExchange(&m_isWakePosted, FALSE);
+        ::InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&m_taskWnd), wnd);
+
+        // Wake the message loop for the tasks posted before it started.
+        if (m_pTaskHead != 0 || m_pBatch != 0)
+            WakeForTasks();
+    }
+
+    // Destroys the window that runs the posted tasks. Tasks posted
+    // afterwards wait until the message loop runs again.
+    inline void CMessagePump::DestroyTaskWindow()
+    {
+        HWND wnd = static_cast<HWND>(::InterlockedExchangePointer(
+                       reinterpret_cast<PVOID volatile*>(&m_taskWnd), NULL));
+
+        if (wnd != 0)
+            ::DestroyWindow(wnd);
+    }
+
+    // Calls the wait procedure for a signalled wait handle.
+    inline void CMessagePump::DispatchWaitHandle(DWORD index)
+    {
+        assert(index < m_waitHandles.size());
+
+        // Copy the handle and procedure. The wait procedure can add or remove handles.
+        HANDLE handle = m_waitHandles[index];
+        WaitProc proc = m_waitProcs[index];
+        if (!proc.pfnWait(handle, proc.pParam))
+            RemoveWaitHandle(handle);
+    }
+
+    // Returns the statistics for the tasks posted with PostTask. The statistics
+    // are updated by the thread that runs this message loop, and can be
+    // retrieved by any thread.
+    inline TaskQueueStats CMessagePump::GetTaskQueueStats() const
+    {
+        CThreadLock statsLock(m_statsLock);
+        return m_taskStats;
+    }
+
     // InitInstance is called when the thread or application starts.
     // Override this function to perform tasks such as creating a window.
     // Return TRUE to indicate success and run the message loop.
@@ -52,37 +223,78 @@ namespace Win32xx
     }
 
     // This function translates the thread's window message and dispatches
-    // them to a window procedure.
+    // them to a window procedure. While the message queue is empty, OnIdle is
+    // called until it returns FALSE, and then the idle tasks are run. The
+    // thread then sleeps until a message arrives or a wait handle is signalled.
     inline int CMessagePump::MessageLoop()
     {
         MSG msg;
         ZeroMemory(&msg, sizeof(msg));
-        int status = 1;
         LONG count = 0;
+        BOOL isIdle = TRUE;
+
+        // The task window is normally created by Run.
+        CreateTaskWindow();
 
-        while (status != 0)
+        for (;;)
         {
-            // While idle, perform idle processing until OnIdle returns FALSE
-            while (!::PeekMessage(&msg, 0, 0, 0, PM_NOREMOVE) && OnIdle(count) != FALSE)
+            // Process the next message in the queue.
+            if (::PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
             {
-                count++;
-            }
+                if (msg.message == WM_QUIT)
+                {
+                    DestroyTaskWindow();
+                    return LOWORD(msg.wParam);
+                }
+
+#ifndef NO_DISPATCH_PROFILER
+                BOOL isProfiling = GetApp()->IsDispatchProfileEnabled();
+                LONGLONG start = isProfiling ? CWinApp::GetProfileCounter() : 0;
+#endif
 
-            count = 0;
+                if (!PreTranslateMessage(msg))
+                {
+                    ::TranslateMessage(&msg);
+                    ::DispatchMessage(&msg);
+                }
 
-            // Now wait until we get a message
-            if ((status = ::GetMessage(&msg, NULL, 0, 0)) == -1)
-                return -1;
+#ifndef NO_DISPATCH_PROFILER
+                if (isProfiling)
+                    GetApp()->RecordQueuedMessage(msg.message, start);
+#endif
 
-            if (!PreTranslateMessage(msg))
+                // Idle processing resumes after a message is processed.
+                isIdle = TRUE;
+                count = 0;
+                continue;
+            }
+
+            // While idle, perform idle processing until OnIdle returns FALSE.
+            if (isIdle)
             {
-                ::TranslateMessage(&msg);
-                ::DispatchMessage(&msg);
+                // The idle tasks have work to do when idle processing starts.
+                if (count == 0)
+                    SetIdleTasksPending();
+
+                isIdle = OnIdle(count++);
+                continue;
             }
 
-        }
+            // Run the posted tasks if the task window couldn't be woken.
+            if ((m_pTaskHead != 0 || m_pBatch != 0) && m_isWakePosted == FALSE && RunPostedTasks())
+                continue;
 
-        return LOWORD(msg.wParam);
+            // Run a time slice of the highest priority idle task.
+            if (RunIdleTasks())
+                continue;
+
+            // Sleep until a message arrives or a wait handle is signalled.
+            if (WaitForWork())
+            {
+                isIdle = TRUE;
+                count = 0;
+            }
+        }
     }
 
     // This function is called by the MessageLoop. It is called when the message queue
@@ -110,38 +322,228 @@ namespace Win32xx
                 isProcessed = TRUE;
             else
             {
-                // Search the chain of parents for pretranslated messages.
-                for (HWND wnd = msg.hwnd; wnd != 0; wnd = ::GetParent(wnd))
+                // Call PreTranslateMessage for the window and its ancestors that
+                // have pre-translation enabled. The chain of windows is cached.
+                CWinApp* pApp = GetApp();
+                TLSData* pTLSData = pApp->GetTlsData();
+                if (pTLSData)
                 {
-                    CWnd* pWnd = GetApp()->GetCWndFromMap(wnd);
-                    if (pWnd)
+                    HWND wnd = msg.hwnd;
+                    std::vector<CWnd*>& chain = pApp->GetPreTranslateChain(*pTLSData, wnd);
+                    LONG gen = pTLSData->preTranslateGen;
+                    for (size_t i = 0; i < chain.size(); ++i)
                     {
-                        isProcessed = pWnd->PreTranslateMessage(msg);
-                        if (isProcessed)
+                        isProcessed = chain[i]->PreTranslateMessage(msg);
+
+                        // Stop if the message is processed, or if the chain was
+                        // invalidated because a window was destroyed or re-parented.
+                        if (isProcessed || pApp->m_preTranslateGen != gen)
                             break;
+
+                        // A nested message loop may have rebuilt the cached chain
+                        // for another window. The generation is unchanged, so the
+                        // chain rebuilt for this window holds the same windows.
+                        if (pTLSData->preTranslateWnd != wnd)
+                            pApp->GetPreTranslateChain(*pTLSData, wnd);
                     }
                 }
+
+#ifndef NDEBUG
+                if (!isProcessed)
+                    isProcessed = CheckPreTranslate(msg);
+#endif
             }
         }
 
         return isProcessed;
     }
 
+#ifndef NDEBUG
+    // Debug builds call PreTranslateMessage for the window and its ancestors
+    // that haven't enabled pre-translation, to detect overrides that the
+    // message loop doesn't call in release builds. An override is detected
+    // when it processes the message or doesn't call CWnd::PreTranslateMessage.
+    // Each window is reported once.
+    inline BOOL CMessagePump::CheckPreTranslate(MSG& msg)
+    {
+        CWinApp* pApp = GetApp();
+        for (HWND ancestor = msg.hwnd; ancestor != 0; ancestor = ::GetParent(ancestor))
+        {
+            CWnd* pWnd = pApp->GetCWndFromMap(ancestor);
+            if (pWnd && !pWnd->IsPreTranslateEnabled() && !pWnd->m_isPreTranslateReported)
+            {
+                pWnd->m_isBasePreTranslated = FALSE;
+                BOOL isProcessed = pWnd->PreTranslateMessage(msg);
+
+                // Stop if the override destroyed the window.
+                if (pApp->GetCWndFromMap(ancestor) != pWnd)
+                    return isProcessed;
+
+                if (isProcessed || !pWnd->m_isBasePreTranslated)
+                {
+                    pWnd->m_isPreTranslateReported = TRUE;
+                    TRACE("*** Warning in CMessagePump::PreTranslateMessage: PreTranslateMessage is overridden ***\n");
+                    TRACE("*** Call EnablePreTranslate for this window, or release builds won't call it. ***\n");
+                    assert(pWnd->IsPreTranslateEnabled());
+                }
+
+                if (isProcessed)
+                    return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+#endif
+
+    // Posts a task to run on the thread that runs this message loop. Any thread
+    // can call this function, and it doesn't take a lock or block. Tasks run
+    // in the order they are posted, including while a modal loop runs. Tasks
+    // posted while the thread is busy are run together as a batch, and only
+    // one UWM_RUNTASKS message is posted for each batch. Tasks posted before
+    // Run is called wait for the message loop to start.
+    inline BOOL CMessagePump::PostTask(PFNTASKPROC pfnTask, LPVOID pParam)
+    {
+        assert(pfnTask);
+
+        LARGE_INTEGER counter;
+        ::QueryPerformanceCounter(&counter);
+
+        TaskNode* pNode = new TaskNode;
+        pNode->pfnTask = pfnTask;
+        pNode->pParam = pParam;
+        pNode->postTime = counter.QuadPart;
+
+        // Push the task onto the list without a lock.
+        TaskNode* pHead;
+        do
+        {
+            pHead = m_pTaskHead;
+            pNode->pNext = pHead;
+        } while (::InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pTaskHead),
+                                                     pNode, pHead) != pHead);
+
+        ::InterlockedIncrement(&m_taskStats.postCount);
+        ::InterlockedIncrement(&m_taskStats.depth);
+
+        WakeForTasks();
+        return TRUE;
+    }
+
+    // Removes an idle task added by AddIdleTask.
+    inline BOOL CMessagePump::RemoveIdleTask(UINT taskID)
+    {
+        std::vector<IdleTask>::iterator it;
+        for (it = m_idleTasks.begin(); it != m_idleTasks.end(); ++it)
+        {
+            if ((*it).id == taskID)
+            {
+                m_idleTasks.erase(it);
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+
+    // Removes a wait handle added by AddWaitHandle.
+    inline BOOL CMessagePump::RemoveWaitHandle(HANDLE handle)
+    {
+        for (size_t i = 0; i < m_waitHandles.size(); ++i)
+        {
+            if (m_waitHandles[i] == handle)
+            {
+                m_waitHandles.erase(m_waitHandles.begin() + i);
+                m_waitProcs.erase(m_waitProcs.begin() + i);
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+
+    // Resets the statistics for the tasks posted with PostTask.
+    inline void CMessagePump::ResetTaskQueueStats()
+    {
+        // The depth is not reset, as it is the number of tasks waiting to run.
+        CThreadLock statsLock(m_statsLock);
+        ::InterlockedExchange(&m_taskStats.postCount, 0);
+        m_taskStats.maxDepth = 0;
+        m_taskStats.batchCount = 0;
+        m_taskStats.taskCount = 0;
+        m_taskStats.totalLatency = 0.0;
+        m_taskStats.maxLatency = 0.0;
+    }
+
     // Calls InitInstance and runs the message loop.
     inline int CMessagePump::Run()
     {
+        // Posted tasks can run from here on, including while InitInstance
+        // displays a modal dialog.
+        CreateTaskWindow();
+
+        int result = -1;
+
         // InitInstance runs the App's initialization code
         if (InitInstance())
         {
             // Dispatch the window messages
-            return MessageLoop();
+            result = MessageLoop();
         }
         else
         {
             TRACE("InitInstance failed!  Terminating the thread\n");
             ::PostQuitMessage(-1);
-            return -1;
         }
+
+        DestroyTaskWindow();
+        return result;
+    }
+
+    // Runs a time slice of the highest priority idle task that has work to do.
+    // The task is called repeatedly until it has no more work, its budget is
+    // used, or a message arrives. Returns TRUE if idle tasks still have work.
+    inline BOOL CMessagePump::RunIdleTasks()
+    {
+        std::vector<IdleTask>::iterator it = m_idleTasks.begin();
+        while (it != m_idleTasks.end() && !(*it).isPending)
+            ++it;
+
+        if (it == m_idleTasks.end())
+            return FALSE;
+
+        // Copy the task. The task function can add or remove tasks.
+        IdleTask task = *it;
+        DWORD start = ::GetTickCount();
+        do
+        {
+            task.isPending = task.pfnTask(task.pParam);
+        } while (task.isPending && (::GetTickCount() - start < task.budget) &&
+                 HIWORD(::GetQueueStatus(QS_ALLINPUT)) == 0);
+
+        BOOL isPending = FALSE;
+        for (it = m_idleTasks.begin(); it != m_idleTasks.end(); ++it)
+        {
+            if ((*it).id == task.id)
+            {
+                // Move the task behind the other tasks with the same priority.
+                m_idleTasks.erase(it);
+                it = m_idleTasks.begin();
+                while (it != m_idleTasks.end() && (*it).priority >= task.priority)
+                    ++it;
+
+                m_idleTasks.insert(it, task);
+                break;
+            }
+        }
+
+        for (it = m_idleTasks.begin(); it != m_idleTasks.end(); ++it)
+        {
+            if ((*it).isPending)
+                isPending = TRUE;
+        }
+
+        return isPending;
     }
 
     // accel is the handle of the accelerator table
@@ -152,6 +554,164 @@ namespace Win32xx
         m_accel = accel;
     }
 
+    // Runs the tasks posted by other threads, in the order they were posted.
+    // Called by the task window when it receives UWM_RUNTASKS, and by the
+    // message loop if the task window couldn't be woken. Returns TRUE if
+    // tasks were run.
+    inline BOOL CMessagePump::RunPostedTasks()
+    {
+        // Tasks posted from here on post another UWM_RUNTASKS message.
+        ::InterlockedExchange(&m_isWakePosted, FALSE);
+
+        // Take the entire list of posted tasks without a lock.
+        TaskNode* pNode = static_cast<TaskNode*>(::InterlockedExchangePointer(
+                              reinterpret_cast<PVOID volatile*>(&m_pTaskHead), NULL));
+
+        // Reverse the list to run the tasks in the order they were posted.
+        TaskNode* pFirst = 0;
+        LONG batchSize = 0;
+        while (pNode != 0)
+        {
+            TaskNode* pNext = pNode->pNext;
+            pNode->pNext = pFirst;
+            pFirst = pNode;
+            pNode = pNext;
+            ++batchSize;
+        }
+
+        if (batchSize == 0 && m_pBatch == 0)
+            return FALSE;
+
+        if (batchSize != 0)
+        {
+            ::InterlockedExchangeAdd(&m_taskStats.depth, -batchSize);
+            CThreadLock statsLock(m_statsLock);
+            m_taskStats.maxDepth = MAX(m_taskStats.maxDepth, batchSize);
+            ++m_taskStats.batchCount;
+        }
+
+        // Add the new tasks after the rest of a batch that was interrupted,
+        // either by a task that threw an exception, or by a task that ran a
+        // modal loop which runs this function again.
+        TaskNode** ppLast = &m_pBatch;
+        while (*ppLast != 0)
+            ppLast = &(*ppLast)->pNext;
+
+        *ppLast = pFirst;
+
+        try
+        {
+            while (m_pBatch != 0)
+            {
+                pNode = m_pBatch;
+                m_pBatch = pNode->pNext;
+
+                LARGE_INTEGER counter;
+                ::QueryPerformanceCounter(&counter);
+                double latency = 1000.0 * static_cast<double>(counter.QuadPart - pNode->postTime) / m_frequency;
+                {
+                    CThreadLock statsLock(m_statsLock);
+                    m_taskStats.totalLatency += latency;
+                    m_taskStats.maxLatency = MAX(m_taskStats.maxLatency, latency);
+                    ++m_taskStats.taskCount;
+                }
+
+                PFNTASKPROC pfnTask = pNode->pfnTask;
+                LPVOID pParam = pNode->pParam;
+                delete pNode;
+                pfnTask(pParam);
+            }
+        }
+
+        catch(...)
+        {
+            // The rest of the batch runs when the task window is woken again.
+            if (m_pBatch != 0)
+                WakeForTasks();
+
+            throw;      // Rethrow
+        }
+
+        return TRUE;
+    }
+
+    // Marks all idle tasks as having work to do.
+    inline void CMessagePump::SetIdleTasksPending()
+    {
+        std::vector<IdleTask>::iterator it;
+        for (it = m_idleTasks.begin(); it != m_idleTasks.end(); ++it)
+            (*it).isPending = TRUE;
+    }
+
+    // The window procedure for the task window. UWM_RUNTASKS is dispatched
+    // by any message loop running on the thread, including modal loops.
+    inline LRESULT CALLBACK CMessagePump::StaticTaskWndProc(HWND wnd, UINT msg, WPARAM wparam, LPARAM lparam)
+    {
+        if (msg == UWM_RUNTASKS)
+        {
+            CMessagePump* pPump = reinterpret_cast<CMessagePump*>(::GetWindowLongPtr(wnd, GWLP_USERDATA));
+            if (pPump != 0)
+                pPump->RunPostedTasks();
+
+            return 0;
+        }
+
+        return ::DefWindowProc(wnd, msg, wparam, lparam);
+    }
+
+    // Sleeps until a message arrives, a wait handle is signalled, or an APC
+    // is queued to this thread. Returns TRUE if a wait handle was signalled
+    // or an APC was run.
+    inline BOOL CMessagePump::WaitForWork()
+    {
+        DWORD handleCount = static_cast<DWORD>(m_waitHandles.size());
+        const HANDLE* pHandles = handleCount ? &m_waitHandles[0] : NULL;
+        DWORD result = ::MsgWaitForMultipleObjectsEx(handleCount, pHandles, INFINITE,
+                                    QS_ALLINPUT, MWMO_INPUTAVAILABLE | MWMO_ALERTABLE);
+
+        if (result < WAIT_OBJECT_0 + handleCount)
+        {
+            DispatchWaitHandle(result - WAIT_OBJECT_0);
+            return TRUE;
+        }
+
+        // An abandoned mutex is also signalled.
+        if (result >= WAIT_ABANDONED_0 && result < WAIT_ABANDONED_0 + handleCount)
+        {
+            DispatchWaitHandle(result - WAIT_ABANDONED_0);
+            return TRUE;
+        }
+
+        if (result == WAIT_IO_COMPLETION)
+            return TRUE;
+
+        if (result == WAIT_FAILED)
+        {
+            // Remove the invalid handles, such as handles that have been closed.
+            TRACE("*** Warning in CMessagePump::WaitForWork: removing invalid wait handles ***\n");
+            for (size_t i = m_waitHandles.size(); i > 0; --i)
+            {
+                if (::WaitForSingleObject(m_waitHandles[i - 1], 0) == WAIT_FAILED)
+                    RemoveWaitHandle(m_waitHandles[i - 1]);
+            }
+        }
+
+        return FALSE;
+    }
+
+    // Posts a UWM_RUNTASKS message to the task window, unless one is already
+    // waiting to be processed. If the message can't be posted, the message
+    // loop runs the tasks when it's idle.
+    inline void CMessagePump::WakeForTasks()
+    {
+        HWND wnd = m_taskWnd;
+        if (wnd != 0 && ::InterlockedExchange(&m_isWakePosted, TRUE) == FALSE)
+        {
+            if (!::PostMessage(wnd, UWM_RUNTASKS, 0, 0))
+                ::InterlockedExchange(&m_isWakePosted, FALSE);
+        }
+    }
+
 }
 
 #endif // _WIN32XX_MESSAGEPUMP_H_
@@ -39,20 +39,69 @@
 #define _WIN32XX_MESSAGEPUMP0_H_
 
 #include "wxx_textconv.h"
+#include "wxx_criticalsection.h"
+
+// Required by compilers lacking MsgWaitForMultipleObjectsEx support.
+#ifndef MWMO_INPUTAVAILABLE
+  #define MWMO_ALERTABLE      0x0002
+  #define MWMO_INPUTAVAILABLE 0x0004
+#endif
 
 namespace Win32xx
 {
 
+    // An idle task returns TRUE if it has more work to do.
+    typedef BOOL (WINAPI* PFNIDLETASK)(LPVOID);
+
+    // A wait procedure returns TRUE to continue waiting on the handle.
+    typedef BOOL (WINAPI* PFNWAITPROC)(HANDLE, LPVOID);
+
+    // A task posted to a message loop by PostTask.
+    typedef void (WINAPI* PFNTASKPROC)(LPVOID);
+
+    // Statistics for the tasks posted to a message loop.
+    struct TaskQueueStats
+    {
+        LONG depth;             // Number of tasks waiting to run
+        LONG maxDepth;          // Largest number of tasks waiting to run
+        LONG postCount;         // Number of tasks posted
+        LONG batchCount;        // Number of batches of tasks run by the message loop
+        LONG taskCount;         // Number of tasks run by the message loop
+        double totalLatency;    // Total milliseconds between posting and running the tasks
+        double maxLatency;      // Longest milliseconds between posting and running a task
+    };
+
+    //////////////////////////////////////////////////////////////////
+    // CMessagePump runs the message loop for CWinApp and CWinThread.
+    // While the message queue is empty, the message loop calls OnIdle,
+    // and then runs the idle tasks in time slices, highest priority
+    // first. When there is no more idle work, the thread sleeps until
+    // a message arrives or a wait handle is signalled. Other threads
+    // can post tasks to the message loop with PostTask. Posting a task
+    // doesn't take a lock. A message-only window wakes the thread to
+    // run the posted tasks, so they also run while a modal dialog, menu
+    // or message box runs its own message loop.
     class CMessagePump : public CObject
     {
     public:
-        CMessagePump() : m_accel(0), m_accelWnd(0) {}
-        virtual ~CMessagePump() {}
+        CMessagePump();
+        virtual ~CMessagePump();
 
         HACCEL GetAcceleratorTable() const { return m_accel; }
         HWND   GetAcceleratorsWindow() const { return m_accelWnd; }
         void   SetAccelerators(HACCEL accel, HWND accelWnd);
 
+        // Idle tasks and wait handles.
+        UINT   AddIdleTask(PFNIDLETASK pfnTask, LPVOID pParam, int priority = 0, DWORD budget = 10);
+        BOOL   AddWaitHandle(HANDLE handle, PFNWAITPROC pfnWait, LPVOID pParam);
+        BOOL   RemoveIdleTask(UINT taskID);
+        BOOL   RemoveWaitHandle(HANDLE handle);
+
+        // Tasks posted by other threads.
+        TaskQueueStats GetTaskQueueStats() const;
+        BOOL   PostTask(PFNTASKPROC pfnTask, LPVOID pParam);
+        void   ResetTaskQueueStats();
+
         // Override this function as required.
         virtual int  Run();
 
@@ -64,11 +113,64 @@ namespace Win32xx
         virtual BOOL PreTranslateMessage(MSG& msg);
 
     private:
+#ifndef NDEBUG
+        BOOL CheckPreTranslate(MSG& msg);
+#endif
+
+        // An idle task registered with AddIdleTask.
+        struct IdleTask
+        {
+            UINT id;                // identifies the task
+            PFNIDLETASK pfnTask;    // task callback function
+            LPVOID pParam;          // task parameter
+            int priority;           // tasks with a higher priority run first
+            DWORD budget;           // time slice in milliseconds
+            BOOL isPending;         // TRUE while the task has work to do
+        };
+
+        // A wait procedure registered with AddWaitHandle.
+        struct WaitProc
+        {
+            PFNWAITPROC pfnWait;    // wait callback function
+            LPVOID pParam;          // wait parameter
+        };
+
+        // A task posted with PostTask.
+        struct TaskNode
+        {
+            TaskNode* pNext;        // the next task in the list
+            PFNTASKPROC pfnTask;    // task callback function
+            LPVOID pParam;          // task parameter
+            LONGLONG postTime;      // performance counter when the task was posted
+        };
+
         CMessagePump(const CMessagePump&);                // Disable copy construction
         CMessagePump& operator = (const CMessagePump&);   // Disable assignment operator
 
+        void CreateTaskWindow();
+        void DestroyTaskWindow();
+        void DispatchWaitHandle(DWORD index);
+        BOOL RunIdleTasks();
+        BOOL RunPostedTasks();
+        void SetIdleTasksPending();
+        void WakeForTasks();
+        BOOL WaitForWork();
+
+        static LRESULT CALLBACK StaticTaskWndProc(HWND wnd, UINT msg, WPARAM wparam, LPARAM lparam);
+
         HACCEL m_accel;               // handle to the accelerator table
         HWND m_accelWnd;              // handle to the window for accelerator keys
+        UINT m_nextTaskID;            // identifier for the next idle task
+        std::vector<IdleTask> m_idleTasks;    // idle tasks, sorted by priority
+        std::vector<HANDLE> m_waitHandles;    // handles the message loop waits on
+        std::vector<WaitProc> m_waitProcs;    // wait procedures, one for each wait handle
+        TaskNode* volatile m_pTaskHead;       // posted tasks, most recent first
+        TaskNode* m_pBatch;                   // the rest of the batch being run, in the order posted
+        HWND volatile m_taskWnd;              // message-only window that runs the posted tasks
+        LONG m_isWakePosted;                  // TRUE while a UWM_RUNTASKS message is waiting to be processed
+        LONGLONG m_frequency;                 // performance counter frequency
+        TaskQueueStats m_taskStats;           // statistics for the posted tasks
+        CCriticalSection m_statsLock;         // thread synchronization for the statistics
     };
 
 }
@@ -0,0 +1,607 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// wxx_pixels.h
+//  This file contains the functions that process the pixels of 32 bit
+//  device independent bitmaps. They are used by CBitmap::GrayScaleBitmap,
+//  CBitmap::TintBitmap and CBitmap::ConvertToDisabled.
+//
+//  Each operation has a scalar, an SSE2 and an AVX2 version. The version
+//  is chosen at run time based on the processor, and every version
+//  produces the same result. Define NO_PIXEL_SIMD to use only the scalar
+//  version. Large images are divided into bands of rows which are
+//  processed in parallel by the thread pool.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+// Converts the rows of a 32 bit DIB to gray scale.
+void CView::GrayScale(BYTE* pBits, int width, int height)
+{
+    CPixelOperation op(CPixelOperation::GRAYSCALE, pBits, width, height);
+    op.Process();
+}
+
+*/
+
+
+#ifndef _WIN32XX_PIXELS_H_
+#define _WIN32XX_PIXELS_H_
+
+#include "wxx_appcore0.h"
+#include "wxx_thread.h"
+#include "wxx_mutex.h"
+#include "wxx_threadpool.h"
+
+
+// The SIMD versions are supported for x86 and x64 processors.
+#if !defined (NO_PIXEL_SIMD) && (defined (_M_IX86) || defined (_M_X64) || defined (__i386__) || defined (__x86_64__))
+  #if defined (__GNUC__) || (defined (_MSC_VER) && (_MSC_VER >= 1500))   // >= VS2008
+    #define WXX_PIXEL_SSE2
+    #include <emmintrin.h>
+    #ifdef _MSC_VER
+      #include <intrin.h>
+    #else
+      #include <cpuid.h>
+    #endif
+  #endif
+  #if (defined (__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+      defined (__clang__) || (defined (_MSC_VER) && (_MSC_VER >= 1800))   // >= VS2013
+    #define WXX_PIXEL_AVX2
+    #include <immintrin.h>
+  #endif
+#endif
+
+// GCC and Clang compile the SIMD functions for their instruction set.
+#if defined (__GNUC__) || defined (__clang__)
+  #define WXX_TARGET_SSE2 __attribute__((target("sse2")))
+  #define WXX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define WXX_TARGET_SSE2
+  #define WXX_TARGET_AVX2
+#endif
+
+
+namespace Win32xx
+{
+    // The instruction sets used to process pixels.
+    enum PixelSIMD
+    {
+        PIXEL_SCALAR = 0,   // Standard C++
+        PIXEL_SSE2   = 1,   // 4 pixels at a time
+        PIXEL_AVX2   = 2    // 8 pixels at a time
+    };
+
+    // Images with at least this number of pixels are processed in parallel.
+    const int WXX_PARALLEL_PIXELS = 256 * 1024;
+
+    // The minimum number of pixels in a band of rows processed in parallel.
+    const int WXX_PIXELS_PER_BAND = 64 * 1024;
+
+
+    //////////////////////////////////////////////////////////////////
+    // CPixelOperation applies an operation to the pixels of a 32 bit
+    // bottom-up or top-down DIB. Each pixel is stored as blue, green,
+    // red and an unused or alpha byte. The unused byte isn't modified.
+    // The stride is the distance in bytes from one row to the next. It
+    // can be negative, and defaults to width * 4.
+    class CPixelOperation
+    {
+    public:
+        // The operations that can be applied.
+        enum Operation
+        {
+            GRAYSCALE,  // Convert to gray scale
+            TINT,       // Adjust the colors by the tint values
+            DISABLED    // Convert to the pale gray used for disabled images
+        };
+
+        CPixelOperation(Operation operation, BYTE* pBits, int width, int height, int stride = 0);
+        virtual ~CPixelOperation() {}
+
+        PixelSIMD GetSIMD() const       { return m_simd; }
+        void Process();
+        void ProcessRows(int first, int last) const;
+        void SetMask(COLORREF mask)     { m_mask = mask; }
+        void SetSIMD(PixelSIMD simd);
+        void SetTint(int red, int green, int blue);
+
+        static PixelSIMD GetSupportedSIMD();
+
+    private:
+        static PixelSIMD DetectSIMD();
+        static void WINAPI StaticRowsProc(int first, int last, LPVOID pOperation);
+
+        void DisabledRowScalar(BYTE* pRow, int pixel) const;
+        void GrayScaleRowScalar(BYTE* pRow, int pixel) const;
+        void TintRowScalar(BYTE* pRow, int pixel) const;
+
+#ifdef WXX_PIXEL_SSE2
+        WXX_TARGET_SSE2 int DisabledRowSSE2(BYTE* pRow) const;
+        WXX_TARGET_SSE2 int GrayScaleRowSSE2(BYTE* pRow) const;
+        WXX_TARGET_SSE2 int TintRowSSE2(BYTE* pRow) const;
+#endif
+
+#ifdef WXX_PIXEL_AVX2
+        WXX_TARGET_AVX2 int DisabledRowAVX2(BYTE* pRow) const;
+        WXX_TARGET_AVX2 int GrayScaleRowAVX2(BYTE* pRow) const;
+        WXX_TARGET_AVX2 int TintRowAVX2(BYTE* pRow) const;
+#endif
+
+        Operation m_operation;  // The operation to apply
+        BYTE* m_pBits;          // The pixels of the DIB
+        int m_width;            // The width of the DIB in pixels
+        int m_height;           // The number of rows in the DIB
+        int m_stride;           // The number of bytes from one row to the next
+        PixelSIMD m_simd;       // The instruction set used
+        COLORREF m_mask;        // Pixels matching this color aren't disabled
+        WORD m_factor[4];       // The tint multipliers for blue, green, red and unused
+        WORD m_offset[4];       // The tint offsets for blue, green, red and unused
+    };
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+
+    /////////////////////////////////////////////////
+    // Definitions for the CPixelOperation class
+    //
+
+    // Constructor. The rows of a 32 bit DIB aren't padded, so each row
+    // is width * 4 bytes long. A view of part of a DIB has a larger stride.
+    inline CPixelOperation::CPixelOperation(Operation operation, BYTE* pBits, int width, int height, int stride /*= 0*/)
+        : m_operation(operation), m_pBits(pBits), m_width(width), m_height(height),
+          m_stride(stride ? stride : width * 4), m_simd(GetSupportedSIMD()), m_mask(0)
+    {
+        assert(pBits);
+        SetTint(0, 0, 0);
+    }
+
+    // Determines the instruction sets supported by the processor and
+    // the operating system.
+    inline PixelSIMD CPixelOperation::DetectSIMD()
+    {
+        PixelSIMD simd = PIXEL_SCALAR;
+
+#ifdef WXX_PIXEL_SSE2
+        int info[4] = { 0, 0, 0, 0 };
+  #ifdef _MSC_VER
+        __cpuid(info, 1);
+  #else
+        __cpuid(1, info[0], info[1], info[2], info[3]);
+  #endif
+        if (info[3] & (1 << 26))
+            simd = PIXEL_SSE2;
+
+  #ifdef WXX_PIXEL_AVX2
+        // AVX2 requires the operating system to save the YMM registers.
+        const int osxsave = 1 << 27;
+        const int avx = 1 << 28;
+        if ((simd == PIXEL_SSE2) && (info[2] & osxsave) && (info[2] & avx))
+        {
+    #ifdef _MSC_VER
+            unsigned int xcr0 = static_cast<unsigned int>(_xgetbv(0));
+    #else
+            unsigned int xcr0, xcr0High;
+            __asm__ __volatile__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0High) : "c" (0));
+    #endif
+            if ((xcr0 & 6) == 6)
+            {
+    #ifdef _MSC_VER
+                __cpuid(info, 0);
+                int maxLeaf = info[0];
+                if (maxLeaf >= 7)
+                    __cpuidex(info, 7, 0);
+    #else
+                int maxLeaf = static_cast<int>(__get_cpuid_max(0, 0));
+                if (maxLeaf >= 7)
+                    __cpuid_count(7, 0, info[0], info[1], info[2], info[3]);
+    #endif
+                if ((maxLeaf >= 7) && (info[1] & (1 << 5)))
+                    simd = PIXEL_AVX2;
+            }
+        }
+  #endif // WXX_PIXEL_AVX2
+#endif // WXX_PIXEL_SSE2
+
+        return simd;
+    }
+
+    // Returns the fastest instruction set supported by this computer.
+    inline PixelSIMD CPixelOperation::GetSupportedSIMD()
+    {
+        static LONG simd = -1;
+        if (simd < 0)
+            ::InterlockedExchange(&simd, DetectSIMD());
+
+        return static_cast<PixelSIMD>(simd);
+    }
+
+    // Applies the operation to all the rows. Large images are divided
+    // into bands of rows that are processed in parallel.
+    inline void CPixelOperation::Process()
+    {
+        if (m_width <= 0 || m_height <= 0)
+            return;
+
+        // The pixel count of a very large image can overflow an int.
+        if (LONGLONG(m_width) * m_height < WXX_PARALLEL_PIXELS)
+        {
+            ProcessRows(0, m_height);
+        }
+        else
+        {
+            int bandRows = MAX(1, WXX_PIXELS_PER_BAND / m_width);
+            GetThreadPool().ParallelFor(0, m_height, StaticRowsProc, this, bandRows);
+        }
+    }
+
+    // Applies the operation to the rows from first up to, but not including, last.
+    inline void CPixelOperation::ProcessRows(int first, int last) const
+    {
+        for (int row = first; row < last; ++row)
+        {
+            BYTE* pRow = m_pBits + ptrdiff_t(row) * m_stride;
+
+            // The SIMD versions return the number of pixels they processed.
+            // The scalar versions process the remaining pixels in the row.
+            int done = 0;
+            switch (m_operation)
+            {
+            case GRAYSCALE:
+#ifdef WXX_PIXEL_AVX2
+                if (m_simd == PIXEL_AVX2)  done = GrayScaleRowAVX2(pRow);
+#endif
+#ifdef WXX_PIXEL_SSE2
+                if (m_simd == PIXEL_SSE2)  done = GrayScaleRowSSE2(pRow);
+#endif
+                GrayScaleRowScalar(pRow, done);
+                break;
+
+            case TINT:
+#ifdef WXX_PIXEL_AVX2
+                if (m_simd == PIXEL_AVX2)  done = TintRowAVX2(pRow);
+#endif
+#ifdef WXX_PIXEL_SSE2
+                if (m_simd == PIXEL_SSE2)  done = TintRowSSE2(pRow);
+#endif
+                TintRowScalar(pRow, done);
+                break;
+
+            case DISABLED:
+#ifdef WXX_PIXEL_AVX2
+                if (m_simd == PIXEL_AVX2)  done = DisabledRowAVX2(pRow);
+#endif
+#ifdef WXX_PIXEL_SSE2
+                if (m_simd == PIXEL_SSE2)  done = DisabledRowSSE2(pRow);
+#endif
+                DisabledRowScalar(pRow, done);
+                break;
+            }
+        }
+    }
+
+    // Sets the instruction set used. Instruction sets not supported
+    // by this computer are replaced by the fastest supported one.
+    inline void CPixelOperation::SetSIMD(PixelSIMD simd)
+    {
+        PixelSIMD supported = GetSupportedSIMD();
+        m_simd = (simd < supported) ? simd : supported;
+    }
+
+    // Sets the color correction values used by the TINT operation. The values
+    // range from -255 to +255. A positive value moves the color towards 255,
+    // and a negative value moves it towards 0. Each color becomes:
+    //  positive tint:  tint + ((color * (256 - tint)) >> 8)
+    //  negative tint:  (color * (256 + tint)) >> 8
+    inline void CPixelOperation::SetTint(int red, int green, int blue)
+    {
+        int tint[3] = { blue, green, red };
+        for (int i = 0; i < 3; ++i)
+        {
+            int value = MAX(-255, MIN(tint[i], 255));
+            m_factor[i] = static_cast<WORD>((value > 0) ? 256 - value : 256 + value);
+            m_offset[i] = static_cast<WORD>(MAX(value, 0));
+        }
+
+        // The unused byte is multiplied by 1.
+        m_factor[3] = 256;
+        m_offset[3] = 0;
+    }
+
+    // Called by the thread pool to process a band of rows.
+    inline void WINAPI CPixelOperation::StaticRowsProc(int first, int last, LPVOID pOperation)
+    {
+        static_cast<CPixelOperation*>(pOperation)->ProcessRows(first, last);
+    }
+
+    ////////////////////////////
+    // Scalar versions.
+    // These process the pixels of a row, starting at the specified pixel.
+    //
+
+    // Pixels with a color matching the mask aren't converted. As in earlier
+    // versions of Win32++, the blue byte is compared to the red value of the
+    // mask, and the red byte to the blue value.
+    inline void CPixelOperation::DisabledRowScalar(BYTE* pRow, int pixel) const
+    {
+        for (BYTE* p = pRow + pixel * 4; pixel < m_width; ++pixel, p += 4)
+        {
+            if ((p[0] != GetRValue(m_mask)) &&
+                (p[1] != GetGValue(m_mask)) &&
+                (p[2] != GetBValue(m_mask)))
+            {
+                BYTE gray = static_cast<BYTE>(95 + (p[2] * 3 + p[1] * 6 + p[0]) / 20);
+                p[0] = gray;
+                p[1] = gray;
+                p[2] = gray;
+            }
+        }
+    }
+
+    inline void CPixelOperation::GrayScaleRowScalar(BYTE* pRow, int pixel) const
+    {
+        for (BYTE* p = pRow + pixel * 4; pixel < m_width; ++pixel, p += 4)
+        {
+            BYTE gray = static_cast<BYTE>((p[0] + p[1] * 6 + p[2] * 3) / 10);
+            p[0] = gray;
+            p[1] = gray;
+            p[2] = gray;
+        }
+    }
+
+    inline void CPixelOperation::TintRowScalar(BYTE* pRow, int pixel) const
+    {
+        for (BYTE* p = pRow + pixel * 4; pixel < m_width; ++pixel, p += 4)
+        {
+            p[0] = static_cast<BYTE>(m_offset[0] + ((p[0] * m_factor[0]) >> 8));
+            p[1] = static_cast<BYTE>(m_offset[1] + ((p[1] * m_factor[1]) >> 8));
+            p[2] = static_cast<BYTE>(m_offset[2] + ((p[2] * m_factor[2]) >> 8));
+        }
+    }
+
+#ifdef WXX_PIXEL_SSE2
+
+    ////////////////////////////
+    // SSE2 versions.
+    // These process 4 pixels at a time, and return the number of pixels
+    // processed. The sum b + 6g + 3r is at most 2550, so dividing by 10
+    // is the same as multiplying by 6554 and keeping the high 16 bits.
+    // Likewise dividing by 20 is the same as multiplying by 3277.
+    //
+
+    inline int CPixelOperation::DisabledRowSSE2(BYTE* pRow) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i weights = _mm_set_epi16(0, 3, 6, 1, 0, 3, 6, 1);
+        const __m128i divide = _mm_set1_epi16(3277);
+        const __m128i lighten = _mm_set1_epi16(95);
+        const __m128i colors = _mm_set1_epi32(0x00FFFFFF);
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(m_mask & 0x00FFFFFF));
+
+        int pixel = 0;
+        for (; pixel + 4 <= m_width; pixel += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(pRow + pixel * 4);
+            __m128i v = _mm_loadu_si128(p);
+
+            // Sum b + 6g + 3r for each pixel.
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+            hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m128i gray = _mm_add_epi16(_mm_mulhi_epu16(_mm_packs_epi32(lo, hi), divide), lighten);
+
+            // Copy each pixel's gray value to its blue, green and red bytes.
+            gray = _mm_packus_epi16(gray, gray);
+            gray = _mm_unpacklo_epi8(gray, gray);
+
+            // Only convert the pixels with no byte matching the mask.
+            __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(v, mask), colors);
+            __m128i convert = _mm_and_si128(_mm_cmpeq_epi32(matches, zero), colors);
+            v = _mm_or_si128(_mm_and_si128(gray, convert), _mm_andnot_si128(convert, v));
+            _mm_storeu_si128(p, v);
+        }
+
+        return pixel;
+    }
+
+    inline int CPixelOperation::GrayScaleRowSSE2(BYTE* pRow) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i weights = _mm_set_epi16(0, 3, 6, 1, 0, 3, 6, 1);
+        const __m128i divide = _mm_set1_epi16(6554);
+        const __m128i colors = _mm_set1_epi32(0x00FFFFFF);
+
+        int pixel = 0;
+        for (; pixel + 4 <= m_width; pixel += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(pRow + pixel * 4);
+            __m128i v = _mm_loadu_si128(p);
+
+            // Sum b + 6g + 3r for each pixel.
+            __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+            __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+            hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m128i gray = _mm_mulhi_epu16(_mm_packs_epi32(lo, hi), divide);
+
+            // Copy each pixel's gray value to its blue, green and red bytes.
+            gray = _mm_packus_epi16(gray, gray);
+            gray = _mm_unpacklo_epi8(gray, gray);
+            v = _mm_or_si128(_mm_and_si128(gray, colors), _mm_andnot_si128(colors, v));
+            _mm_storeu_si128(p, v);
+        }
+
+        return pixel;
+    }
+
+    inline int CPixelOperation::TintRowSSE2(BYTE* pRow) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i factor = _mm_set_epi16(m_factor[3], m_factor[2], m_factor[1], m_factor[0],
+                                             m_factor[3], m_factor[2], m_factor[1], m_factor[0]);
+        const __m128i offset = _mm_set_epi16(m_offset[3], m_offset[2], m_offset[1], m_offset[0],
+                                             m_offset[3], m_offset[2], m_offset[1], m_offset[0]);
+
+        int pixel = 0;
+        for (; pixel + 4 <= m_width; pixel += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(pRow + pixel * 4);
+            __m128i v = _mm_loadu_si128(p);
+
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(lo, factor), 8), offset);
+            hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(hi, factor), 8), offset);
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+
+        return pixel;
+    }
+
+#endif // WXX_PIXEL_SSE2
+
+#ifdef WXX_PIXEL_AVX2
+
+    ////////////////////////////
+    // AVX2 versions.
+    // These process 8 pixels at a time in the same way as the SSE2
+    // versions, and return the number of pixels processed. The AVX2
+    // instructions used operate on each 128 bit half separately.
+    //
+
+    inline int CPixelOperation::DisabledRowAVX2(BYTE* pRow) const
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i weights = _mm256_set_epi16(0, 3, 6, 1, 0, 3, 6, 1, 0, 3, 6, 1, 0, 3, 6, 1);
+        const __m256i divide = _mm256_set1_epi16(3277);
+        const __m256i lighten = _mm256_set1_epi16(95);
+        const __m256i colors = _mm256_set1_epi32(0x00FFFFFF);
+        const __m256i mask = _mm256_set1_epi32(static_cast<int>(m_mask & 0x00FFFFFF));
+
+        int pixel = 0;
+        for (; pixel + 8 <= m_width; pixel += 8)
+        {
+            __m256i* p = reinterpret_cast<__m256i*>(pRow + pixel * 4);
+            __m256i v = _mm256_loadu_si256(p);
+
+            __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), weights);
+            __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), weights);
+            lo = _mm256_add_epi32(lo, _mm256_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+            hi = _mm256_add_epi32(hi, _mm256_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m256i gray = _mm256_add_epi16(_mm256_mulhi_epu16(_mm256_packs_epi32(lo, hi), divide), lighten);
+            gray = _mm256_packus_epi16(gray, gray);
+            gray = _mm256_unpacklo_epi8(gray, gray);
+
+            __m256i matches = _mm256_and_si256(_mm256_cmpeq_epi8(v, mask), colors);
+            __m256i convert = _mm256_and_si256(_mm256_cmpeq_epi32(matches, zero), colors);
+            v = _mm256_or_si256(_mm256_and_si256(gray, convert), _mm256_andnot_si256(convert, v));
+            _mm256_storeu_si256(p, v);
+        }
+
+        return pixel;
+    }
+
+    inline int CPixelOperation::GrayScaleRowAVX2(BYTE* pRow) const
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i weights = _mm256_set_epi16(0, 3, 6, 1, 0, 3, 6, 1, 0, 3, 6, 1, 0, 3, 6, 1);
+        const __m256i divide = _mm256_set1_epi16(6554);
+        const __m256i colors = _mm256_set1_epi32(0x00FFFFFF);
+
+        int pixel = 0;
+        for (; pixel + 8 <= m_width; pixel += 8)
+        {
+            __m256i* p = reinterpret_cast<__m256i*>(pRow + pixel * 4);
+            __m256i v = _mm256_loadu_si256(p);
+
+            __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), weights);
+            __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), weights);
+            lo = _mm256_add_epi32(lo, _mm256_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+            hi = _mm256_add_epi32(hi, _mm256_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m256i gray = _mm256_mulhi_epu16(_mm256_packs_epi32(lo, hi), divide);
+            gray = _mm256_packus_epi16(gray, gray);
+            gray = _mm256_unpacklo_epi8(gray, gray);
+            v = _mm256_or_si256(_mm256_and_si256(gray, colors), _mm256_andnot_si256(colors, v));
+            _mm256_storeu_si256(p, v);
+        }
+
+        return pixel;
+    }
+
+    inline int CPixelOperation::TintRowAVX2(BYTE* pRow) const
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i factor = _mm256_set_epi16(m_factor[3], m_factor[2], m_factor[1], m_factor[0],
+                                                m_factor[3], m_factor[2], m_factor[1], m_factor[0],
+                                                m_factor[3], m_factor[2], m_factor[1], m_factor[0],
+                                                m_factor[3], m_factor[2], m_factor[1], m_factor[0]);
+        const __m256i offset = _mm256_set_epi16(m_offset[3], m_offset[2], m_offset[1], m_offset[0],
+                                                m_offset[3], m_offset[2], m_offset[1], m_offset[0],
+                                                m_offset[3], m_offset[2], m_offset[1], m_offset[0],
+                                                m_offset[3], m_offset[2], m_offset[1], m_offset[0]);
+
+        int pixel = 0;
+        for (; pixel + 8 <= m_width; pixel += 8)
+        {
+            __m256i* p = reinterpret_cast<__m256i*>(pRow + pixel * 4);
+            __m256i v = _mm256_loadu_si256(p);
+
+            __m256i lo = _mm256_unpacklo_epi8(v, zero);
+            __m256i hi = _mm256_unpackhi_epi8(v, zero);
+            lo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(lo, factor), 8), offset);
+            hi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(hi, factor), 8), offset);
+            _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+        }
+
+        return pixel;
+    }
+
+#endif // WXX_PIXEL_AVX2
+
+}
+
+#endif // _WIN32XX_PIXELS_H_
@@ -46,6 +46,7 @@
 #include "wxx_wincore.h"
 #include "wxx_dialog.h"
 #include "wxx_printdialogs.h"
+#include "wxx_resampler.h"
 #include "default_resource.h"
 
 /////////////////////////////////////////////////////////////////////////////
@@ -131,7 +132,7 @@ namespace Win32xx
         virtual ~CPreviewPane() {}
 
         void Render(CDC& dc);
-        void SetBitmap(CBitmap bitmap) { m_bitmap = bitmap; }
+        void SetBitmap(CBitmap bitmap);
 
     protected:
         virtual void OnDraw(CDC& dc);
@@ -141,7 +142,7 @@ namespace Win32xx
     private:
         CPreviewPane(const CPreviewPane&);               // Disable copy construction
         CPreviewPane& operator = (const CPreviewPane&);  // Disable assignment operator
-        CBitmap m_bitmap;
+        CScaledImage m_image;   // The page image, and a copy scaled to fit the pane
     };
 
 
@@ -260,13 +261,15 @@ namespace Win32xx
         return 0;
     }
 
-    // Copies the bitmap (m_Bitmap) to the PreviewPane as a Device
-    // Independent Bitmap (DIB), scaling the image to fit the window.
+    // Copies the page image to the PreviewPane, scaling the image to fit
+    // the window. The image is scaled with a Lanczos filter, which keeps
+    // small text readable. The scaled copy is kept, so the image is only
+    // scaled again when the size of the pane changes.
     inline void CPreviewPane::Render(CDC& dc)
     {
-        if (m_bitmap.GetHandle())
+        if (m_image.GetSource().GetHandle())
         {
-            BITMAP bm = m_bitmap.GetBitmapData();
+            BITMAP bm = m_image.GetSource().GetBitmapData();
             int border = 10;
             CRect rcClient = GetClientRect();
 
@@ -293,25 +296,14 @@ namespace Win32xx
                 xBorder = (rcClient.Width() - previewWidth) / 2;
             }
 
-            // Create the LPBITMAPINFO from the bitmap.
-            CBitmapInfoPtr pbmi(m_bitmap);
-            BITMAPINFOHEADER* pBIH = reinterpret_cast<BITMAPINFOHEADER*>(pbmi.get());
-
-            // Extract the device independent image data.
-            CMemDC memDC(dc);
-            UINT scanLines = static_cast<UINT>(bm.bmHeight);
-            memDC.GetDIBits(m_bitmap, 0, scanLines, NULL, pbmi, DIB_RGB_COLORS);
-            std::vector<byte> byteArray(pBIH->biSizeImage, 0);
-            byte* pByteArray = &byteArray.front();
-            memDC.GetDIBits(m_bitmap, 0, scanLines, pByteArray, pbmi, DIB_RGB_COLORS);
-
-            // Use half tone stretch mode for smoother rendering.
-            dc.SetStretchBltMode(HALFTONE);
-            dc.SetBrushOrgEx(0, 0);
-
-            // Copy the DIB bitmap data to the PreviewPane's DC with stretching.
-            dc.StretchDIBits(xBorder, yBorder, previewWidth, previewHeight, 0, 0,
-                   bm.bmWidth, bm.bmHeight, pByteArray, pbmi, DIB_RGB_COLORS, SRCCOPY);
+            if (previewWidth > 0 && previewHeight > 0)
+            {
+                // Select the scaled image into a memory DC and copy it to the
+                // PreviewPane's DC. No stretching is required.
+                CMemDC memDC(dc);
+                memDC.SelectObject(m_image.GetImage(previewWidth, previewHeight));
+                dc.BitBlt(xBorder, yBorder, previewWidth, previewHeight, memDC, 0, 0, SRCCOPY);
+            }
 
             // Draw a gray border around the preview.
             CRect rcFill(0, 0, xBorder, previewHeight + yBorder);
@@ -328,6 +320,24 @@ namespace Win32xx
         }
     }
 
+    // Sets the bitmap displayed by the preview pane. A 32 bit DIB section,
+    // such as a CDIBSection, is used directly. Other bitmaps are copied to a
+    // DIB section once, so the pixels aren't copied each time the pane is
+    // drawn. The bitmap must not be selected into a device context.
+    inline void CPreviewPane::SetBitmap(CBitmap bitmap)
+    {
+        CDIBSection image;
+        if (bitmap.GetHandle() != 0)
+        {
+            if (!CDIBView(bitmap).IsEmpty())
+                image = CDIBSection(bitmap);
+            else
+                image.CreateCopy(bitmap);
+        }
+
+        m_image.SetSource(image);
+    }
+
     ///////////////////////////////////////////
     // Definitions for the CPrintPreview class
     //
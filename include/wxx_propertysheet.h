@@ -527,6 +527,8 @@ namespace Win32xx
         m_psh.hwndParent       = parent;
         m_psh.hInstance        = GetApp()->GetInstanceHandle();
         m_psh.pfnCallback      = (PFNPROPSHEETCALLBACK)CPropertySheet::Callback;
+
+        EnablePreTranslate();
     }
 
     inline CPropertySheet::CPropertySheet(LPCTSTR caption /*= NULL*/, HWND parent /* = 0*/)
@@ -543,6 +545,8 @@ namespace Win32xx
         m_psh.hwndParent       = parent;
         m_psh.hInstance        = GetApp()->GetInstanceHandle();
         m_psh.pfnCallback      = (PFNPROPSHEETCALLBACK)CPropertySheet::Callback;
+
+        EnablePreTranslate();
     }
 
     // Adds a Property Page to the Property Sheet.
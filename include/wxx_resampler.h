@@ -0,0 +1,616 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// wxx_resampler.h
+//  This file contains the declarations and definitions of the CResampler
+//  and CScaledImage classes. CResampler scales the pixels of a 32 bit
+//  image with a box, bilinear or Lanczos-3 filter. It scales the rows
+//  and then the columns in two separate passes, using SSE2 instructions
+//  when the processor supports them. Large images are divided into
+//  bands of rows which are processed in parallel by the thread pool.
+//
+//  CScaledImage keeps a copy of an image scaled to the size it was last
+//  drawn at. The image is only scaled again when the size changes, so
+//  repainting a window at the same size is as fast as a BitBlt.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+void CView::SetPhoto(const CDIBSection& photo)
+{
+    m_photo.SetSource(photo);   // m_photo is a CScaledImage
+    Invalidate();
+}
+
+void CView::OnDraw(CDC& dc)
+{
+    CRect rc = GetClientRect();
+    if (!m_photo.GetSource().GetHandle() || rc.IsRectEmpty())
+        return;
+
+    CMemDC memDC(dc);
+    memDC.SelectObject(m_photo.GetImage(rc.Width(), rc.Height()));
+    dc.BitBlt(0, 0, rc.Width(), rc.Height(), memDC, 0, 0, SRCCOPY);
+}
+
+*/
+
+
+#ifndef _WIN32XX_RESAMPLER_H_
+#define _WIN32XX_RESAMPLER_H_
+
+#include "wxx_wincore.h"
+#include "wxx_gdi.h"
+#include "wxx_pixels.h"
+#include <cmath>
+
+
+namespace Win32xx
+{
+    // The filters used to resample images.
+    enum ResampleFilter
+    {
+        RESAMPLE_BOX,       // Averages the pixels covered by each output pixel
+        RESAMPLE_BILINEAR,  // Linear interpolation
+        RESAMPLE_LANCZOS3   // Sharpest, using a windowed sinc with 3 lobes
+    };
+
+
+    //////////////////////////////////////////////////////////////////
+    // CResampler scales a 32 bit image to a different size. Each
+    // output pixel is a weighted sum of the nearby input pixels. The
+    // weights are stored as 14 bit fixed point numbers, so the SSE2
+    // and scalar versions produce exactly the same pixels.
+    class CResampler
+    {
+    public:
+        CResampler(ResampleFilter filter = RESAMPLE_LANCZOS3);
+        virtual ~CResampler() {}
+
+        ResampleFilter GetFilter() const    { return m_filter; }
+        PixelSIMD GetSIMD() const           { return m_simd; }
+        void Resample(const CDIBView& source, const CDIBView& dest);
+        void SetFilter(ResampleFilter filter) { m_filter = filter; }
+        void SetSIMD(PixelSIMD simd);
+
+    private:
+        // The input pixels that contribute to an output pixel.
+        struct Contributor
+        {
+            int first;          // The first input pixel
+            int count;          // The number of input pixels
+            size_t offset;      // The position of the first weight in the weights vector
+        };
+
+        // The weights used to scale one dimension of the image.
+        struct Weights
+        {
+            std::vector<Contributor> contributors;  // One for each output pixel
+            std::vector<short> weights;             // Weights that add up to 1 << 14
+        };
+
+        CResampler(const CResampler&);                // Disable copy construction
+        CResampler& operator = (const CResampler&);   // Disable assignment operator
+
+        void   CalcWeights(int sourceSize, int destSize, Weights& weights) const;
+        double Filter(double x) const;
+        double GetRadius() const;
+        void   HorizontalRows(int first, int last) const;
+        void   VerticalRows(int first, int last) const;
+
+        static void WINAPI StaticHorizontalProc(int first, int last, LPVOID pResampler);
+        static void WINAPI StaticVerticalProc(int first, int last, LPVOID pResampler);
+
+#ifdef WXX_PIXEL_SSE2
+        static int PackWeights(short first, short second);
+        WXX_TARGET_SSE2 void HorizontalRowSSE2(const BYTE* pSource, BYTE* pDest) const;
+        WXX_TARGET_SSE2 int  VerticalRowSSE2(const Contributor& contributor, BYTE* pDest) const;
+#endif
+
+        ResampleFilter m_filter;    // The filter used to calculate the weights
+        PixelSIMD m_simd;           // The instruction set used
+
+        // The state of the current call to Resample.
+        CDIBView m_horzSource;      // The input of the horizontal pass
+        CDIBView m_horzDest;        // The output of the horizontal pass
+        CDIBView m_vertSource;      // The input of the vertical pass
+        CDIBView m_vertDest;        // The output of the vertical pass
+        Weights m_horzWeights;      // The weights for each output column
+        Weights m_vertWeights;      // The weights for each output row
+        std::vector<BYTE> m_temp;   // The pixels scaled horizontally, but not vertically
+    };
+
+
+    //////////////////////////////////////////////////////////////////
+    // CScaledImage keeps a copy of a source image scaled to a size.
+    // GetImage returns the scaled copy, and only scales the source
+    // again when the size, source or filter changes. Call Invalidate
+    // after modifying the source's pixels.
+    class CScaledImage
+    {
+    public:
+        CScaledImage(ResampleFilter filter = RESAMPLE_LANCZOS3);
+        virtual ~CScaledImage() {}
+
+        ResampleFilter GetFilter() const        { return m_resampler.GetFilter(); }
+        const CDIBSection& GetImage(int width, int height);
+        const CDIBSection& GetSource() const    { return m_source; }
+        void Invalidate()                       { m_isValid = FALSE; }
+        void SetFilter(ResampleFilter filter);
+        void SetSource(const CDIBSection& source);
+
+    private:
+        CScaledImage(const CScaledImage&);                // Disable copy construction
+        CScaledImage& operator = (const CScaledImage&);   // Disable assignment operator
+
+        CResampler m_resampler;
+        CDIBSection m_source;       // The full size image
+        CDIBSection m_scaled;       // The scaled image
+        BOOL m_isValid;             // TRUE when m_scaled is up to date
+    };
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+    // The number of fractional bits in the fixed point weights.
+    const int WXX_RESAMPLE_BITS = 14;
+
+
+    /////////////////////////////////////////////
+    // Definitions for the CResampler class
+    //
+
+    inline CResampler::CResampler(ResampleFilter filter /*= RESAMPLE_LANCZOS3*/)
+        : m_filter(filter), m_simd(CPixelOperation::GetSupportedSIMD())
+    {
+    }
+
+    // Calculates the weights of the input pixels for each output pixel.
+    // When shrinking, the filter is widened to cover all the input pixels.
+    inline void CResampler::CalcWeights(int sourceSize, int destSize, Weights& weights) const
+    {
+        const double scale = double(sourceSize) / double(destSize);
+        const double filterScale = MAX(scale, 1.0);
+        const double support = GetRadius() * filterScale;
+        const int one = 1 << WXX_RESAMPLE_BITS;
+
+        weights.contributors.resize(destSize);
+        weights.weights.clear();
+        std::vector<double> values;
+
+        for (int i = 0; i < destSize; ++i)
+        {
+            double center = (i + 0.5) * scale;
+            int first = MAX(0, static_cast<int>(floor(center - support + 0.5)));
+            int last = MIN(sourceSize, static_cast<int>(floor(center + support + 0.5)));
+            if (last <= first)
+            {
+                first = MIN(static_cast<int>(center), sourceSize - 1);
+                last = first + 1;
+            }
+
+            values.assign(size_t(last - first), 0.0);
+            double total = 0.0;
+            for (int j = first; j < last; ++j)
+            {
+                values[size_t(j - first)] = Filter((j + 0.5 - center) / filterScale);
+                total += values[size_t(j - first)];
+            }
+
+            // Use the nearest pixel if no pixel has a weight.
+            if (total == 0.0)
+            {
+                first = MIN(static_cast<int>(center), sourceSize - 1);
+                values.assign(1, 1.0);
+                total = 1.0;
+            }
+
+            Contributor& contributor = weights.contributors[size_t(i)];
+            contributor.first = first;
+            contributor.count = static_cast<int>(values.size());
+            contributor.offset = weights.weights.size();
+
+            // Round the weights, then add the rounding error to the largest
+            // weight so they add up to exactly one.
+            int sum = 0;
+            size_t largest = contributor.offset;
+            for (size_t k = 0; k < values.size(); ++k)
+            {
+                int weight = static_cast<int>(floor(values[k] / total * one + 0.5));
+                weights.weights.push_back(static_cast<short>(weight));
+                sum += weight;
+                if (abs(weight) > abs(weights.weights[largest]))
+                    largest = weights.weights.size() - 1;
+            }
+
+            weights.weights[largest] = static_cast<short>(weights.weights[largest] + one - sum);
+        }
+    }
+
+    // Returns the filter's weight for an input pixel at a distance of x
+    // output pixels.
+    inline double CResampler::Filter(double x) const
+    {
+        const double pi = 3.14159265358979323846;
+        switch (m_filter)
+        {
+        case RESAMPLE_BOX:
+            return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+
+        case RESAMPLE_BILINEAR:
+            x = fabs(x);
+            return (x < 1.0) ? 1.0 - x : 0.0;
+
+        case RESAMPLE_LANCZOS3:
+            if (x == 0.0)
+                return 1.0;
+            if (x <= -3.0 || x >= 3.0)
+                return 0.0;
+            return 3.0 * sin(pi * x) * sin(pi * x / 3.0) / (pi * pi * x * x);
+        }
+
+        return 0.0;
+    }
+
+    // Returns the distance beyond which the filter's weights are zero.
+    inline double CResampler::GetRadius() const
+    {
+        switch (m_filter)
+        {
+        case RESAMPLE_BOX:       return 0.5;
+        case RESAMPLE_BILINEAR:  return 1.0;
+        case RESAMPLE_LANCZOS3:  return 3.0;
+        }
+
+        return 1.0;
+    }
+
+    // Scales the rows from first up to, but not including, last.
+    inline void CResampler::HorizontalRows(int first, int last) const
+    {
+        const int round = 1 << (WXX_RESAMPLE_BITS - 1);
+        for (int row = first; row < last; ++row)
+        {
+            const BYTE* pSource = reinterpret_cast<const BYTE*>(m_horzSource.GetRow(row));
+            BYTE* pDest = reinterpret_cast<BYTE*>(m_horzDest.GetRow(row));
+
+#ifdef WXX_PIXEL_SSE2
+            if (m_simd >= PIXEL_SSE2)
+            {
+                HorizontalRowSSE2(pSource, pDest);
+                continue;
+            }
+#endif
+
+            for (int x = 0; x < m_horzDest.GetWidth(); ++x)
+            {
+                const Contributor& c = m_horzWeights.contributors[size_t(x)];
+                const short* pWeights = &m_horzWeights.weights[c.offset];
+                const BYTE* p = pSource + c.first * 4;
+                int sum[4] = { 0, 0, 0, 0 };
+                for (int k = 0; k < c.count; ++k, p += 4)
+                {
+                    for (int channel = 0; channel < 4; ++channel)
+                        sum[channel] += p[channel] * pWeights[k];
+                }
+
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    int value = (sum[channel] + round) >> WXX_RESAMPLE_BITS;
+                    pDest[x * 4 + channel] = static_cast<BYTE>(MAX(0, MIN(value, 255)));
+                }
+            }
+        }
+    }
+
+    // Scales the source image to the size of the destination. The views
+    // must not overlap.
+    inline void CResampler::Resample(const CDIBView& source, const CDIBView& dest)
+    {
+        assert(!source.IsEmpty() && !dest.IsEmpty());
+        const int sourceWidth = source.GetWidth();
+        const int sourceHeight = source.GetHeight();
+        const int destWidth = dest.GetWidth();
+        const int destHeight = dest.GetHeight();
+
+        if (sourceWidth == destWidth && sourceHeight == destHeight)
+        {
+            for (int row = 0; row < destHeight; ++row)
+                memcpy(dest.GetRow(row), source.GetRow(row), size_t(destWidth) * 4);
+
+            return;
+        }
+
+        // Scale the rows into the temporary image, or directly into the
+        // destination if the height doesn't change.
+        m_horzSource = source;
+        m_vertDest = dest;
+        m_vertSource = source;
+        if (sourceWidth != destWidth)
+        {
+            if (sourceHeight == destHeight)
+                m_horzDest = dest;
+            else
+            {
+                m_temp.resize(size_t(destWidth) * size_t(sourceHeight) * 4);
+                m_horzDest = CDIBView(&m_temp[0], destWidth, sourceHeight, destWidth * 4);
+            }
+
+            CalcWeights(sourceWidth, destWidth, m_horzWeights);
+            if (LONGLONG(destWidth) * sourceHeight < WXX_PARALLEL_PIXELS)
+                HorizontalRows(0, sourceHeight);
+            else
+            {
+                int bandRows = MAX(1, WXX_PIXELS_PER_BAND / destWidth);
+                GetThreadPool().ParallelFor(0, sourceHeight, StaticHorizontalProc, this, bandRows);
+            }
+
+            m_vertSource = m_horzDest;
+        }
+
+        // Scale the columns.
+        if (sourceHeight != destHeight)
+        {
+            CalcWeights(sourceHeight, destHeight, m_vertWeights);
+            if (LONGLONG(destWidth) * destHeight < WXX_PARALLEL_PIXELS)
+                VerticalRows(0, destHeight);
+            else
+            {
+                int bandRows = MAX(1, WXX_PIXELS_PER_BAND / destWidth);
+                GetThreadPool().ParallelFor(0, destHeight, StaticVerticalProc, this, bandRows);
+            }
+        }
+    }
+
+    // Sets the instruction set used. Instruction sets not supported
+    // by this computer are replaced by the fastest supported one.
+    inline void CResampler::SetSIMD(PixelSIMD simd)
+    {
+        PixelSIMD supported = CPixelOperation::GetSupportedSIMD();
+        m_simd = (simd < supported) ? simd : supported;
+    }
+
+    // Called by the thread pool to scale a band of rows horizontally.
+    inline void WINAPI CResampler::StaticHorizontalProc(int first, int last, LPVOID pResampler)
+    {
+        static_cast<CResampler*>(pResampler)->HorizontalRows(first, last);
+    }
+
+    // Called by the thread pool to calculate a band of output rows.
+    inline void WINAPI CResampler::StaticVerticalProc(int first, int last, LPVOID pResampler)
+    {
+        static_cast<CResampler*>(pResampler)->VerticalRows(first, last);
+    }
+
+    // Calculates the output rows from first up to, but not including, last.
+    inline void CResampler::VerticalRows(int first, int last) const
+    {
+        const int round = 1 << (WXX_RESAMPLE_BITS - 1);
+        const int width = m_vertDest.GetWidth();
+        for (int row = first; row < last; ++row)
+        {
+            const Contributor& c = m_vertWeights.contributors[size_t(row)];
+            const short* pWeights = &m_vertWeights.weights[c.offset];
+            BYTE* pDest = reinterpret_cast<BYTE*>(m_vertDest.GetRow(row));
+
+            // The SSE2 version returns the number of pixels it calculated.
+            int x = 0;
+#ifdef WXX_PIXEL_SSE2
+            if (m_simd >= PIXEL_SSE2)
+                x = VerticalRowSSE2(c, pDest);
+#endif
+
+            for (int byte = x * 4; byte < width * 4; ++byte)
+            {
+                int sum = 0;
+                for (int k = 0; k < c.count; ++k)
+                {
+                    const BYTE* pSource = reinterpret_cast<const BYTE*>(m_vertSource.GetRow(c.first + k));
+                    sum += pSource[byte] * pWeights[k];
+                }
+
+                int value = (sum + round) >> WXX_RESAMPLE_BITS;
+                pDest[byte] = static_cast<BYTE>(MAX(0, MIN(value, 255)));
+            }
+        }
+    }
+
+#ifdef WXX_PIXEL_SSE2
+
+    ////////////////////////////
+    // SSE2 versions.
+    // _mm_madd_epi16 multiplies the channels of two pixels by their weights
+    // and adds the pairs of products, so two input pixels are processed
+    // with each instruction.
+    //
+
+    // Returns two 16 bit weights as the halves of a 32 bit integer.
+    inline int CResampler::PackWeights(short first, short second)
+    {
+        return static_cast<int>(static_cast<unsigned int>(static_cast<unsigned short>(first)) |
+                               (static_cast<unsigned int>(static_cast<unsigned short>(second)) << 16));
+    }
+
+    // Scales a row horizontally.
+    inline void CResampler::HorizontalRowSSE2(const BYTE* pSource, BYTE* pDest) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi32(1 << (WXX_RESAMPLE_BITS - 1));
+
+        for (int x = 0; x < m_horzDest.GetWidth(); ++x)
+        {
+            const Contributor& c = m_horzWeights.contributors[size_t(x)];
+            const short* pWeights = &m_horzWeights.weights[c.offset];
+            const BYTE* p = pSource + c.first * 4;
+            __m128i sum = round;
+
+            int k = 0;
+            for (; k + 1 < c.count; k += 2)
+            {
+                // Interleave the channels of the two pixels: b0 b1 g0 g1 r0 r1 a0 a1.
+                __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4));
+                pixels = _mm_unpacklo_epi8(pixels, _mm_srli_si128(pixels, 4));
+                pixels = _mm_unpacklo_epi8(pixels, zero);
+                __m128i weights = _mm_set1_epi32(PackWeights(pWeights[k], pWeights[k + 1]));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(pixels, weights));
+            }
+
+            if (k < c.count)
+            {
+                __m128i pixel = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(p + k * 4));
+                pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(pixel, zero), zero);
+                __m128i weight = _mm_set1_epi32(PackWeights(pWeights[k], 0));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(pixel, weight));
+            }
+
+            sum = _mm_srai_epi32(sum, WXX_RESAMPLE_BITS);
+            sum = _mm_packs_epi32(sum, sum);
+            sum = _mm_packus_epi16(sum, sum);
+            *reinterpret_cast<int*>(pDest + x * 4) = _mm_cvtsi128_si32(sum);
+        }
+    }
+
+    // Calculates 4 pixels at a time of an output row, and returns the
+    // number of pixels calculated.
+    inline int CResampler::VerticalRowSSE2(const Contributor& c, BYTE* pDest) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi32(1 << (WXX_RESAMPLE_BITS - 1));
+        const short* pWeights = &m_vertWeights.weights[c.offset];
+        const int width = m_vertDest.GetWidth();
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            // The sums of the blue, green, red and alpha channels of each pixel.
+            __m128i sum0 = round;
+            __m128i sum1 = round;
+            __m128i sum2 = round;
+            __m128i sum3 = round;
+
+            for (int k = 0; k < c.count; k += 2)
+            {
+                const BYTE* pRow0 = reinterpret_cast<const BYTE*>(m_vertSource.GetRow(c.first + k));
+                __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + x * 4));
+                __m128i row1 = zero;
+                short weight1 = 0;
+                if (k + 1 < c.count)
+                {
+                    const BYTE* pRow1 = reinterpret_cast<const BYTE*>(m_vertSource.GetRow(c.first + k + 1));
+                    row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + x * 4));
+                    weight1 = pWeights[k + 1];
+                }
+
+                // Interleave the bytes of the two rows, and multiply by the weights.
+                __m128i weights = _mm_set1_epi32(PackWeights(pWeights[k], weight1));
+                __m128i lo = _mm_unpacklo_epi8(row0, row1);
+                __m128i hi = _mm_unpackhi_epi8(row0, row1);
+                sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), weights));
+                sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), weights));
+                sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), weights));
+                sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), weights));
+            }
+
+            __m128i lo = _mm_packs_epi32(_mm_srai_epi32(sum0, WXX_RESAMPLE_BITS), _mm_srai_epi32(sum1, WXX_RESAMPLE_BITS));
+            __m128i hi = _mm_packs_epi32(_mm_srai_epi32(sum2, WXX_RESAMPLE_BITS), _mm_srai_epi32(sum3, WXX_RESAMPLE_BITS));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packus_epi16(lo, hi));
+        }
+
+        return x;
+    }
+
+#endif // WXX_PIXEL_SSE2
+
+
+    /////////////////////////////////////////////
+    // Definitions for the CScaledImage class
+    //
+
+    inline CScaledImage::CScaledImage(ResampleFilter filter /*= RESAMPLE_LANCZOS3*/)
+        : m_resampler(filter), m_isValid(FALSE)
+    {
+    }
+
+    // Returns the source image scaled to the specified size. The image
+    // is scaled when the size is different from the last call, or when
+    // the source or filter has changed.
+    inline const CDIBSection& CScaledImage::GetImage(int width, int height)
+    {
+        assert(m_source.GetHandle() != 0);
+        assert(width > 0 && height > 0);
+
+        CSize size = m_scaled.GetHandle() ? m_scaled.GetSize() : CSize(0, 0);
+        if (!m_isValid || size.cx != width || size.cy != height)
+        {
+            if (size.cx != width || size.cy != height)
+                m_scaled.Create(width, height);
+
+            m_resampler.Resample(m_source.GetView(), m_scaled.GetView());
+            m_isValid = TRUE;
+        }
+
+        return m_scaled;
+    }
+
+    // Sets the filter used to scale the image.
+    inline void CScaledImage::SetFilter(ResampleFilter filter)
+    {
+        if (filter != m_resampler.GetFilter())
+        {
+            m_resampler.SetFilter(filter);
+            m_isValid = FALSE;
+        }
+    }
+
+    // Sets the image to be scaled. The source is shared, not copied.
+    inline void CScaledImage::SetSource(const CDIBSection& source)
+    {
+        m_source = source;
+        m_isValid = FALSE;
+    }
+
+}
+
+#endif // _WIN32XX_RESAMPLER_H_
@@ -0,0 +1,287 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+
+
+///////////////////////////////////////////////////////
+// wxx_resourcemonitor.h
+//  This file contains the declaration and definition of the
+//  CResourceMonitor class. CResourceMonitor is a small window that
+//  stays on top of the application's other windows, and displays the
+//  snapshot returned by CWinApp::GetResourceSnapshot. The snapshot is
+//  refreshed at regular intervals.
+//
+//  For each type of resource, the monitor displays the number in
+//  existence, the largest number in existence at any one time, and
+//  the number created per second. A count that keeps rising reveals
+//  a leak, and a high creation rate reveals resources that are being
+//  created and destroyed repeatedly.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+// Displays the resource monitor when the debug menu item is chosen.
+// m_monitor is a CResourceMonitor member of CMainFrame.
+BOOL CMainFrame::OnResourceMonitor()
+{
+    if (!m_monitor.IsWindow())
+        m_monitor.Create(*this);
+
+    m_monitor.ShowWindow();
+    return TRUE;
+}
+
+*/
+
+
+#ifndef _WIN32XX_RESOURCEMONITOR_H_
+#define _WIN32XX_RESOURCEMONITOR_H_
+
+#include "wxx_wincore.h"
+
+
+namespace Win32xx
+{
+
+    ///////////////////////////////////////////////////////////////////
+    // CResourceMonitor displays the resources used by the application.
+    // It's a tool window owned by the window passed to Create.
+    class CResourceMonitor : public CWnd
+    {
+    public:
+        CResourceMonitor();
+        virtual ~CResourceMonitor() {}
+
+        UINT GetInterval() const { return m_interval; }
+        const ResourceSnapshot& GetSnapshot() const { return m_snapshot; }
+        void Refresh();
+        void SetInterval(UINT interval);
+
+    protected:
+        virtual int  OnCreate(CREATESTRUCT& cs);
+        virtual void OnDestroy();
+        virtual void OnDraw(CDC& dc);
+        virtual BOOL OnEraseBkgnd(CDC& dc);
+        virtual void PreCreate(CREATESTRUCT& cs);
+        virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
+
+    private:
+        CResourceMonitor(const CResourceMonitor&);              // Disable copy construction
+        CResourceMonitor& operator = (const CResourceMonitor&); // Disable assignment operator
+
+        std::vector<CString> GetLines() const;
+
+        enum { ID_REFRESH = 1, MARGIN = 6 };
+
+        ResourceSnapshot m_snapshot;    // The snapshot displayed
+        ResourceSnapshot m_previous;    // The previous snapshot, used for the creation rates
+        CFont m_font;                   // Fixed pitch font used for the text
+        UINT m_interval;                // Refresh interval in milliseconds
+    };
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+
+    ////////////////////////////////////////////////
+    // Definitions for the CResourceMonitor class
+    //
+
+    // Constructor. The snapshot is refreshed once a second by default.
+    inline CResourceMonitor::CResourceMonitor() : m_interval(1000)
+    {
+        ZeroMemory(&m_snapshot, sizeof(m_snapshot));
+        ZeroMemory(&m_previous, sizeof(m_previous));
+    }
+
+    // Returns the lines of text displayed by the monitor.
+    inline std::vector<CString> CResourceMonitor::GetLines() const
+    {
+        std::vector<CString> lines;
+        CString line;
+
+        line.Format(_T("%-12s %8s %8s"), _T("Handles"), _T("Count"), _T("Max"));
+        lines.push_back(line);
+        line.Format(_T("%-12s %8lu %8lu"), _T("gdi"), m_snapshot.gdiHandles, m_snapshot.maxGDIHandles);
+        lines.push_back(line);
+        line.Format(_T("%-12s %8lu %8lu"), _T("user"), m_snapshot.userHandles, m_snapshot.maxUserHandles);
+        lines.push_back(line);
+        lines.push_back(CString());
+
+        // The creation rate is measured since the previous snapshot. The
+        // unsigned subtraction allows for the totals wrapping around.
+        DWORD elapsed = m_snapshot.tickCount - m_previous.tickCount;
+        line.Format(_T("%-12s %8s %8s %10s"), _T("Resource"), _T("Count"), _T("Max"), _T("Created/s"));
+        lines.push_back(line);
+        for (int type = 0; type < RESOURCE_TYPES; ++type)
+        {
+            const ResourceCount& count = m_snapshot.resources[type];
+            DWORD created = count.created - m_previous.resources[type].created;
+            double rate = (elapsed > 0) ? (1000.0 * created) / elapsed : 0.0;
+            line.Format(_T("%-12s %8ld %8ld %10.1f"), GetApp()->GetResourceName(static_cast<ResourceType>(type)),
+                count.count, count.maxCount, rate);
+            lines.push_back(line);
+        }
+        lines.push_back(CString());
+
+        line.Format(_T("%-12s %8s %8s"), _T("Handle map"), _T("Entries"), _T("Max"));
+        lines.push_back(line);
+        for (int map = 0; map < HANDLEMAP_TYPES; ++map)
+        {
+            line.Format(_T("%-12s %8lu %8lu"), GetApp()->GetHandleMapName(static_cast<HandleMapType>(map)),
+                static_cast<unsigned long>(m_snapshot.mapSizes[map]),
+                static_cast<unsigned long>(m_snapshot.maxMapSizes[map]));
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+
+    // Called when the window is created. Takes the first snapshot, sizes
+    // the window to fit the text and starts the refresh timer.
+    inline int CResourceMonitor::OnCreate(CREATESTRUCT&)
+    {
+        m_font.CreatePointFont(90, _T("Courier New"));
+        m_snapshot = GetApp()->GetResourceSnapshot();
+        m_previous = m_snapshot;
+
+        CClientDC dc(*this);
+        dc.SelectObject(m_font);
+        CSize textSize;
+        std::vector<CString> lines = GetLines();
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            CSize lineSize = dc.GetTextExtentPoint32(lines[i] + _T(" "));
+            textSize.cx = MAX(textSize.cx, lineSize.cx);
+            textSize.cy += lineSize.cy;
+        }
+
+        CRect rc(0, 0, textSize.cx + 2 * MARGIN, textSize.cy + 2 * MARGIN);
+        VERIFY(::AdjustWindowRectEx(&rc, GetStyle(), FALSE, GetExStyle()));
+        SetWindowPos(0, 0, 0, rc.Width(), rc.Height(), SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+
+        SetTimer(ID_REFRESH, m_interval, NULL);
+        return 0;
+    }
+
+    // Called when the window is destroyed.
+    inline void CResourceMonitor::OnDestroy()
+    {
+        KillTimer(ID_REFRESH);
+    }
+
+    // Draws the snapshot. The text is drawn to a back buffer so it
+    // doesn't flicker when it's refreshed.
+    inline void CResourceMonitor::OnDraw(CDC& dc)
+    {
+        CRect rc = GetClientRect();
+        CBufferedDC bufferedDC(dc, rc);
+        bufferedDC.SolidFill(::GetSysColor(COLOR_WINDOW), rc);
+        bufferedDC.SelectObject(m_font);
+        bufferedDC.SetBkMode(TRANSPARENT);
+        bufferedDC.SetTextColor(::GetSysColor(COLOR_WINDOWTEXT));
+
+        int lineHeight = bufferedDC.GetTextExtentPoint32(_T("X")).cy;
+        std::vector<CString> lines = GetLines();
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            int y = MARGIN + static_cast<int>(i) * lineHeight;
+            bufferedDC.TextOut(MARGIN, y, lines[i], lines[i].GetLength());
+        }
+    }
+
+    // The background is drawn by OnDraw.
+    inline BOOL CResourceMonitor::OnEraseBkgnd(CDC&)
+    {
+        return TRUE;
+    }
+
+    // Sets the styles of the window before it's created.
+    inline void CResourceMonitor::PreCreate(CREATESTRUCT& cs)
+    {
+        cs.style = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_VISIBLE;
+        cs.dwExStyle = WS_EX_TOPMOST | WS_EX_TOOLWINDOW;
+        cs.lpszName = _T("Resources");
+        cs.x = CW_USEDEFAULT;
+        cs.y = CW_USEDEFAULT;
+    }
+
+    // Takes a new snapshot, and redraws the window.
+    inline void CResourceMonitor::Refresh()
+    {
+        m_previous = m_snapshot;
+        m_snapshot = GetApp()->GetResourceSnapshot();
+        if (IsWindow())
+            Invalidate();
+    }
+
+    // Sets the refresh interval in milliseconds.
+    inline void CResourceMonitor::SetInterval(UINT interval)
+    {
+        m_interval = interval;
+        if (IsWindow())
+            SetTimer(ID_REFRESH, m_interval, NULL);
+    }
+
+    // Processes the window's messages.
+    inline LRESULT CResourceMonitor::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
+    {
+        switch (msg)
+        {
+        case WM_TIMER:
+            if (wparam == ID_REFRESH)
+            {
+                Refresh();
+                return 0;
+            }
+            break;
+        }
+
+        return WndProcDefault(msg, wparam, lparam);
+    }
+
+}
+
+
+#endif // _WIN32XX_RESOURCEMONITOR_H_
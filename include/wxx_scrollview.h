@@ -48,6 +48,14 @@
 // The default scrolling background is white. Use the SetScrollBkgnd
 // to set a different brush color.
 //
+// By default, OnDraw draws the entire scrolling area to a memory DC the
+// size of the scrolling area each time the view is painted. Use
+// SetViewportBuffer(TRUE) for large scrolling areas. The view is then
+// painted with a CBufferedDC, which uses the thread's paint buffer. OnDraw
+// is called with a viewport origin that offsets the drawing by the
+// scroll position, and a clipping region limited to the area that needs
+// painting. Override OnDrawViewport to draw only that area.
+//
 /////////////////////////////////////////////////////////
 
 
@@ -90,15 +98,18 @@ namespace Win32xx
         CSize GetTotalScrollSize() const { return m_totalSize; }
         BOOL IsHScrollVisible() const    { return (GetStyle() &  WS_HSCROLL) != FALSE; }
         BOOL IsVScrollVisible() const    { return (GetStyle() &  WS_VSCROLL) != FALSE; }
+        BOOL IsViewportBuffer() const    { return m_isViewportBuffer; }
         void SetScrollPosition(POINT pt);
         void SetScrollSizes(CSize totalSize = CSize(0,0), CSize pageSize = CSize(0,0), CSize lineSize = CSize(0,0));
         void SetScrollBkgnd(CBrush bkgndBrush) { m_bkgndBrush = bkgndBrush; }
+        void SetViewportBuffer(BOOL isViewportBuffer);
 
     protected:
         virtual void    FillOutsideRect(CDC& dc, HBRUSH brush);
         virtual BOOL    OnEraseBkgnd(CDC& dc);
         virtual LRESULT OnHScroll(UINT msg, WPARAM wparam, LPARAM lparam);
         virtual LRESULT OnKeyScroll(UINT msg, WPARAM wparam, LPARAM lparam);
+        virtual void    OnDrawViewport(CDC& dc, const CRect& updateRect);
         virtual LRESULT OnMouseWheel(UINT msg, WPARAM wparam, LPARAM lparam);
         virtual LRESULT OnPaint(UINT msg, WPARAM wparam, LPARAM lparam);
         virtual LRESULT OnVScroll(UINT msg, WPARAM wparam, LPARAM lparam);
@@ -110,6 +121,7 @@ namespace Win32xx
     private:
         CScrollView(const CScrollView&);               // Disable copy construction
         CScrollView& operator = (const CScrollView&);  // Disable assignment operator
+        void PaintViewport(CDC& dc);
         void UpdateBars();
 
         CPoint m_currentPos;
@@ -117,6 +129,7 @@ namespace Win32xx
         CSize m_pageSize;
         CSize m_lineSize;
         CBrush m_bkgndBrush;
+        BOOL m_isViewportBuffer;    // TRUE if only the part of the view being painted is buffered
     };
 
 }
@@ -132,7 +145,7 @@ namespace Win32xx
     // Definitions for the CScrollView class
     //
 
-    inline CScrollView::CScrollView()
+    inline CScrollView::CScrollView() : m_isViewportBuffer(FALSE)
     {
         m_bkgndBrush.CreateSolidBrush(RGB(255, 255, 255));
     }
@@ -282,6 +295,17 @@ namespace Win32xx
         return 0;
     }
 
+    // Called when the view is painted and SetViewportBuffer has been set to
+    // TRUE. The updateRect is the part of the scrolling area that needs to
+    // be drawn. The DC's viewport origin and clipping region have already
+    // been set, so the drawing is done in scrolling area co-ordinates.
+    // Override this function to draw only the part of the scrolling area
+    // that needs to be drawn. By default, it calls OnDraw.
+    inline void CScrollView::OnDrawViewport(CDC& dc, const CRect&)
+    {
+        OnDraw(dc);
+    }
+
     // Overrides OnPaint and call OnDraw with a memory DC.
     inline LRESULT CScrollView::OnPaint(UINT msg, WPARAM wparam, LPARAM lparam)
     {
@@ -289,6 +313,12 @@ namespace Win32xx
         if (m_totalSize != CSize(0, 0))
         {
             CPaintDC dc(*this);
+            if (m_isViewportBuffer)
+            {
+                PaintViewport(dc);
+                return 0;
+            }
+
             CMemDC memDC(dc);
 
             // negative sizes are not allowed.
@@ -424,6 +454,32 @@ namespace Win32xx
         return FinalWindowProc(msg, wparam, lparam);
     }
 
+    // Draws the part of the view that needs painting with a CBufferedDC.
+    // When the view is scrolled, ScrollWindowEx moves the pixels already
+    // on the screen, so only the strip that's exposed is drawn.
+    inline void CScrollView::PaintViewport(CDC& dc)
+    {
+        CRect paintRect;
+        dc.GetClipBox(paintRect);
+        paintRect &= GetClientRect();
+        if (paintRect.IsRectEmpty())
+            return;
+
+        // Offset the drawing by the scroll position, and clip it to the part
+        // of the scrolling area that needs painting.
+        CBufferedDC memDC(dc, paintRect);
+        memDC.OffsetViewportOrgEx(-m_currentPos.x, -m_currentPos.y);
+        CRect updateRect = paintRect;
+        updateRect.OffsetRect(m_currentPos);
+        memDC.FillRect(updateRect, m_bkgndBrush);
+        updateRect &= CRect(CPoint(0, 0), m_totalSize);
+        if (!updateRect.IsRectEmpty())
+        {
+            memDC.IntersectClipRect(updateRect);
+            OnDrawViewport(memDC, updateRect);
+        }
+    }
+
     inline void CScrollView::PreCreate(CREATESTRUCT& cs)
     {
         // Set the Window Class name
@@ -470,6 +526,16 @@ namespace Win32xx
         UpdateBars();
     }
 
+    // Set to TRUE to only buffer the part of the view being painted, using
+    // the thread's paint buffer, rather than the entire scrolling area.
+    inline void CScrollView::SetViewportBuffer(BOOL isViewportBuffer)
+    {
+        m_isViewportBuffer = isViewportBuffer;
+
+        if (IsWindow())
+            Invalidate();
+    }
+
     // Updates the display state of the scrollbars and the scrollbar positions.
     // Also scrolls display view as required by window resizing.
     // Note: This function can be called recursively.
@@ -91,10 +91,14 @@
 #include <Shlwapi.h>
 
 #include <cassert>
+#include <cstddef>
 #include <vector>
 #include <algorithm>
+#include <list>
 #include <string>
+#include <utility>
 #include <map>
+#include <new>
 #include <sstream>
 #include <stdio.h>
 #include <stdarg.h>
@@ -128,6 +132,12 @@
   #define GCLP_WNDPROC       GCL_WNDPROC
 #endif
 
+// Required by compilers lacking the Windows 7 SDK.
+#ifndef GR_GDIOBJECTS_PEAK
+  #define GR_GDIOBJECTS_PEAK  2
+  #define GR_USEROBJECTS_PEAK 4
+#endif
+
 
 // Automatically include the Win32xx namespace.
 // define NO_USING_NAMESPACE to skip this step.
@@ -156,6 +166,28 @@ using namespace Win32xx;
 #define MAX(a,b)        (((a) > (b)) ? (a) : (b))
 #define MIN(a,b)        (((a) < (b)) ? (a) : (b))
 
+// A macro to support both old and new compilers.
+#if defined(__clang_major__) || (defined (_MSC_VER) && (_MSC_VER >= 1900)) // Clang or VS2015 and higher
+  #define WXX_NOEXCEPT noexcept
+#else
+  #define WXX_NOEXCEPT throw()
+#endif
+
+// Define WXX_MOVE_SEMANTICS for compilers that support rvalue references.
+#if (defined (_MSC_VER) && (_MSC_VER >= 1600)) || (__cplusplus >= 201103L) // VS2010 and higher, or C++11
+  #define WXX_MOVE_SEMANTICS
+#endif
+
+// Define WXX_VARIADIC_TEMPLATES for compilers that support variadic templates.
+#if (defined (_MSC_VER) && (_MSC_VER >= 1800)) || (__cplusplus >= 201103L) // VS2013 and higher, or C++11
+  #define WXX_VARIADIC_TEMPLATES
+#endif
+
+// Compilers prior to VS2013 don't define va_copy. Their va_list can be copied.
+#ifndef va_copy
+  #define va_copy(dest, src) ((dest) = (src))
+#endif
+
 // Version macro
 #define _WIN32XX_VER 0x0900     // Win32++ version 9.0.0
 
@@ -105,6 +105,7 @@
 #include <algorithm>        // For std::swap
 #include <WinSock2.h>       // must include before windows.h
 #include <Windows.h>        // For InterlockedIncrement and InterlockedDecrement
+#include "wxx_telemetry.h"   // For CResourceCounter
 
 #ifdef __BORLANDC__
   #pragma option -w-8027    // function not expanded inline
@@ -125,7 +126,11 @@ namespace Win32xx
         {
             try
             {
-                if (m_ptr) m_count = new long(0);
+                if (m_ptr)
+                {
+                    m_count = new long(0);
+                    CResourceCounter::Add(RESOURCE_SHARED_PTR);
+                }
                 inc_ref();
             }
             // catch the unlikely event of 'new long(0)' throwing an exception
@@ -144,6 +149,7 @@ namespace Win32xx
                 //  We would need delete[] m_ptr to handle that.
                 delete m_ptr;
                 delete m_count;
+                CResourceCounter::Remove(RESOURCE_SHARED_PTR);
             }
         }
 
@@ -1137,11 +1137,8 @@ namespace Win32xx
         isRTL = ((GetExStyle() & WS_EX_LAYOUTRTL)) != 0;
 #endif
 
-        // Create the memory DC and bitmap.
         CClientDC dcView(*this);
-        CMemDC memDC(dcView);
         CRect rcClient = GetClientRect();
-        memDC.CreateCompatibleBitmap(dcView, rcClient.Width(), rcClient.Height());
 
         if (GetItemCount() == 0)
         {
@@ -1150,6 +1147,9 @@ namespace Win32xx
             return;
         }
 
+        // Create the memory DC. It uses the thread's paint buffer.
+        CBufferedDC memDC(dcView, rcClient);
+
         // Create a clipping region. Its the overall tab window's region,
         //  less the region belonging to the individual tab view's client area.
         CRgn rgnSrc1;
@@ -1183,15 +1183,11 @@ namespace Win32xx
 
         // Now copy our from our memory DC to the window DC.
         dcView.SelectClipRgn(rgnClip);
+        memDC.Flush();
 
+        // BitBlt offset bitmap copies by one for Right-To-Left layout.
         if (isRTL)
-        {
-            // BitBlt offset bitmap copies by one for Right-To-Left layout.
             dcView.BitBlt(0, 0, 1, rcClient.Height(), memDC, 1, 0, SRCCOPY);
-            dcView.BitBlt(1, 0, rcClient.Width(), rcClient.Height(), memDC, 1, 0, SRCCOPY);
-        }
-        else
-            dcView.BitBlt(0, 0, rcClient.Width(), rcClient.Height(), memDC, 0, 0, SRCCOPY);
     }
 
     // Set the window style before it is created.
@@ -0,0 +1,218 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+
+
+///////////////////////////////////////////////////////
+// wxx_telemetry.h
+//  This file contains the counters used by the resource telemetry.
+//  The framework counts the GDI objects and device contexts owned by
+//  CGDIObject and CDC, the allocations of CDC_Data and CGDI_Data, and
+//  the reference counts allocated by Shared_Ptr. Each counter records
+//  the number created and destroyed, the number currently in existence,
+//  and the largest number in existence at any one time.
+//
+//  The GDI object and device context counts are managed-object counts.
+//  A handle is counted when a CGDIObject or CDC takes ownership of it,
+//  such as when it's created with one of their Create functions. It stops
+//  being counted when it's deleted or detached, so a detached handle is
+//  counted as destroyed. Handles that are only attached, and never
+//  owned by the framework, aren't counted. Use the process's GDI handle
+//  count to see all the GDI objects.
+//
+//  CWinApp::GetResourceSnapshot combines these counters with the size
+//  of the handle maps and the process's GDI and USER handle counts.
+//  Define NO_RESOURCE_TELEMETRY to compile out the counters.
+//
+
+
+#ifndef _WIN32XX_TELEMETRY_H_
+#define _WIN32XX_TELEMETRY_H_
+
+
+#include <WinSock2.h>       // must include before windows.h
+#include <Windows.h>        // For the Interlocked functions
+
+
+namespace Win32xx
+{
+    // The types of resource counted by CResourceCounter. The GDI object
+    // and DC types only count handles owned by the framework.
+    enum ResourceType
+    {
+        RESOURCE_BITMAP = 0,    // Bitmaps owned by a CBitmap
+        RESOURCE_BRUSH,         // Brushes owned by a CBrush
+        RESOURCE_FONT,          // Fonts owned by a CFont
+        RESOURCE_PALETTE,       // Palettes owned by a CPalette
+        RESOURCE_PEN,           // Pens owned by a CPen
+        RESOURCE_REGION,        // Regions owned by a CRgn
+        RESOURCE_OTHER_GDI,     // Other GDI objects owned by a CGDIObject
+        RESOURCE_DC,            // Device contexts owned by a CDC
+        RESOURCE_DC_DATA,       // CDC_Data allocated for a CDC
+        RESOURCE_GDI_DATA,      // CGDI_Data allocated for a CGDIObject
+        RESOURCE_SHARED_PTR,    // Reference counts allocated by Shared_Ptr
+        RESOURCE_TYPES          // The number of resource types
+    };
+
+    // The counts for a type of resource. The created and destroyed totals
+    // wrap around after 2^32. For the GDI object and DC types, destroyed
+    // also counts the handles detached from the framework.
+    struct ResourceCount
+    {
+        DWORD created;          // Number created
+        DWORD destroyed;        // Number destroyed
+        LONG  count;            // Number currently in existence
+        LONG  maxCount;         // Largest number in existence at any one time
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    // CResourceCounter counts the resources created and destroyed by
+    // the framework. The counts are shared by all threads, and updated
+    // with interlocked functions rather than a lock.
+    class CResourceCounter
+    {
+    public:
+        static void Add(ResourceType type);
+        static ResourceCount Get(ResourceType type);
+        static void Remove(ResourceType type);
+        static void ResetMaxCounts();
+
+    private:
+        CResourceCounter();                                     // Disable construction
+        CResourceCounter(const CResourceCounter&);              // Disable copy construction
+        CResourceCounter& operator = (const CResourceCounter&); // Disable assignment operator
+
+        // The counters, stored as LONGs for the interlocked functions.
+        struct Counter
+        {
+            LONG created;
+            LONG destroyed;
+            LONG count;
+            LONG maxCount;
+        };
+
+        static Counter* GetCounters();
+    };
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+
+    ////////////////////////////////////////////////
+    // Definitions for the CResourceCounter class
+    //
+
+    // Records the creation of a resource.
+    inline void CResourceCounter::Add(ResourceType type)
+    {
+#ifndef NO_RESOURCE_TELEMETRY
+        Counter& counter = GetCounters()[type];
+        ::InterlockedIncrement(&counter.created);
+        LONG count = ::InterlockedIncrement(&counter.count);
+
+        // Raise the maximum if another thread hasn't already done so.
+        LONG maxCount = counter.maxCount;
+        while (count > maxCount)
+        {
+            LONG previous = ::InterlockedCompareExchange(&counter.maxCount, count, maxCount);
+            if (previous == maxCount)
+                break;
+
+            maxCount = previous;
+        }
+#else
+        UNREFERENCED_PARAMETER(type);
+#endif
+    }
+
+    // Retrieves the counts for the specified type of resource.
+    inline ResourceCount CResourceCounter::Get(ResourceType type)
+    {
+        ResourceCount result;
+        ZeroMemory(&result, sizeof(result));
+
+#ifndef NO_RESOURCE_TELEMETRY
+        const Counter& counter = GetCounters()[type];
+        result.created   = static_cast<DWORD>(counter.created);
+        result.destroyed = static_cast<DWORD>(counter.destroyed);
+        result.count     = counter.count;
+        result.maxCount  = counter.maxCount;
+#else
+        UNREFERENCED_PARAMETER(type);
+#endif
+
+        return result;
+    }
+
+    // Returns the array of counters, one for each type of resource. The
+    // array is zero initialized before any code runs, so resources can be
+    // counted during static initialization.
+    inline CResourceCounter::Counter* CResourceCounter::GetCounters()
+    {
+        static Counter counters[RESOURCE_TYPES];
+        return counters;
+    }
+
+    // Records the destruction of a resource.
+    inline void CResourceCounter::Remove(ResourceType type)
+    {
+#ifndef NO_RESOURCE_TELEMETRY
+        Counter& counter = GetCounters()[type];
+        ::InterlockedIncrement(&counter.destroyed);
+        ::InterlockedDecrement(&counter.count);
+#else
+        UNREFERENCED_PARAMETER(type);
+#endif
+    }
+
+    // Sets the maximum counts to the current counts.
+    inline void CResourceCounter::ResetMaxCounts()
+    {
+#ifndef NO_RESOURCE_TELEMETRY
+        Counter* pCounters = GetCounters();
+        for (int type = 0; type < RESOURCE_TYPES; ++type)
+            ::InterlockedExchange(&pCounters[type].maxCount, pCounters[type].count);
+#endif
+    }
+
+}
+
+
+#endif // _WIN32XX_TELEMETRY_H_
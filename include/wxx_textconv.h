@@ -38,12 +38,41 @@
 ////////////////////////////////////////////////////////
 // wxx_textconv.h
 //  Definitions of the CAtoA, CAtoW, CWtoA, CWtoW,
-//    CAtoBSTR and CWtoBSTR classes
+//    CAtoBSTR, CWtoBSTR and CTextConv classes
+//
+//  CAtoW and CWtoA convert text that is pure ASCII directly, using SSE2
+//  when the processor supports it, and transcode valid UTF-8 without
+//  calling the Windows API. Other text is converted with
+//  MultiByteToWideChar and WideCharToMultiByte. Short strings are held in
+//  a buffer within the object, so they don't use the heap. Define
+//  NO_TEXTCONV_SIMD to use only the scalar code, and define
+//  SECURE_TEXTCONV to clear the converted text when the object is
+//  destroyed.
 
 #ifndef _WIN32XX_TEXTCONV_H_
 #define _WIN32XX_TEXTCONV_H_
 
 #include <vector>
+#include <string.h>
+#include <wchar.h>
+
+
+// The SSE2 versions are supported for x86 and x64 processors.
+#if !defined (NO_TEXTCONV_SIMD) && (defined (_M_IX86) || defined (_M_X64) || defined (__i386__) || defined (__x86_64__))
+  #if defined (__GNUC__) || (defined (_MSC_VER) && (_MSC_VER >= 1500))   // >= VS2008
+    #define WXX_TEXTCONV_SSE2
+    #include <emmintrin.h>
+  #endif
+#endif
+
+// GCC and Clang compile the SIMD functions for their instruction set.
+#ifndef WXX_TARGET_SSE2
+  #if defined (__GNUC__) || defined (__clang__)
+    #define WXX_TARGET_SSE2 __attribute__((target("sse2")))
+  #else
+    #define WXX_TARGET_SSE2
+  #endif
+#endif
 
 namespace Win32xx
 {
@@ -76,6 +105,9 @@ namespace Win32xx
     // OLE is the same as WCHAR. It is used in Visual Basic and COM programming.
 
 
+    // The number of characters CAtoW and CWtoA hold without using the heap.
+    const int WXX_TEXTCONV_BUFFER_SIZE = 128;
+
     // Forward declarations of our classes. They are defined later.
     class CAtoA;
     class CAtoW;
@@ -115,19 +147,49 @@ namespace Win32xx
     typedef WtoT  OLEtoT;
     typedef CWtoW OLEtoW;
 
+    ////////////////////////////////////////////////////////
+    // CTextConv provides the conversions used by CAtoW and CWtoA.
+    // Each function has a scalar and an SSE2 version. The version is
+    // chosen at run time based on the processor.
+    class CTextConv
+    {
+    public:
+        static int  AsciiLength(LPCSTR str, int length);
+        static int  AsciiLength(LPCWSTR str, int length);
+        static bool IsAsciiCodePage(UINT codePage);
+        static bool IsSSE2Supported();
+        static void Narrow(LPCWSTR source, int length, LPSTR dest);
+        static int  Utf8Length(LPCWSTR source, int length);
+        static int  Utf8ToWide(LPCSTR source, int length, LPWSTR dest);
+        static void Widen(LPCSTR source, int length, LPWSTR dest);
+        static void WideToUtf8(LPCWSTR source, int length, LPSTR dest);
+
+    private:
+#ifdef WXX_TEXTCONV_SSE2
+        WXX_TARGET_SSE2 static int  AsciiLengthSSE2(LPCSTR str, int length);
+        WXX_TARGET_SSE2 static int  AsciiLengthSSE2(LPCWSTR str, int length);
+        WXX_TARGET_SSE2 static int  NarrowSSE2(LPCWSTR source, int length, LPSTR dest);
+        WXX_TARGET_SSE2 static int  WidenSSE2(LPCSTR source, int length, LPWSTR dest);
+#endif
+    };
+
     class CAtoW
     {
     public:
         CAtoW(LPCSTR str, UINT codePage = CP_ACP, int charCount = -1);
         ~CAtoW();
-        operator LPCWSTR() { return m_str? &m_wideArray[0] : NULL; }
-        operator LPOLESTR() { return m_str? (LPOLESTR)&m_wideArray[0] : (LPOLESTR)NULL; }
-        LPCWSTR c_str() { return m_str ? &m_wideArray[0] : NULL; }
+        operator LPCWSTR() { return m_str? m_wide : NULL; }
+        operator LPOLESTR() { return m_str? (LPOLESTR)m_wide : (LPOLESTR)NULL; }
+        LPCWSTR c_str() { return m_str ? m_wide : NULL; }
 
     private:
         CAtoW(const CAtoW&);
         CAtoW& operator= (const CAtoW&);
-        std::vector<wchar_t> m_wideArray;
+        LPWSTR Allocate(int length);
+
+        WCHAR m_fixedArray[WXX_TEXTCONV_BUFFER_SIZE];    // Holds short strings.
+        std::vector<WCHAR> m_wideArray;                  // Holds long strings.
+        LPWSTR m_wide;
         LPCSTR m_str;
     };
 
@@ -136,13 +198,17 @@ namespace Win32xx
     public:
         CWtoA(LPCWSTR str, UINT codePage = CP_ACP, int charCount = -1);
         ~CWtoA();
-        operator LPCSTR() { return m_str? &m_ansiArray[0] : NULL; }
-        LPCSTR c_str() { return m_str ? &m_ansiArray[0] : NULL; }
+        operator LPCSTR() { return m_str? m_ansi : NULL; }
+        LPCSTR c_str() { return m_str ? m_ansi : NULL; }
 
     private:
         CWtoA(const CWtoA&);
         CWtoA& operator= (const CWtoA&);
-        std::vector<char> m_ansiArray;
+        LPSTR Allocate(int length);
+
+        char m_fixedArray[WXX_TEXTCONV_BUFFER_SIZE];     // Holds short strings.
+        std::vector<char> m_ansiArray;                   // Holds long strings.
+        LPSTR m_ansi;
         LPCWSTR m_str;
     };
 
@@ -208,51 +274,468 @@ namespace Win32xx
 namespace Win32xx
 {
 
-    inline CAtoW::CAtoW(LPCSTR str, UINT codePage /*= CP_ACP*/, int charCount /*= -1*/) : m_str(str)
+    ///////////////////////////////////////
+    // Definitions for the CTextConv class.
+    //
+
+    // Returns the number of characters at the start of str that are ASCII.
+    inline int CTextConv::AsciiLength(LPCSTR str, int length)
+    {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (IsSSE2Supported())
+            i = AsciiLengthSSE2(str, length);
+#endif
+
+        while (i < length && static_cast<BYTE>(str[i]) < 0x80)
+            ++i;
+
+        return i;
+    }
+
+    // Returns the number of characters at the start of str that are ASCII.
+    inline int CTextConv::AsciiLength(LPCWSTR str, int length)
     {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (IsSSE2Supported())
+            i = AsciiLengthSSE2(str, length);
+#endif
+
+        while (i < length && static_cast<WORD>(str[i]) < 0x80)
+            ++i;
+
+        return i;
+    }
+
+    // Returns true if the code page encodes the ASCII characters as single
+    // bytes, and never uses bytes below 0x80 within other characters.
+    inline bool CTextConv::IsAsciiCodePage(UINT codePage)
+    {
+        switch (codePage)
+        {
+        case CP_ACP:
+        case CP_OEMCP:
+        case CP_THREAD_ACP:
+        case CP_UTF8:
+        case 437:   // OEM United States
+        case 850:   // OEM Multilingual Latin 1
+        case 1250:  // Central European
+        case 1251:  // Cyrillic
+        case 1252:  // Western European
+        case 1253:  // Greek
+        case 1254:  // Turkish
+        case 1255:  // Hebrew
+        case 1256:  // Arabic
+        case 1257:  // Baltic
+        case 1258:  // Vietnamese
+            return true;
+        }
+
+        return false;
+    }
+
+    // Returns true if the processor supports SSE2 instructions.
+    // x64 processors always support SSE2.
+    inline bool CTextConv::IsSSE2Supported()
+    {
+#if defined (_M_X64) || defined (__x86_64__)
+        return true;
+#else
+        static const bool isSupported = (::IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) != FALSE);
+        return isSupported;
+#endif
+    }
+
+    // Copies ASCII characters from source to dest.
+    inline void CTextConv::Narrow(LPCWSTR source, int length, LPSTR dest)
+    {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (IsSSE2Supported())
+            i = NarrowSSE2(source, length, dest);
+#endif
+
+        for (; i < length; ++i)
+            dest[i] = static_cast<char>(source[i]);
+    }
+
+    // Returns the number of bytes required to encode source as UTF-8,
+    // or -1 if source contains an unpaired surrogate.
+    inline int CTextConv::Utf8Length(LPCWSTR source, int length)
+    {
+        int bytes = 0;
+        int i = 0;
+        while (i < length)
+        {
+            UINT ch = static_cast<WORD>(source[i]);
+            if (ch < 0x80)
+            {
+                int ascii = AsciiLength(source + i, length - i);
+                bytes += ascii;
+                i += ascii;
+            }
+            else if (ch < 0x800)
+            {
+                bytes += 2;
+                ++i;
+            }
+            else if (ch >= 0xD800 && ch <= 0xDFFF)
+            {
+                // A high surrogate must be followed by a low surrogate.
+                if (ch >= 0xDC00 || i + 1 == length)
+                    return -1;
+
+                UINT low = static_cast<WORD>(source[i + 1]);
+                if (low < 0xDC00 || low > 0xDFFF)
+                    return -1;
+
+                bytes += 4;
+                i += 2;
+            }
+            else
+            {
+                bytes += 3;
+                ++i;
+            }
+        }
+
+        return bytes;
+    }
+
+    // Converts UTF-8 text to UTF-16. The dest buffer must hold at least
+    // length characters. Returns the number of characters written, or -1
+    // if the source isn't valid UTF-8.
+    inline int CTextConv::Utf8ToWide(LPCSTR source, int length, LPWSTR dest)
+    {
+        const BYTE* pSource = reinterpret_cast<const BYTE*>(source);
+        const BYTE* pEnd = pSource + length;
+        LPWSTR pDest = dest;
+        while (pSource < pEnd)
+        {
+            UINT ch = pSource[0];
+            if (ch < 0x80)
+            {
+                // Copy a run of ASCII characters.
+                LPCSTR run = reinterpret_cast<LPCSTR>(pSource);
+                int ascii = AsciiLength(run, static_cast<int>(pEnd - pSource));
+                Widen(run, ascii, pDest);
+                pSource += ascii;
+                pDest += ascii;
+            }
+            else if (ch >= 0xC2 && ch <= 0xDF)
+            {
+                if (pEnd - pSource < 2 || (pSource[1] & 0xC0) != 0x80)
+                    return -1;
+
+                *pDest++ = static_cast<WCHAR>(((ch & 0x1F) << 6) | (pSource[1] & 0x3F));
+                pSource += 2;
+            }
+            else if (ch >= 0xE0 && ch <= 0xEF)
+            {
+                if (pEnd - pSource < 3 || (pSource[1] & 0xC0) != 0x80 || (pSource[2] & 0xC0) != 0x80)
+                    return -1;
+
+                // Reject overlong encodings and surrogates.
+                UINT codePoint = ((ch & 0x0F) << 12) | ((pSource[1] & 0x3F) << 6) | (pSource[2] & 0x3F);
+                if (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                    return -1;
+
+                *pDest++ = static_cast<WCHAR>(codePoint);
+                pSource += 3;
+            }
+            else if (ch >= 0xF0 && ch <= 0xF4)
+            {
+                if (pEnd - pSource < 4 || (pSource[1] & 0xC0) != 0x80 ||
+                    (pSource[2] & 0xC0) != 0x80 || (pSource[3] & 0xC0) != 0x80)
+                    return -1;
+
+                // Reject overlong encodings and code points above U+10FFFF.
+                UINT codePoint = ((ch & 0x07) << 18) | ((pSource[1] & 0x3F) << 12) |
+                                 ((pSource[2] & 0x3F) << 6) | (pSource[3] & 0x3F);
+                if (codePoint < 0x10000 || codePoint > 0x10FFFF)
+                    return -1;
+
+                codePoint -= 0x10000;
+                *pDest++ = static_cast<WCHAR>(0xD800 + (codePoint >> 10));
+                *pDest++ = static_cast<WCHAR>(0xDC00 + (codePoint & 0x3FF));
+                pSource += 4;
+            }
+            else
+                return -1;
+        }
+
+        return static_cast<int>(pDest - dest);
+    }
+
+    // Copies ASCII characters from source to dest.
+    inline void CTextConv::Widen(LPCSTR source, int length, LPWSTR dest)
+    {
+        int i = 0;
+
+#ifdef WXX_TEXTCONV_SSE2
+        if (IsSSE2Supported())
+            i = WidenSSE2(source, length, dest);
+#endif
+
+        for (; i < length; ++i)
+            dest[i] = static_cast<WCHAR>(static_cast<BYTE>(source[i]));
+    }
+
+    // Converts UTF-16 text to UTF-8. The source must not contain unpaired
+    // surrogates, and dest must hold the number of bytes returned by
+    // Utf8Length.
+    inline void CTextConv::WideToUtf8(LPCWSTR source, int length, LPSTR dest)
+    {
+        int i = 0;
+        while (i < length)
+        {
+            UINT ch = static_cast<WORD>(source[i]);
+            if (ch < 0x80)
+            {
+                // Copy a run of ASCII characters.
+                int ascii = AsciiLength(source + i, length - i);
+                Narrow(source + i, ascii, dest);
+                dest += ascii;
+                i += ascii;
+            }
+            else if (ch < 0x800)
+            {
+                *dest++ = static_cast<char>(0xC0 | (ch >> 6));
+                *dest++ = static_cast<char>(0x80 | (ch & 0x3F));
+                ++i;
+            }
+            else if (ch >= 0xD800 && ch <= 0xDBFF)
+            {
+                UINT low = static_cast<WORD>(source[i + 1]);
+                UINT codePoint = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+                *dest++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                *dest++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+                i += 2;
+            }
+            else
+            {
+                *dest++ = static_cast<char>(0xE0 | (ch >> 12));
+                *dest++ = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | (ch & 0x3F));
+                ++i;
+            }
+        }
+    }
+
+#ifdef WXX_TEXTCONV_SSE2
+
+    // Tests 16 characters at a time. Returns the number of characters
+    // tested before a block containing a non-ASCII character was found.
+    inline int CTextConv::AsciiLengthSSE2(LPCSTR str, int length)
+    {
+        int i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            if (_mm_movemask_epi8(chars) != 0)
+                break;
+        }
+
+        return i;
+    }
+
+    // Tests 16 characters at a time. Returns the number of characters
+    // tested before a block containing a non-ASCII character was found.
+    inline int CTextConv::AsciiLengthSSE2(LPCWSTR str, int length)
+    {
+        const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+        const __m128i zero = _mm_setzero_si128();
+        int i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i + 8));
+            __m128i bits = _mm_and_si128(_mm_or_si128(low, high), highBits);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero)) != 0xFFFF)
+                break;
+        }
+
+        return i;
+    }
+
+    // Narrows 16 ASCII characters at a time. Returns the number of
+    // characters copied.
+    inline int CTextConv::NarrowSSE2(LPCWSTR source, int length, LPSTR dest)
+    {
+        int i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(low, high));
+        }
+
+        return i;
+    }
+
+    // Widens 16 ASCII characters at a time. Returns the number of
+    // characters copied.
+    inline int CTextConv::WidenSSE2(LPCSTR source, int length, LPWSTR dest)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        int i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_unpacklo_epi8(chars, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), _mm_unpackhi_epi8(chars, zero));
+        }
+
+        return i;
+    }
+
+#endif // WXX_TEXTCONV_SSE2
+
+
+    ///////////////////////////////////
+    // Definitions for the CAtoW class.
+    //
+
+    inline CAtoW::CAtoW(LPCSTR str, UINT codePage /*= CP_ACP*/, int charCount /*= -1*/) : m_wide(m_fixedArray), m_str(str)
+    {
+        m_fixedArray[0] = L'\0';
         if (str)
         {
-            // Resize the vector and assign null WCHAR to each element.
-            int charSize = static_cast<int>(sizeof(CHAR));
-            int charBytes = (charCount == -1) ? -1 : charSize * charCount;
-            int length = MultiByteToWideChar(codePage, 0, str, charBytes, NULL, 0) + 1;
-            m_wideArray.assign(static_cast<size_t>(length), L'\0');
-
-            // Fill our vector with the converted WCHAR array.
-            MultiByteToWideChar(codePage, 0, str, charBytes, &m_wideArray[0], length);
+            // Each character converts to at most one WCHAR per byte.
+            int length = (charCount == -1) ? static_cast<int>(::strlen(str)) : charCount;
+            LPWSTR wide = Allocate(length);
+
+            // Widen the ASCII characters directly. The ASCII characters
+            // at the start of the text end on a character boundary.
+            int ascii = CTextConv::IsAsciiCodePage(codePage) ? CTextConv::AsciiLength(str, length) : 0;
+            CTextConv::Widen(str, ascii, wide);
+            int converted = ascii;
+
+            if (ascii < length)
+            {
+                // Convert the rest of the text. Invalid UTF-8 is converted
+                // by the Windows API, which substitutes the invalid bytes.
+                int result = -1;
+                if (codePage == CP_UTF8)
+                    result = CTextConv::Utf8ToWide(str + ascii, length - ascii, wide + ascii);
+
+                if (result < 0)
+                    result = ::MultiByteToWideChar(codePage, 0, str + ascii, length - ascii, wide + ascii, length - ascii);
+
+                converted += result;
+            }
+
+            wide[converted] = L'\0';
         }
     }
 
     inline CAtoW::~CAtoW()
     {
-        // Clear the array.
+#ifdef SECURE_TEXTCONV
+        // Clear the arrays.
+        std::fill(m_fixedArray, m_fixedArray + WXX_TEXTCONV_BUFFER_SIZE, L'\0');
         std::fill(m_wideArray.begin(), m_wideArray.end(), L'\0');
+#endif
+    }
+
+    // Returns a buffer large enough to hold length characters and a
+    // terminating null. Only long strings use the heap.
+    inline LPWSTR CAtoW::Allocate(int length)
+    {
+        if (length < WXX_TEXTCONV_BUFFER_SIZE)
+            m_wide = m_fixedArray;
+        else
+        {
+            m_wideArray.resize(static_cast<size_t>(length) + 1);
+            m_wide = &m_wideArray[0];
+        }
+
+        return m_wide;
     }
 
+
+    ///////////////////////////////////
+    // Definitions for the CWtoA class.
+    //
+
     // Usage:
     //   CWtoA ansiString(L"Some Text");
     //   CWtoA utf8String(L"Some Text", CP_UTF8);
     //
     // or
     //   SetWindowTextA( WtoA(L"Some Text") ); The ANSI version of SetWindowText
-    inline CWtoA::CWtoA(LPCWSTR str, UINT codePage /*= CP_ACP*/, int charCount /*= -1*/) : m_str(str)
+    inline CWtoA::CWtoA(LPCWSTR str, UINT codePage /*= CP_ACP*/, int charCount /*= -1*/) : m_ansi(m_fixedArray), m_str(str)
     {
-        // Resize the vector and assign null char to each element
-        int charSize = static_cast<int>(sizeof(WCHAR));
-        int charBytes = (charCount == -1) ? -1 : charSize * charCount;
-        int length = WideCharToMultiByte(codePage, 0, str, charBytes, NULL, 0, NULL, NULL) + 1;
-        m_ansiArray.assign(static_cast<size_t>(length), '\0');
-
-        // Fill our vector with the converted char array
-        WideCharToMultiByte(codePage, 0, str, charCount, &m_ansiArray[0], length, NULL, NULL);
+        m_fixedArray[0] = '\0';
+        if (str)
+        {
+            int length = (charCount == -1) ? static_cast<int>(::wcslen(str)) : charCount;
+            int ascii = CTextConv::IsAsciiCodePage(codePage) ? CTextConv::AsciiLength(str, length) : 0;
+            LPCWSTR rest = str + ascii;
+            int restLength = length - ascii;
+
+            // Determine the number of bytes needed for the rest of the text.
+            int bytes = 0;
+            bool isUtf8 = false;
+            if (restLength > 0)
+            {
+                if (codePage == CP_UTF8)
+                {
+                    bytes = CTextConv::Utf8Length(rest, restLength);
+                    isUtf8 = (bytes >= 0);
+                }
+
+                if (!isUtf8)
+                    bytes = ::WideCharToMultiByte(codePage, 0, rest, restLength, NULL, 0, NULL, NULL);
+            }
+
+            // Narrow the ASCII characters directly, and convert the rest.
+            LPSTR ansi = Allocate(ascii + bytes);
+            CTextConv::Narrow(str, ascii, ansi);
+            if (isUtf8)
+                CTextConv::WideToUtf8(rest, restLength, ansi + ascii);
+            else if (bytes > 0)
+                ::WideCharToMultiByte(codePage, 0, rest, restLength, ansi + ascii, bytes, NULL, NULL);
+
+            ansi[ascii + bytes] = '\0';
+        }
     }
 
     inline CWtoA::~CWtoA()
     {
-        // Clear the array.
+#ifdef SECURE_TEXTCONV
+        // Clear the arrays.
+        std::fill(m_fixedArray, m_fixedArray + WXX_TEXTCONV_BUFFER_SIZE, '\0');
         std::fill(m_ansiArray.begin(), m_ansiArray.end(), '\0');
+#endif
     }
 
+    // Returns a buffer large enough to hold length characters and a
+    // terminating null. Only long strings use the heap.
+    inline LPSTR CWtoA::Allocate(int length)
+    {
+        if (length < WXX_TEXTCONV_BUFFER_SIZE)
+            m_ansi = m_fixedArray;
+        else
+        {
+            m_ansiArray.resize(static_cast<size_t>(length) + 1);
+            m_ansi = &m_ansiArray[0];
+        }
+
+        return m_ansi;
+    }
+
+
+    ///////////////////////////////////////////////////
+    // Definitions for the CWtoW and CAtoA classes.
+    //
+
     inline CWtoW::CWtoW(LPCWSTR str, UINT /*codePage = CP_ACP*/, int /*charCount = -1*/) : m_str(str)
     {
     }
@@ -267,6 +267,11 @@ namespace Win32xx
 
     inline CWinThread::~CWinThread()
     {
+        // Tasks can no longer be posted to this object.
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        if (pApp != NULL)
+            pApp->RemoveMessagePump(this);
+
         // Post a WM_QUIT to safely end the thread.
         PostThreadMessage(WM_QUIT, 0, 0);
 
@@ -285,12 +290,16 @@ namespace Win32xx
         {
             // Set the thread's TLS Data.
             GetApp()->SetTlsData();
+            GetApp()->GetTlsData()->pMessagePump = pThread;
 
             // Run the thread's message loop if InitInstance returns TRUE.
+            UINT result = 0;
             if (pThread->InitInstance())
-            {
-                return pThread->MessageLoop();
-            }
+                result = pThread->MessageLoop();
+
+            // The thread no longer runs a message loop.
+            GetApp()->ReleaseTlsData();
+            return result;
         }
 
         return 0;
@@ -0,0 +1,567 @@
+// Win32++   Version 9.0.1
+// Release Date: TBA
+//
+//      David Nash
+//      email: dnash@bigpond.net.au
+//      url: https://sourceforge.net/projects/win32-framework
+//
+//
+// Copyright (c) 2005-2022  David Nash
+//
+// Permission is hereby granted, free of charge, to
+// any person obtaining a copy of this software and
+// associated documentation files (the "Software"),
+// to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify,
+// merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice
+// shall be included in all copies or substantial portions
+// of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+// ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+// TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+// PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+// SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+// ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+// OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// wxx_threadpool.h
+//  This file contains the declaration and definition of the CThreadPool
+//  and CCancelToken classes. CThreadPool runs tasks on a set of worker
+//  threads, one for each processor by default. Each worker has its own
+//  queue of tasks. Idle workers steal tasks from the queues of busy
+//  workers. A task can have a completion function, which runs on the
+//  thread that queued the task when that thread runs a message loop.
+//  ParallelFor divides a range of indexes into chunks that are
+//  processed by the worker threads and the calling thread.
+//
+//  Refer to the following example code.
+//
+
+
+// Example code
+/*
+
+// Runs on a worker thread.
+void WINAPI LoadFile(LPVOID pParam)
+{
+    FileData* pData = static_cast<FileData*>(pParam);
+    if (!pData->pCancel->IsCancelled())
+        pData->Load();
+}
+
+// Runs on the thread that queued the task.
+void WINAPI OnFileLoaded(LPVOID pParam)
+{
+    FileData* pData = static_cast<FileData*>(pParam);
+    pData->pView->Invalidate();
+    delete pData;
+}
+
+// Brightens a range of rows.
+void WINAPI BrightenRows(int first, int last, LPVOID pParam)
+{
+    ImageData* pImage = static_cast<ImageData*>(pParam);
+    for (int row = first; row < last; ++row)
+        pImage->BrightenRow(row);
+}
+
+void CView::LoadFileInBackground()
+{
+    FileData* pData = new FileData(this, &m_cancel);
+    GetThreadPool().QueueTask(LoadFile, pData, OnFileLoaded, &m_cancel);
+}
+
+void CView::Brighten()
+{
+    GetThreadPool().ParallelFor(0, m_image.GetHeight(), BrightenRows, &m_image);
+}
+
+*/
+
+
+#ifndef _WIN32XX_THREADPOOL_H_
+#define _WIN32XX_THREADPOOL_H_
+
+#include "wxx_appcore.h"
+#include "wxx_thread.h"
+#include "wxx_mutex.h"
+#include <deque>
+
+
+namespace Win32xx
+{
+    // Processes the indexes from first up to, but not including, last.
+    typedef void (WINAPI* PFNRANGEPROC)(int first, int last, LPVOID pParam);
+
+
+    //////////////////////////////////////////////////////////////
+    // CCancelToken is used to cancel the tasks queued with
+    // CThreadPool. A task that is cancelled before it starts is
+    // not run. A running task can call IsCancelled to end early.
+    class CCancelToken
+    {
+    public:
+        CCancelToken() : m_isCancelled(0) {}
+        virtual ~CCancelToken() {}
+
+        void Cancel()               { ::InterlockedExchange(&m_isCancelled, 1); }
+        BOOL IsCancelled() const    { return (m_isCancelled != 0); }
+        void Reset()                { ::InterlockedExchange(&m_isCancelled, 0); }
+
+    private:
+        CCancelToken(const CCancelToken&);              // Disable copy construction
+        CCancelToken& operator = (const CCancelToken&); // Disable assignment operator
+
+        LONG m_isCancelled;
+    };
+
+
+#if defined (_MSC_VER) && (_MSC_VER <= 1600)   // <= VS2010
+#pragma warning ( push )
+#pragma warning ( disable : 4355 )            // 'this' used in base member initializer list
+#endif // (_MSC_VER) && (_MSC_VER <= 1600)
+
+    /////////////////////////////////////////////////////////////
+    // CThreadPool manages a set of worker threads that run tasks.
+    // Tasks queued by a worker thread are added to that worker's
+    // own queue, and other tasks are added to a shared queue.
+    // Workers run their own tasks newest first, then the tasks in
+    // the shared queue, then steal the oldest tasks from the other
+    // workers.
+    class CThreadPool
+    {
+    public:
+        CThreadPool(int threadCount = 0);
+        virtual ~CThreadPool();
+
+        int  GetThreadCount() const { return static_cast<int>(m_workers.size()); }
+        void ParallelFor(int first, int last, PFNRANGEPROC pfnRange, LPVOID pParam, int grainSize = 0);
+        void QueueTask(PFNTASKPROC pfnTask, LPVOID pParam, PFNTASKPROC pfnComplete = 0,
+                       const CCancelToken* pCancel = 0);
+        BOOL RunPendingTask();
+
+    private:
+        // A task queued with QueueTask.
+        struct PoolTask
+        {
+            PFNTASKPROC pfnTask;        // task callback function
+            PFNTASKPROC pfnComplete;    // completion callback function
+            LPVOID pParam;              // parameter for the task and completion
+            DWORD pumpThreadID;         // thread whose message loop runs the completion
+            const CCancelToken* pCancel;  // cancels the task before it starts
+        };
+
+        // A worker thread and its queue of tasks.
+        struct PoolWorker
+        {
+            PoolWorker(PFNTHREADPROC pfnThreadProc, CThreadPool* pool, size_t workerIndex)
+                : pPool(pool), index(workerIndex), threadID(0), thread(pfnThreadProc, this) {}
+
+            CThreadPool* pPool;         // the pool that owns this worker
+            size_t index;               // position of this worker in the pool
+            volatile DWORD threadID;    // ID of the worker thread, set by the worker thread
+            CWorkThread thread;         // the worker thread
+            std::deque<PoolTask> tasks; // tasks queued by this worker
+            CCriticalSection tasksLock; // thread synchronization for the tasks
+        };
+
+        // The shared state of a ParallelFor call.
+        struct ParallelData
+        {
+            ParallelData() : done(FALSE, TRUE) {}
+
+            PFNRANGEPROC pfnRange;      // processes a chunk of indexes
+            LPVOID pParam;              // parameter for pfnRange
+            LONG next;                  // first index of the next chunk, never past last
+            LONG last;                  // one past the last index
+            LONG grainSize;             // number of indexes in a chunk
+            LONG pendingChunks;         // number of chunks not yet processed
+            LONG refCount;              // number of threads using this data
+            CEvent done;                // signalled when all chunks are processed
+        };
+
+        typedef Shared_Ptr<PoolWorker> PoolWorkerPtr;
+
+        CThreadPool(const CThreadPool&);                // Disable copy construction
+        CThreadPool& operator = (const CThreadPool&);   // Disable assignment operator
+
+        BOOL FindTask(PoolWorker* pWorker, PoolTask& task);
+        PoolWorker* GetCurrentWorker() const;
+        void RunTask(const PoolTask& task) const;
+        void Stop();
+
+        static void ReleaseParallelData(ParallelData* pData);
+        static void RunChunks(ParallelData* pData);
+        static void WINAPI StaticParallelProc(LPVOID pData);
+        static void WINAPI StaticShutdownProc(LPVOID pPool);
+        static UINT WINAPI StaticWorkerProc(LPVOID pWorker);
+
+        CWinApp* m_pApp;                        // the CWinApp, or NULL once it's destroyed
+        std::vector<PoolWorkerPtr> m_workers;   // the worker threads
+        std::deque<PoolTask> m_tasks;           // tasks queued by other threads
+        CCriticalSection m_tasksLock;           // thread synchronization for m_tasks
+        CSemaphore m_taskCount;                 // the number of queued tasks
+        LONG m_isStopping;                      // non-zero when the workers should end
+    };
+
+#if defined (_MSC_VER) && (_MSC_VER <= 1600)
+#pragma warning (pop)
+#endif // (_MSC_VER) && (_MSC_VER <= 1600)
+
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+namespace Win32xx
+{
+
+    ///////////////////////////////////////////
+    // Definitions for the CThreadPool class
+    //
+
+    // CThreadPool constructor. The threadCount is the number of worker threads.
+    // A threadCount of 0 creates one worker thread for each processor.
+    // The worker threads are stopped when the CWinApp is destroyed, so the
+    // pool should be constructed after the CWinApp.
+    inline CThreadPool::CThreadPool(int threadCount /*= 0*/) : m_pApp(CWinApp::SetnGetThis()),
+        m_taskCount(0, 0x7FFFFFFF, NULL, NULL), m_isStopping(0)
+    {
+        if (threadCount <= 0)
+        {
+            SYSTEM_INFO info;
+            ::GetSystemInfo(&info);
+            threadCount = MAX(1, static_cast<int>(info.dwNumberOfProcessors));
+        }
+
+        for (int i = 0; i < threadCount; ++i)
+        {
+            PoolWorkerPtr worker(new PoolWorker(StaticWorkerProc, this, m_workers.size()));
+            m_workers.push_back(worker);
+        }
+
+        // Start the threads after all the workers have been added. Each
+        // worker thread stores its own thread ID before it runs a task.
+        std::vector<PoolWorkerPtr>::iterator it;
+        for (it = m_workers.begin(); it != m_workers.end(); ++it)
+            (*it)->thread.CreateThread();
+
+        if (m_pApp != 0)
+            m_pApp->AddShutdownProc(StaticShutdownProc, this);
+    }
+
+    // CThreadPool destructor. Ends the worker threads after their current tasks.
+    // Tasks that haven't started are discarded.
+    inline CThreadPool::~CThreadPool()
+    {
+        if (m_pApp != 0)
+            m_pApp->RemoveShutdownProc(this);
+
+        Stop();
+    }
+
+    // Retrieves a task for the worker. The worker's own tasks are taken newest
+    // first, followed by the shared tasks, and then the oldest task of another
+    // worker. pWorker is NULL if the calling thread isn't a worker.
+    inline BOOL CThreadPool::FindTask(PoolWorker* pWorker, PoolTask& task)
+    {
+        if (pWorker != 0)
+        {
+            CThreadLock lock(pWorker->tasksLock);
+            if (!pWorker->tasks.empty())
+            {
+                task = pWorker->tasks.back();
+                pWorker->tasks.pop_back();
+                return TRUE;
+            }
+        }
+
+        {
+            CThreadLock lock(m_tasksLock);
+            if (!m_tasks.empty())
+            {
+                task = m_tasks.front();
+                m_tasks.pop_front();
+                return TRUE;
+            }
+        }
+
+        // Steal a task from another worker, starting with the next worker.
+        size_t count = m_workers.size();
+        size_t start = (pWorker != 0) ? pWorker->index + 1 : 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            PoolWorker* pVictim = m_workers[(start + i) % count].get();
+            if (pVictim != pWorker)
+            {
+                CThreadLock lock(pVictim->tasksLock);
+                if (!pVictim->tasks.empty())
+                {
+                    task = pVictim->tasks.front();
+                    pVictim->tasks.pop_front();
+                    return TRUE;
+                }
+            }
+        }
+
+        return FALSE;
+    }
+
+    // Returns the worker for the calling thread, or NULL if the calling
+    // thread isn't one of this pool's worker threads.
+    inline CThreadPool::PoolWorker* CThreadPool::GetCurrentWorker() const
+    {
+        DWORD threadID = ::GetCurrentThreadId();
+        std::vector<PoolWorkerPtr>::const_iterator it;
+        for (it = m_workers.begin(); it != m_workers.end(); ++it)
+        {
+            if ((*it)->threadID == threadID)
+                return (*it).get();
+        }
+
+        return 0;
+    }
+
+    // Calls pfnRange for the indexes from first up to, but not including, last.
+    // The range is divided into chunks of grainSize indexes which are processed
+    // in parallel by the worker threads and the calling thread. A grainSize of
+    // 0 divides the range into about four chunks per worker thread. This
+    // function returns when all the chunks have been processed.
+    inline void CThreadPool::ParallelFor(int first, int last, PFNRANGEPROC pfnRange, LPVOID pParam, int grainSize /*= 0*/)
+    {
+        assert(pfnRange);
+        if (first >= last)
+            return;
+
+        // The count can exceed the range of an int, so it's a LONGLONG.
+        LONGLONG count = static_cast<LONGLONG>(last) - first;
+        int threadCount = GetThreadCount();
+        if (grainSize <= 0)
+            grainSize = static_cast<int>(MAX(1, count / (threadCount * 4)));
+
+        // The number of chunks is kept within the range of a LONG.
+        if (count / grainSize >= 0x7FFFFFFF)
+            grainSize = static_cast<int>(count / 0x7FFFFFFF + 1);
+
+        LONG chunks = static_cast<LONG>((count - 1) / grainSize + 1);
+        if (chunks == 1 || threadCount == 0 || m_isStopping != 0)
+        {
+            pfnRange(first, last, pParam);
+            return;
+        }
+
+        // The helper tasks, which might start after this function returns,
+        // share the data with this thread. The last to finish deletes it.
+        int helpers = static_cast<int>(MIN(chunks - 1, threadCount));
+        ParallelData* pData = new ParallelData;
+        pData->pfnRange = pfnRange;
+        pData->pParam = pParam;
+        pData->next = first;
+        pData->last = last;
+        pData->grainSize = grainSize;
+        pData->pendingChunks = chunks;
+        pData->refCount = helpers + 1;
+
+        for (int i = 0; i < helpers; ++i)
+            QueueTask(StaticParallelProc, pData);
+
+        // This thread also processes chunks, then waits for the chunks in progress.
+        RunChunks(pData);
+        ::WaitForSingleObject(pData->done, INFINITE);
+        ReleaseParallelData(pData);
+    }
+
+    // Queues a task to run on a worker thread. The optional completion
+    // function is called with the same parameter after the task has run.
+    // If the calling thread runs a message loop, the completion runs on that
+    // thread, otherwise it runs on the worker thread. A task that is cancelled
+    // by pCancel before it starts isn't run, but its completion is still
+    // called. pCancel must remain valid until the completion is called.
+    inline void CThreadPool::QueueTask(PFNTASKPROC pfnTask, LPVOID pParam, PFNTASKPROC pfnComplete /*= 0*/,
+                                       const CCancelToken* pCancel /*= 0*/)
+    {
+        assert(pfnTask);
+
+        PoolTask task;
+        task.pfnTask = pfnTask;
+        task.pfnComplete = pfnComplete;
+        task.pParam = pParam;
+        task.pumpThreadID = 0;
+        task.pCancel = pCancel;
+
+        if (pfnComplete != 0 && m_pApp != 0)
+        {
+            TLSData* pTLSData = m_pApp->GetTlsData();
+            if (pTLSData != 0 && pTLSData->pMessagePump != 0)
+                task.pumpThreadID = ::GetCurrentThreadId();
+        }
+
+        PoolWorker* pWorker = GetCurrentWorker();
+        if (pWorker != 0)
+        {
+            CThreadLock lock(pWorker->tasksLock);
+            pWorker->tasks.push_back(task);
+        }
+        else
+        {
+            CThreadLock lock(m_tasksLock);
+            m_tasks.push_back(task);
+        }
+
+        m_taskCount.ReleaseSemaphore(1);
+    }
+
+    // Releases the calling thread's reference to the ParallelFor data.
+    inline void CThreadPool::ReleaseParallelData(ParallelData* pData)
+    {
+        if (::InterlockedDecrement(&pData->refCount) == 0)
+            delete pData;
+    }
+
+    // Processes chunks of a ParallelFor range until there are none left.
+    // The next index is advanced with a compare and exchange, so it stops at
+    // the end of the range instead of overflowing past it.
+    inline void CThreadPool::RunChunks(ParallelData* pData)
+    {
+        for (;;)
+        {
+            LONG first = pData->next;
+            if (first >= pData->last)
+                break;
+
+            LONG last = pData->last;
+            if (static_cast<LONGLONG>(last) - first > pData->grainSize)
+                last = first + pData->grainSize;
+
+            // Try again if another thread took this chunk.
+            if (::InterlockedCompareExchange(&pData->next, last, first) != first)
+                continue;
+
+            pData->pfnRange(first, last, pData->pParam);
+
+            if (::InterlockedDecrement(&pData->pendingChunks) == 0)
+                pData->done.SetEvent();
+        }
+    }
+
+    // Runs a queued task on the calling thread. A thread waiting for tasks
+    // to finish can call this to help. Returns FALSE if no task is queued.
+    inline BOOL CThreadPool::RunPendingTask()
+    {
+        // Counts released by Stop don't have a task.
+        if (m_isStopping != 0 || ::WaitForSingleObject(m_taskCount, 0) != WAIT_OBJECT_0)
+            return FALSE;
+
+        // A task is available for each count taken from the semaphore.
+        PoolTask task;
+        PoolWorker* pWorker = GetCurrentWorker();
+        while (!FindTask(pWorker, task))
+            ::SwitchToThread();
+
+        RunTask(task);
+        return TRUE;
+    }
+
+    // Runs the task, then calls or posts its completion.
+    inline void CThreadPool::RunTask(const PoolTask& task) const
+    {
+        if (task.pCancel == 0 || !task.pCancel->IsCancelled())
+            task.pfnTask(task.pParam);
+
+        if (task.pfnComplete != 0)
+        {
+            // The message loop is looked up as the completion is posted,
+            // as the thread that queued the task might have ended. The
+            // CWinApp stops the pool's threads before it's destroyed.
+            if (task.pumpThreadID == 0 || m_pApp == 0 ||
+                !m_pApp->PostThreadTask(task.pumpThreadID, task.pfnComplete, task.pParam))
+                task.pfnComplete(task.pParam);
+        }
+    }
+
+    // Ends the worker threads after their current tasks. Tasks that haven't
+    // started aren't run by the workers.
+    inline void CThreadPool::Stop()
+    {
+        ::InterlockedExchange(&m_isStopping, 1);
+        m_taskCount.ReleaseSemaphore(static_cast<LONG>(m_workers.size()));
+
+        std::vector<PoolWorkerPtr>::iterator it;
+        for (it = m_workers.begin(); it != m_workers.end(); ++it)
+        {
+            if ((*it)->thread.GetThread() != 0)
+                ::WaitForSingleObject((*it)->thread, INFINITE);
+        }
+    }
+
+    // The task queued by ParallelFor for the worker threads.
+    inline void WINAPI CThreadPool::StaticParallelProc(LPVOID pData)
+    {
+        ParallelData* pParallelData = static_cast<ParallelData*>(pData);
+        RunChunks(pParallelData);
+        ReleaseParallelData(pParallelData);
+    }
+
+    // Called when the CWinApp is destroyed. Stops the worker threads, so
+    // their tasks don't use the CWinApp after it's destroyed.
+    inline void WINAPI CThreadPool::StaticShutdownProc(LPVOID pPool)
+    {
+        CThreadPool* pThreadPool = static_cast<CThreadPool*>(pPool);
+        pThreadPool->Stop();
+        pThreadPool->m_pApp = 0;
+    }
+
+    // The thread procedure for the worker threads.
+    inline UINT WINAPI CThreadPool::StaticWorkerProc(LPVOID pWorker)
+    {
+        PoolWorker* pPoolWorker = static_cast<PoolWorker*>(pWorker);
+        CThreadPool* pPool = pPoolWorker->pPool;
+
+        // The thread ID is stored by the worker thread itself, so it's set
+        // before this thread queues a task or looks up its worker.
+        pPoolWorker->threadID = ::GetCurrentThreadId();
+
+        for (;;)
+        {
+            ::WaitForSingleObject(pPool->m_taskCount, INFINITE);
+            if (pPool->m_isStopping != 0)
+                break;
+
+            // A task is available for each count taken from the semaphore.
+            PoolTask task;
+            while (!pPool->FindTask(pPoolWorker, task))
+                ::SwitchToThread();
+
+            pPool->RunTask(task);
+        }
+
+        return 0;
+    }
+
+
+    ////////////////////////////////////////
+    // Global function
+    //
+
+    // Returns the application's shared thread pool. The pool is created the
+    // first time this function is called, which should be from the main thread.
+    inline CThreadPool& GetThreadPool()
+    {
+        static CThreadPool threadPool;
+        return threadPool;
+    }
+
+}
+
+#endif // _WIN32XX_THREADPOOL_H_
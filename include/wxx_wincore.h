@@ -105,12 +105,14 @@ namespace Win32xx
     // Definitions for the CWnd class
     //
 
-    inline CWnd::CWnd() : m_wnd(0), m_prevWindowProc(NULL)
+    inline CWnd::CWnd() : m_wnd(0), m_prevWindowProc(NULL), m_isPreTranslateEnabled(FALSE),
+                          m_isBasePreTranslated(FALSE), m_isPreTranslateReported(FALSE)
     {
         // Note: m_wnd is set in CWnd::CreateEx(...)
     }
 
-    inline CWnd::CWnd(HWND wnd) : m_prevWindowProc(NULL)
+    inline CWnd::CWnd(HWND wnd) : m_prevWindowProc(NULL), m_isPreTranslateEnabled(FALSE),
+                                  m_isBasePreTranslated(FALSE), m_isPreTranslateReported(FALSE)
     {
         // A private constructor, used internally.
 
@@ -142,8 +144,24 @@ namespace Win32xx
         RemoveFromMap();
 
         // Add the (HWND, CWnd*) pair to the map
-        CThreadLock mapLock(GetApp()->m_wndLock);
-        GetApp()->m_mapHWND.insert(std::make_pair(GetHwnd(), this));
+        CWinApp* pApp = GetApp();
+        CThreadLock mapLock(pApp->m_wndLock);
+        pApp->m_mapHWND.insert(std::make_pair(GetHwnd(), this));
+
+        // Store the CWnd pointer with the window for fast retrieval.
+        if (pApp->m_wndProp != 0)
+        {
+            if (!::SetProp(*this, MAKEINTATOM(pApp->m_wndProp), this))
+            {
+                // GetCWndFromMap searches the map when the property isn't set.
+                TRACE("*** Warning in CWnd::AddToMap: SetProp failed ***\n");
+                ::InterlockedIncrement(&pApp->m_wndPropFailures);
+            }
+        }
+
+        // This window might belong to a cached pre-translation chain.
+        if (m_isPreTranslateEnabled)
+            pApp->ResetPreTranslateChains();
     }
 
     // Attaches a CWnd object to an existing window and calls the OnAttach virtual function.
@@ -485,6 +503,25 @@ namespace Win32xx
         // dx.DDX_Check(IDC_CHECK_C,        m_checkC);
     }
 
+    // Enables or disables calls to PreTranslateMessage by the message loop.
+    // Only windows with pre-translation enabled have their PreTranslateMessage
+    // function called for keyboard and mouse messages sent to the window or
+    // its child windows. This can be called before the window is created.
+    // Debug builds assert if a window that overrides PreTranslateMessage
+    // hasn't enabled pre-translation.
+    inline void CWnd::EnablePreTranslate(BOOL enable /*= TRUE*/)
+    {
+        if (m_isPreTranslateEnabled == enable)
+            return;
+
+        m_isPreTranslateEnabled = enable;
+
+        // A window without a handle isn't in any cached pre-translation chain.
+        CWinApp* pApp = CWinApp::SetnGetThis();
+        if (pApp != NULL && m_wnd != 0)  // Is the CWinApp object valid?
+            pApp->ResetPreTranslateChains();
+    }
+
     // Pass messages on to the appropriate default window procedure
     // CMDIChild and CMDIFrame override this function.
     inline LRESULT CWnd::FinalWindowProc(UINT msg, WPARAM wparam, LPARAM lparam)
@@ -680,6 +717,18 @@ namespace Win32xx
     {
     }
 
+    // Called when part of the client area of the window needs to be drawn.
+    // The region is the part of the client area that needs drawing. Override
+    // this function to skip drawing the things that don't intersect the
+    // region. By default, it calls OnDraw.
+    // Note: The region only holds the update region's rectangles when
+    //       WantsUpdateRegion returns TRUE. Otherwise it holds the bounding
+    //       rectangle of the update region.
+    inline void CWnd::OnDrawRegion(CDC& dc, const CUpdateRegion&)
+    {
+        OnDraw(dc);
+    }
+
     // Called when the background of the window's client area needs to be erased.
     // Override this function in your derived class to perform drawing tasks.
     // Return Value: Return FALSE to also permit default erasure of the background
@@ -786,14 +835,25 @@ namespace Win32xx
         {
             if (::GetUpdateRect(*this, NULL, FALSE))
             {
+                // Retrieve the update region before BeginPaint validates it.
+                // Windows that don't want the region use the bounding
+                // rectangle from BeginPaint, which doesn't create a region.
+                BOOL wantsRegion = WantsUpdateRegion();
+                CUpdateRegion region;
+                if (wantsRegion)
+                    region.SetUpdateRgn(*this);
+
                 CPaintDC dc(*this);
-                OnDraw(dc);
+                if (!wantsRegion)
+                    region.SetRect(dc.GetPaintStruct()->rcPaint);
+
+                OnDrawRegion(dc, region);
             }
             else
             // RedrawWindow can require repainting without an update rect.
             {
                 CClientDC dc(*this);
-                OnDraw(dc);
+                OnDrawRegion(dc, CUpdateRegion(GetClientRect()));
             }
 
             // No more drawing required
@@ -840,8 +900,12 @@ namespace Win32xx
     // translated before normal processing. Function which translate messages
     // include TranslateAccelerator, TranslateMDISysAccel and IsDialogMessage.
     // Return TRUE if the message is translated.
+    // Note: The message loop only calls this function for windows that have
+    //       called EnablePreTranslate.
     inline BOOL CWnd::PreTranslateMessage(MSG&)
     {
+        // Used by debug builds to detect overrides that aren't enabled.
+        m_isBasePreTranslated = TRUE;
         return FALSE;
     }
 
@@ -886,15 +950,56 @@ namespace Win32xx
         CWinApp* pApp = CWinApp::SetnGetThis();
         if (pApp != NULL)          // Is the CWinApp object still valid?
         {
-            // Erase the CWnd pointer entry from the map.
             CThreadLock mapLock(pApp->m_wndLock);
-            for (m = pApp->m_mapHWND.begin(); m != pApp->m_mapHWND.end(); ++m)
+
+            // Remove the window property if it refers to this CWnd.
+            if (m_wnd != 0 && pApp->m_wndProp != 0)
+            {
+                if (::GetProp(m_wnd, MAKEINTATOM(pApp->m_wndProp)) == this)
+                    ::RemoveProp(m_wnd, MAKEINTATOM(pApp->m_wndProp));
+            }
+
+            // Erase the CWnd pointer entry from the map.
+            m = pApp->m_mapHWND.find(m_wnd);
+            if (m != pApp->m_mapHWND.end())
             {
+                // Temporary CWnd objects share the handle but aren't in the map.
                 if (this == m->second)
                 {
                     pApp->m_mapHWND.erase(m);
                     success = TRUE;
-                    break;
+                }
+            }
+            else
+            {
+                // The window handle might be stale, so search the entire map.
+                for (m = pApp->m_mapHWND.begin(); m != pApp->m_mapHWND.end(); ++m)
+                {
+                    if (this == m->second)
+                    {
+                        pApp->m_mapHWND.erase(m);
+                        success = TRUE;
+                        break;
+                    }
+                }
+            }
+
+            // The window handle can no longer be used by a cached pre-translation
+            // chain. Only windows with pre-translation enabled are in a chain,
+            // so other windows only invalidate this thread's chain if it was
+            // built for their handle, as the handle can be reused.
+            if (success)
+            {
+                if (m_isPreTranslateEnabled)
+                    pApp->ResetPreTranslateChains();
+                else
+                {
+                    TLSData* pTLSData = pApp->GetTlsData();
+                    if (pTLSData && pTLSData->preTranslateWnd == m_wnd)
+                    {
+                        pTLSData->preTranslateChain.clear();
+                        pTLSData->preTranslateWnd = 0;
+                    }
                 }
             }
         }
@@ -974,6 +1079,41 @@ namespace Win32xx
             return 0;
         }
 
+#ifndef NO_DISPATCH_PROFILER
+        CWinApp* pApp = GetApp();
+        TLSData* pProfileData = pApp->IsDispatchProfileEnabled() ? pApp->GetTlsData() : NULL;
+
+        // Each dispatch is timed. The time taken by the dispatches nested
+        // within it, such as those of SendMessage calls or a modal loop, is
+        // subtracted, so it isn't counted twice.
+        if (pProfileData)
+        {
+            // The class atom is retrieved first, as WndProc can destroy the window.
+            ATOM classAtom = static_cast<ATOM>(::GetClassLongPtr(wnd, GCW_ATOM));
+            DispatchProfile& profile = pProfileData->profile;
+            LONGLONG parentChildTicks = profile.childTicks;
+            profile.childTicks = 0;
+            LONGLONG start = CWinApp::GetProfileCounter();
+            LRESULT result = 0;
+            try
+            {
+                result = w->WndProc(msg, wparam, lparam);
+            }
+            catch (...)
+            {
+                profile.childTicks = parentChildTicks + (CWinApp::GetProfileCounter() - start);
+                throw;
+            }
+
+            LONGLONG ticks = CWinApp::GetProfileCounter() - start;
+            LONGLONG selfTicks = ticks - profile.childTicks;
+            profile.childTicks = parentChildTicks + ticks;
+
+            pApp->RecordWndProc(*pProfileData, wnd, classAtom, msg, selfTicks);
+            return result;
+        }
+#endif
+
         return w->WndProc(msg, wparam, lparam);
 
     } // LRESULT CALLBACK StaticWindowProc(...)
@@ -1029,6 +1169,15 @@ namespace Win32xx
         return ok;
     }
 
+    // Override this function to return TRUE if OnDrawRegion uses the
+    // rectangles of the update region. Retrieving the update region's
+    // rectangles for each WM_PAINT takes several GDI calls, so by default
+    // OnDrawRegion only receives the bounding rectangle.
+    inline BOOL CWnd::WantsUpdateRegion() const
+    {
+        return FALSE;
+    }
+
     // Processes this window's message. Override this function in your class
     // derived from CWnd to handle window messages.
     inline LRESULT CWnd::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
@@ -1119,7 +1268,7 @@ namespace Win32xx
 
         case WM_ERASEBKGND:
             {
-                CDC dc(reinterpret_cast<HDC>(wparam));
+                CDCView dc(reinterpret_cast<HDC>(wparam));
                 BOOL preventErasure;
 
                 preventErasure = OnEraseBkgnd(dc);
@@ -1149,6 +1298,17 @@ namespace Win32xx
             }
             break;              // Do default processing when message not already processed.
 
+        case WM_SETTINGCHANGE:
+        case WM_SYSCOLORCHANGE:
+            // Cached pens, brushes and fonts might use the old colors or fonts.
+            GetApp()->TrimGDICache();
+            break;
+
+        case WM_DISPLAYCHANGE:
+            // The paint buffer's bitmap might not match the new display format.
+            GetApp()->TrimPaintBuffer();
+            break;
+
         case UWM_UPDATECOMMAND:
             OnMenuUpdate(static_cast<UINT>(wparam)); // Perform menu updates.
             break;
@@ -2174,7 +2334,11 @@ namespace Win32xx
     inline HWND CWnd::SetParent(HWND parent) const
     {
         assert(IsWindow());
-        return ::SetParent(*this, parent);
+        HWND oldParent = ::SetParent(*this, parent);
+
+        // The window's ancestors have changed.
+        GetApp()->ResetPreTranslateChains();
+        return oldParent;
     }
 
     // This function allows changes in that window to be redrawn or prevents changes
@@ -2429,17 +2593,13 @@ namespace Win32xx
     template <class T>
     inline void CStringT<T>::AppendFormat(UINT formatID, ...)
     {
-        CStringT str1;
-        CStringT str2;
-
-        if (str1.LoadString(formatID))
+        CStringT str;
+        if (str.LoadString(formatID))
         {
             va_list args;
             va_start(args, formatID);
-            str2.FormatV(str1.c_str(), args);
+            AppendFormatV(str.c_str(), args);
             va_end(args);
-
-            m_str.append(str2);
         }
     }
 
@@ -77,6 +77,7 @@
 #define UWM_TBRESIZE          (WM_APP + 0x3F17) // Message - sent by toolbar to parent. Used by the rebar.
 #define UWM_TBWINPOSCHANGING  (WM_APP + 0x3F18) // Message - sent to parent. Toolbar is resizing.
 #define UWM_UPDATECOMMAND     (WM_APP + 0x3F19) // Message - sent before a menu is displayed. Used by OnMenuUpdate.
+#define UWM_RUNTASKS          (WM_APP + 0x3F1A) // Message - posted to a message loop's task window to run the posted tasks.
 
 #define UWN_BARSTART          (WM_APP + 0x3F20) // Notification - sent by CDocker when the docker bar selected for move.
 #define UWN_BARMOVE           (WM_APP + 0x3F21) // Notification - sent by CDocker when the docker bar is moved.
@@ -152,6 +153,8 @@ namespace Win32xx
         // Accessors
         HWND GetHwnd() const                { return m_wnd; }
         WNDPROC GetPrevWindowProc() const   { return m_prevWindowProc; }
+        BOOL IsPreTranslateEnabled() const  { return m_isPreTranslateEnabled; }
+        void EnablePreTranslate(BOOL enable = TRUE);
 
         // Wrappers for Win32 API functions.
         // These functions aren't virtual, and shouldn't be overridden.
@@ -307,6 +310,7 @@ namespace Win32xx
         virtual int  OnCreate(CREATESTRUCT& cs);
         virtual void OnDestroy();
         virtual void OnDraw(CDC& dc);
+        virtual void OnDrawRegion(CDC& dc, const CUpdateRegion& region);
         virtual BOOL OnEraseBkgnd(CDC& dc);
         virtual void OnInitialUpdate();
         virtual void OnMenuUpdate(UINT id);
@@ -317,6 +321,7 @@ namespace Win32xx
         virtual void PreCreate(CREATESTRUCT& cs);
         virtual void PreRegisterClass(WNDCLASS& wc);
         virtual BOOL PreTranslateMessage(MSG& msg);
+        virtual BOOL WantsUpdateRegion() const;
         virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
 
         // Not intended to be overridden
@@ -338,6 +343,9 @@ namespace Win32xx
 
         HWND m_wnd;                    // handle to this object's window
         WNDPROC m_prevWindowProc;
+        BOOL m_isPreTranslateEnabled;  // TRUE if the message loop calls PreTranslateMessage
+        BOOL m_isBasePreTranslated;    // TRUE if CWnd::PreTranslateMessage was called (debug builds)
+        BOOL m_isPreTranslateReported; // TRUE if a missing EnablePreTranslate was reported (debug builds)
     }; // class CWnd
 
 } // namespace Win32xx
@@ -0,0 +1,1012 @@
+/////////////////////////////
+// Benchmark.cpp
+//
+
+#include "stdafx.h"
+#include "Benchmark.h"
+#include "TestWnd.h"
+
+
+// The number of calls to operator new. The global operator new is replaced
+// so the benchmarks can report the heap allocations they make.
+static LONG g_heapAllocs = 0;
+
+void* operator new(size_t size)
+{
+    ::InterlockedIncrement(&g_heapAllocs);
+    void* p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void* p) WXX_NOEXCEPT
+{
+    free(p);
+}
+
+
+//////////////////////////////////
+// CBenchmark function definitions
+//
+
+// Constructor.
+CBenchmark::CBenchmark() : m_dockers(16), m_failures(0), m_heapAllocs(0), m_scale(1)
+{
+    LARGE_INTEGER li;
+    VERIFY(QueryPerformanceFrequency(&li));
+    m_frequency = li.QuadPart;
+}
+
+// Records the result of a benchmark that began at start.
+void CBenchmark::AddResult(LPCTSTR name, long iterations, LONGLONG start, double bytes)
+{
+    LONGLONG end = GetCounter();
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.milliseconds = 1000.0 * (end - start) / m_frequency;
+    result.bytes = bytes;
+
+    // Record the CDC and CGDIObject data allocations since the last result.
+    GDIDataStats stats = GetApp()->GetGDIDataStats();
+    result.gdiAllocs = static_cast<double>(stats.heapAllocs + stats.mapInserts);
+    GetApp()->ResetGDIDataStats();
+
+    // Record the heap allocations since the last result.
+    result.heapAllocs = static_cast<double>(g_heapAllocs - m_heapAllocs);
+
+    m_results.push_back(result);
+    m_heapAllocs = g_heapAllocs;
+}
+
+// Checks that a benchmark made no more than maxAllocs heap allocations.
+void CBenchmark::CheckAllocs(LPCTSTR name, LONG allocs, LONG maxAllocs)
+{
+    if (allocs > maxAllocs)
+    {
+        std::cerr << TtoA(name) << " made " << allocs << " heap allocations, expected at most "
+                  << maxAllocs << std::endl;
+        ++m_failures;
+    }
+}
+
+// Checks that the GDI objects, device contexts and their data created since
+// the snapshot was taken have been destroyed.
+void CBenchmark::CheckResources(LPCTSTR name, const ResourceSnapshot& before)
+{
+    ResourceSnapshot after = GetApp()->GetResourceSnapshot();
+    for (int type = 0; type <= RESOURCE_GDI_DATA; ++type)
+    {
+        LONG leaked = after.resources[type].count - before.resources[type].count;
+        if (leaked != 0)
+        {
+            std::cerr << TtoA(name) << " leaked " << leaked << " "
+                      << TtoA(GetApp()->GetResourceName(static_cast<ResourceType>(type))) << std::endl;
+            ++m_failures;
+        }
+    }
+}
+
+// A task for the thread pool benchmark. Counts down the remaining tasks.
+void WINAPI CBenchmark::CountTask(LPVOID pRemaining)
+{
+    ::InterlockedDecrement(static_cast<LONG*>(pRemaining));
+}
+
+// Fills a range of the buffer for the parallel for benchmark.
+void WINAPI CBenchmark::FillRange(int first, int last, LPVOID pBuffer)
+{
+    std::vector<DWORD>& buffer = *static_cast<std::vector<DWORD>*>(pBuffer);
+    for (int i = first; i < last; ++i)
+        buffer[i] = static_cast<DWORD>(i) * 2654435761U;
+}
+
+// Formats str with the printf style FormatV.
+void CBenchmark::FormatPrintf(CString& str, LPCTSTR format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    str.FormatV(format, args);
+    va_end(args);
+}
+
+// Returns the results in CSV format.
+CString CBenchmark::GetCSV() const
+{
+    CString csv = _T("name,iterations,total_ms,ns_per_op,mb_per_sec,gdi_allocs_per_op,heap_allocs_per_op\n");
+    std::vector<BenchResult>::const_iterator it;
+    for (it = m_results.begin(); it != m_results.end(); ++it)
+    {
+        double nsPerOp = (*it).iterations ? 1000000.0 * (*it).milliseconds / (*it).iterations : 0.0;
+        double mbPerSec = ((*it).milliseconds > 0) ? (*it).bytes / (1048.576 * (*it).milliseconds) : 0.0;
+        double allocsPerOp = (*it).iterations ? (*it).gdiAllocs / (*it).iterations : 0.0;
+        double heapAllocsPerOp = (*it).iterations ? (*it).heapAllocs / (*it).iterations : 0.0;
+
+        CString line;
+        line.Format(_T("%s,%ld,%.3f,%.3f,%.3f,%.3f,%.3f\n"), (*it).name.c_str(), (*it).iterations,
+            (*it).milliseconds, nsPerOp, mbPerSec, allocsPerOp, heapAllocsPerOp);
+        csv += line;
+    }
+
+    return csv;
+}
+
+// Returns the results in JSON format.
+CString CBenchmark::GetJSON() const
+{
+    CString json;
+    json.Format(_T("{\n  \"win32xx_version\": \"0x%04x\",\n  \"scale\": %d,\n  \"dockers\": %d,\n  \"results\": [\n"),
+        _WIN32XX_VER, m_scale, m_dockers);
+
+    std::vector<BenchResult>::const_iterator it;
+    for (it = m_results.begin(); it != m_results.end(); ++it)
+    {
+        double nsPerOp = (*it).iterations ? 1000000.0 * (*it).milliseconds / (*it).iterations : 0.0;
+        double mbPerSec = ((*it).milliseconds > 0) ? (*it).bytes / (1048.576 * (*it).milliseconds) : 0.0;
+        double allocsPerOp = (*it).iterations ? (*it).gdiAllocs / (*it).iterations : 0.0;
+        double heapAllocsPerOp = (*it).iterations ? (*it).heapAllocs / (*it).iterations : 0.0;
+
+        CString entry;
+        entry.Format(_T("    { \"name\": \"%s\", \"iterations\": %ld, \"total_ms\": %.3f, \"ns_per_op\": %.3f, \"mb_per_sec\": %.3f, \"gdi_allocs_per_op\": %.3f, \"heap_allocs_per_op\": %.3f }%s\n"),
+            (*it).name.c_str(), (*it).iterations, (*it).milliseconds, nsPerOp, mbPerSec, allocsPerOp, heapAllocsPerOp,
+            (it + 1 == m_results.end()) ? _T("") : _T(","));
+        json += entry;
+    }
+
+    json += _T("  ]\n}\n");
+    return json;
+}
+
+// Retrieves the current performance counter.
+LONGLONG CBenchmark::GetCounter() const
+{
+    LARGE_INTEGER current;
+    QueryPerformanceCounter(&current);
+    return current.QuadPart;
+}
+
+// Receives data on the socket until the peer disconnects.
+UINT WINAPI CBenchmark::ReceiveThread(LPVOID pParams)
+{
+    ReceiveParams* pReceive = static_cast<ReceiveParams*>(pParams);
+    std::vector<char> buffer(65536);
+
+    int received = 0;
+    while ((received = pReceive->pSocket->Receive(&buffer[0], static_cast<int>(buffer.size()), 0)) > 0)
+        pReceive->bytes += received;
+
+    return 0;
+}
+
+// Runs each of the benchmarks.
+void CBenchmark::RunAll()
+{
+    m_results.clear();
+    m_failures = 0;
+    m_heapAllocs = g_heapAllocs;
+
+    TestDispatch();
+    TestCreateDestroy();
+
+    // The pens cached by TestGDI are released before checking for leaks.
+    ResourceSnapshot before = GetApp()->GetResourceSnapshot();
+    TestGDI();
+    GetApp()->TrimGDICache();
+    CheckResources(_T("gdi"), before);
+
+    TestPixels();
+    TestResample();
+    TestCString();
+    TestStringBuilder();
+    TestArchive();
+    TestSocket();
+    TestTextConv();
+    TestDocking();
+    TestThreadPool();
+}
+
+// Times storing and loading records with CArchive.
+void CBenchmark::TestArchive()
+{
+    TCHAR path[MAX_PATH];
+    TCHAR fileName[MAX_PATH];
+    VERIFY(::GetTempPath(MAX_PATH, path));
+    VERIFY(::GetTempFileName(path, _T("wxx"), 0, fileName));
+
+    const long records = 200000 * m_scale;
+    const CString text = _T("The quick brown fox jumps over the lazy dog");
+
+    int i;
+    LONGLONG start = GetCounter();
+    {
+        CArchive ar(fileName, CArchive::store);
+        for (i = 0; i < records; ++i)
+            ar << i << 1.5 << text;
+    }
+
+    CFile file(fileName, CFile::modeRead);
+    double bytes = static_cast<double>(file.GetLength());
+    file.Close();
+    AddResult(_T("archive_store"), records, start, bytes);
+
+    start = GetCounter();
+    {
+        CArchive ar(fileName, CArchive::load);
+        int value;
+        double number;
+        CString str;
+        for (i = 0; i < records; ++i)
+            ar >> value >> number >> str;
+    }
+    AddResult(_T("archive_load"), records, start, bytes);
+
+    ::DeleteFile(fileName);
+}
+
+// Times creating and destroying a message-only window.
+void CBenchmark::TestCreateDestroy()
+{
+    const long windows = 2000 * m_scale;
+
+    LONGLONG start = GetCounter();
+    for (int i = 0; i < windows; ++i)
+    {
+        CTestWindow testWindow;
+        testWindow.CreateWin();
+        testWindow.Destroy();
+    }
+    AddResult(_T("window_create_destroy"), windows, start);
+}
+
+// Times common CString operations.
+void CBenchmark::TestCString()
+{
+    const long operations = 1000000 * m_scale;
+    CString str;
+
+    int i;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < operations; ++i)
+    {
+        str += _T("text");
+        if (str.GetLength() > 4096)
+            str.Empty();
+    }
+    AddResult(_T("cstring_append"), operations, start);
+
+    // Formatting reuses the string's buffer, so it makes no heap allocations.
+    str.Format(_T("%d %s %.2f"), 0, _T("text"), 1.5);
+    LONG allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+        str.Format(_T("%d %s %.2f"), i, _T("text"), 1.5);
+
+    CheckAllocs(_T("cstring_format"), g_heapAllocs - allocs, 0);
+    AddResult(_T("cstring_format"), operations, start);
+
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+        FormatPrintf(str, _T("%d %s %.2f"), i, _T("text"), 1.5);
+
+    CheckAllocs(_T("cstring_formatv"), g_heapAllocs - allocs, 0);
+    AddResult(_T("cstring_formatv"), operations, start);
+
+#ifdef WXX_VARIADIC_TEMPLATES
+    // FormatT formats the integer and string specifiers itself.
+    str.FormatT(_T("%d %s %x"), 0, _T("text"), 15);
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+        str.FormatT(_T("%d %s %x"), i, _T("text"), 15);
+
+    CheckAllocs(_T("cstring_formatt"), g_heapAllocs - allocs, 0);
+    AddResult(_T("cstring_formatt"), operations, start);
+#endif
+
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+    {
+        str.AppendFormat(_T("%02d:%02d:%02d "), i % 24, i % 60, i % 60);
+        if (str.GetLength() > 4096)
+            str.Empty();
+    }
+    AddResult(_T("cstring_appendformat"), operations, start);
+
+    // Check that Format, FormatT and FormatV produce the same text.
+    const double values[] = { 0.0, 1.5, -2.25, 0.125, 3.14159265, -1e-3, 12345678.9 };
+    for (i = 0; i < 7; ++i)
+    {
+        CString formatted;
+        CString expected;
+#ifdef WXX_VARIADIC_TEMPLATES
+        formatted.FormatT(_T("[%d|%5d|%-4x|%08.3f|%.2f|%f|%s|%hd]"), i - 3, i * 1000, i * 37, values[i], values[i], values[i], CString(_T("text")), i * 30000);
+#else
+        formatted.Format(_T("[%d|%5d|%-4x|%08.3f|%.2f|%f|%s|%hd]"), i - 3, i * 1000, i * 37, values[i], values[i], values[i], _T("text"), i * 30000);
+#endif
+        FormatPrintf(expected, _T("[%d|%5d|%-4x|%08.3f|%.2f|%f|%s|%hd]"), i - 3, i * 1000, i * 37, values[i], values[i], values[i], _T("text"), i * 30000);
+        if (formatted != expected)
+        {
+            std::cerr << "cstring_format produced " << TtoA(formatted) << " rather than " << TtoA(expected) << std::endl;
+            ++m_failures;
+        }
+    }
+
+    CString text;
+    for (i = 0; i < 32; ++i)
+        text += _T("The quick brown fox jumps over the lazy dog. ");
+
+    const long searches = operations / 10;
+    start = GetCounter();
+    for (i = 0; i < searches; ++i)
+        VERIFY(text.Find(_T("lazy cat")) < 0);
+
+    AddResult(_T("cstring_find"), searches, start);
+
+    start = GetCounter();
+    for (i = 0; i < searches; ++i)
+    {
+        str = text;
+        str.Replace(_T("fox"), _T("wolf"));
+    }
+    AddResult(_T("cstring_replace"), searches, start);
+
+    // Search, replace and change the case of a 1.4 MB document.
+    CString document;
+    for (i = 0; i < 1024; ++i)
+        document += text;
+
+    const long passes = 20 * m_scale;
+    double bytes = static_cast<double>(passes) * document.GetLength() * sizeof(TCHAR);
+    start = GetCounter();
+    for (i = 0; i < passes; ++i)
+        VERIFY(document.Find(_T("fox jumps over the lazy dog. The quick brown cat")) < 0);
+
+    AddResult(_T("cstring_find_long"), passes, start, bytes);
+
+    start = GetCounter();
+    for (i = 0; i < passes; ++i)
+    {
+        str = document;
+        VERIFY(str.Replace(_T("fox"), _T("wolf")) == 32 * 1024);
+    }
+    AddResult(_T("cstring_replace_many"), passes, start, bytes);
+
+    start = GetCounter();
+    for (i = 0; i < passes; ++i)
+    {
+        str = document;
+        VERIFY(str.Remove(_T("quick ")) == 32 * 1024);
+    }
+    AddResult(_T("cstring_remove"), passes, start, bytes);
+
+    start = GetCounter();
+    for (i = 0; i < passes; ++i)
+    {
+        str = document;
+        str.MakeUpper();
+        str.MakeLower();
+    }
+    AddResult(_T("cstring_change_case"), passes, start, bytes);
+
+    // Check Find and Replace against std::basic_string.
+    const std::basic_string<TCHAR>& source = text.GetString();
+    const LPCTSTR needles[] = { _T("T"), _T("dog. "), _T("lazy cat"), _T("over the lazy dog. The quick brown fox jumps over") };
+    for (i = 0; i < 4; ++i)
+    {
+        size_t found = source.find(needles[i], 10);
+        std::basic_string<TCHAR> expected = source;
+        size_t pos = 0;
+        while ((pos = expected.find(needles[i], pos)) != std::basic_string<TCHAR>::npos)
+        {
+            expected.replace(pos, static_cast<size_t>(lstrlen(needles[i])), _T("<>"));
+            pos += 2;
+        }
+
+        str = text;
+        str.Replace(needles[i], _T("<>"));
+        if (text.Find(needles[i], 10) != static_cast<int>(found) || str.GetString() != expected)
+        {
+            std::cerr << "cstring_find produced a different result for search " << i << std::endl;
+            ++m_failures;
+        }
+    }
+
+    // GetBuffer and ReleaseBuffer write the string in place, so a round trip
+    // within the string's capacity makes no heap allocations.
+    str = text;
+    str.GetBuffer(64);
+    str.ReleaseBuffer();
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+    {
+        LPTSTR buffer = str.GetBuffer(64);
+        buffer[0] = _T('T');
+        str.ReleaseBuffer();
+    }
+    CheckAllocs(_T("cstring_getbuffer"), g_heapAllocs - allocs, 0);
+    AddResult(_T("cstring_getbuffer"), operations, start);
+
+    // Mid allocates its result. With move semantics the result is
+    // moved rather than copied into str.
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < searches; ++i)
+        str = text.Mid(4, 40);
+
+#ifdef WXX_MOVE_SEMANTICS
+    CheckAllocs(_T("cstring_mid"), g_heapAllocs - allocs, searches);
+#endif
+    AddResult(_T("cstring_mid"), searches, start);
+
+#ifdef WXX_MOVE_SEMANTICS
+    // Moving a CString transfers its buffer without allocating.
+    CString moved = text;
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+    {
+        str = std::move(moved);
+        moved = std::move(str);
+    }
+    CheckAllocs(_T("cstring_move"), g_heapAllocs - allocs, 0);
+    AddResult(_T("cstring_move"), operations, start);
+#endif
+}
+
+// Times the dispatch of messages to message-only windows.
+void CBenchmark::TestDispatch()
+{
+    CTestWindow testWindow;
+    CMapTestWindow mapTestWindow;
+    testWindow.CreateWin();
+    mapTestWindow.CreateWin();
+
+    const long messages = 1000000 * m_scale;
+    const long dispatches = 10000000 * m_scale;
+
+    int i;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < messages; ++i)
+        testWindow.SendMessage(WM_TESTMESSAGE, 0, 0);
+
+    AddResult(_T("dispatch_sendmessage"), messages, start);
+
+    start = GetCounter();
+    for (i = 0; i < dispatches; ++i)
+        testWindow.Dispatch(WM_TESTMESSAGE, 0, 0);
+
+    AddResult(_T("dispatch_switch"), dispatches, start);
+
+    start = GetCounter();
+    for (i = 0; i < dispatches; ++i)
+        mapTestWindow.Dispatch(WM_TESTMESSAGE, 0, 0);
+
+    AddResult(_T("dispatch_messagemap"), dispatches, start);
+}
+
+// Times creating dockers and recalculating the dock layout.
+void CBenchmark::TestDocking()
+{
+    // The dock ancestor is a child of a hidden top level window.
+    CWnd host;
+    host.CreateEx(0, NULL, _T("Docking Host"), WS_OVERLAPPEDWINDOW, 0, 0, 800, 600, 0, NULL);
+
+    CTestDocker dockAncestor;
+    std::vector<CDocker*> dockers;
+    const DWORD sides[] = { DS_DOCKED_LEFT, DS_DOCKED_TOP, DS_DOCKED_RIGHT, DS_DOCKED_BOTTOM };
+
+    LONGLONG start = GetCounter();
+    dockAncestor.Create(host);
+    dockAncestor.MoveWindow(0, 0, 800, 600, FALSE);
+
+    // Arrange the dockers as a binary tree.
+    int i;
+    for (i = 0; i < m_dockers; ++i)
+    {
+        CDocker* pParent = (i == 0) ? &dockAncestor : dockers[(i - 1) / 2];
+        dockers.push_back(pParent->AddDockedChild(new CTestDocker, sides[i % 4], 40, i + 1));
+    }
+    AddResult(_T("docking_create"), m_dockers, start);
+
+    const long layouts = 200 * m_scale;
+    start = GetCounter();
+    for (i = 0; i < layouts; ++i)
+    {
+        dockAncestor.MoveWindow(0, 0, 800 - (i % 100), 600 - (i % 100), FALSE);
+        dockAncestor.RecalcDockLayout();
+    }
+    AddResult(_T("docking_layout"), layouts, start);
+
+    start = GetCounter();
+    dockAncestor.Destroy();
+    AddResult(_T("docking_destroy"), m_dockers, start);
+}
+
+// Times the construction of CDC, CBrush and CPen objects.
+void CBenchmark::TestGDI()
+{
+    const long objects = 100000 * m_scale;
+
+    int i;
+    GetApp()->ResetGDIDataStats();
+    LONGLONG start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        CMemDC dc(NULL);
+    }
+    AddResult(_T("gdi_cmemdc"), objects, start);
+
+    start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        CBrush brush(RGB(i & 0xFF, 0, 0));
+    }
+    AddResult(_T("gdi_cbrush"), objects, start);
+
+    start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        CPen pen(PS_SOLID, 1, RGB(0, i & 0xFF, 0));
+    }
+    AddResult(_T("gdi_cpen"), objects, start);
+
+    CMemDC dc(NULL);
+    start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        CPen pen(PS_SOLID, 1, RGB(0, 0, i & 0xFF));
+        HPEN oldPen = dc.SelectObject(pen);
+        dc.SelectObject(oldPen);
+    }
+    AddResult(_T("gdi_select_pen"), objects, start);
+
+    // Select pens with a few colors, as a redraw typically does.
+    // After the first few, the pens are retrieved from the GDI cache.
+    GetApp()->TrimGDICache();
+    start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        dc.CreatePen(PS_SOLID, 1, RGB(0, 0, i & 0x0F));
+    }
+    AddResult(_T("gdi_cached_pen"), objects, start);
+
+    // Wrap a HDC the CDC doesn't own, as done for WM_ERASEBKGND and owner drawing.
+    HDC borrowedDC = ::CreateCompatibleDC(NULL);
+    GetApp()->ResetGDIDataStats();
+    start = GetCounter();
+    for (i = 0; i < objects; ++i)
+    {
+        CDC borrowed(borrowedDC);
+        borrowed.SetBkMode(TRANSPARENT);
+    }
+    AddResult(_T("gdi_borrowed_dc"), objects, start);
+    ::DeleteDC(borrowedDC);
+}
+
+// Times the pixel operations used by CBitmap with each instruction set,
+// and checks that the SIMD versions produce the same pixels as the
+// scalar version.
+void CBenchmark::TestPixels()
+{
+    const CPixelOperation::Operation operations[] =
+        { CPixelOperation::GRAYSCALE, CPixelOperation::TINT, CPixelOperation::DISABLED };
+    const LPCTSTR operationNames[] = { _T("gray"), _T("tint"), _T("disabled") };
+    const LPCTSTR simdNames[] = { _T("scalar"), _T("sse2"), _T("avx2") };
+
+    // A full HD image. The width of the image that's checked isn't a
+    // multiple of 8, so the scalar code finishes each row.
+    const int width = 1920;
+    const int height = 1080;
+    const int checkWidth = 1917;
+    const long passes = 10 * m_scale;
+    const double bytes = 4.0 * width * height * passes;
+
+    std::vector<BYTE> source(size_t(width) * height * 4);
+    for (size_t i = 0; i < source.size(); ++i)
+        source[i] = static_cast<BYTE>((i * 2654435761U) >> 24);
+
+    // Every 16th pixel has the color of the mask.
+    const COLORREF mask = RGB(192, 192, 192);
+    for (size_t pixel = 0; pixel < source.size(); pixel += 64)
+        source[pixel] = source[pixel + 1] = source[pixel + 2] = 192;
+
+    for (int op = 0; op < 3; ++op)
+    {
+        std::vector<BYTE> expected;
+        for (int simd = PIXEL_SCALAR; simd <= CPixelOperation::GetSupportedSIMD(); ++simd)
+        {
+            // Check the result matches the scalar version's.
+            std::vector<BYTE> pixels(source);
+            CPixelOperation check(operations[op], &pixels[0], checkWidth, height);
+            check.SetMask(mask);
+            check.SetTint(-64, -24, 128);
+            check.SetSIMD(static_cast<PixelSIMD>(simd));
+            check.ProcessRows(0, height);
+            if (simd == PIXEL_SCALAR)
+                expected = pixels;
+            else if (pixels != expected)
+            {
+                std::cerr << "pixel_" << TtoA(operationNames[op]) << "_" << TtoA(simdNames[simd])
+                          << " differs from the scalar version" << std::endl;
+                ++m_failures;
+            }
+
+            // Time the operation on one thread.
+            pixels = source;
+            CPixelOperation operation(operations[op], &pixels[0], width, height);
+            operation.SetMask(mask);
+            operation.SetTint(-64, -24, 128);
+            operation.SetSIMD(static_cast<PixelSIMD>(simd));
+            LONGLONG start = GetCounter();
+            for (long pass = 0; pass < passes; ++pass)
+                operation.ProcessRows(0, height);
+
+            CString name;
+            name.Format(_T("pixel_%s_%s"), operationNames[op], simdNames[simd]);
+            AddResult(name, passes, start, bytes);
+        }
+
+        // Time the operation with the fastest instruction set on the thread pool.
+        std::vector<BYTE> pixels(source);
+        CPixelOperation operation(operations[op], &pixels[0], width, height);
+        operation.SetMask(mask);
+        operation.SetTint(-64, -24, 128);
+        LONGLONG start = GetCounter();
+        for (long pass = 0; pass < passes; ++pass)
+            operation.Process();
+
+        CString name;
+        name.Format(_T("pixel_%s_parallel"), operationNames[op]);
+        AddResult(name, passes, start, bytes);
+    }
+
+    // Tint a device dependent bitmap, which copies its pixels with
+    // GetDIBits and SetDIBits, and a DIB section, which is tinted in place.
+    CClientDC desktopDC(HWND_DESKTOP);
+    CBitmap ddb;
+    ddb.CreateCompatibleBitmap(desktopDC, width, height);
+    LONGLONG start = GetCounter();
+    for (long pass = 0; pass < passes; ++pass)
+        ddb.TintBitmap(-64, -24, 128);
+    AddResult(_T("bitmap_tint_ddb"), passes, start, bytes);
+
+    CDIBSection dib(width, height);
+    start = GetCounter();
+    for (long pass = 0; pass < passes; ++pass)
+        dib.TintBitmap(-64, -24, 128);
+    AddResult(_T("bitmap_tint_dibsection"), passes, start, bytes);
+}
+
+// Times scaling an image to a thumbnail with each filter and instruction
+// set, and checks that the SSE2 version produces the same pixels as the
+// scalar version. StretchBlt with HALFTONE is timed for comparison.
+void CBenchmark::TestResample()
+{
+    const ResampleFilter filters[] = { RESAMPLE_BOX, RESAMPLE_BILINEAR, RESAMPLE_LANCZOS3 };
+    const LPCTSTR filterNames[] = { _T("box"), _T("bilinear"), _T("lanczos3") };
+    const LPCTSTR simdNames[] = { _T("scalar"), _T("sse2") };
+
+    // Scale a full HD image to a quarter of its size. The width of the
+    // image that's checked isn't a multiple of 4, so the scalar code
+    // finishes each row.
+    const int width = 1920;
+    const int height = 1080;
+    const int thumbWidth = 480;
+    const int thumbHeight = 270;
+    const int checkWidth = 477;
+    const long passes = 10 * m_scale;
+    const double bytes = 4.0 * width * height * passes;
+
+    CDIBSection source(width, height);
+    CDIBView sourceView = source.GetView();
+    for (int row = 0; row < height; ++row)
+    {
+        BYTE* pRow = reinterpret_cast<BYTE*>(sourceView.GetRow(row));
+        for (int i = 0; i < width * 4; ++i)
+            pRow[i] = static_cast<BYTE>(((row * width * 4 + i) * 2654435761U) >> 24);
+    }
+
+    CDIBSection thumb(thumbWidth, thumbHeight);
+    const PixelSIMD supported = MIN(CPixelOperation::GetSupportedSIMD(), PIXEL_SSE2);
+    for (int filter = 0; filter < 3; ++filter)
+    {
+        std::vector<BYTE> expected;
+        for (int simd = PIXEL_SCALAR; simd <= supported; ++simd)
+        {
+            CResampler resampler(filters[filter]);
+            resampler.SetSIMD(static_cast<PixelSIMD>(simd));
+
+            // Check the result matches the scalar version's.
+            std::vector<BYTE> pixels(size_t(checkWidth) * thumbHeight * 4);
+            resampler.Resample(sourceView, CDIBView(&pixels[0], checkWidth, thumbHeight, checkWidth * 4));
+            if (simd == PIXEL_SCALAR)
+                expected = pixels;
+            else if (pixels != expected)
+            {
+                std::cerr << "resample_" << TtoA(filterNames[filter]) << "_" << TtoA(simdNames[simd])
+                          << " differs from the scalar version" << std::endl;
+                ++m_failures;
+            }
+
+            LONGLONG start = GetCounter();
+            for (long pass = 0; pass < passes; ++pass)
+                resampler.Resample(sourceView, thumb.GetView());
+
+            CString name;
+            name.Format(_T("resample_%s_%s"), filterNames[filter], simdNames[simd]);
+            AddResult(name, passes, start, bytes);
+        }
+    }
+
+    CMemDC sourceDC(0);
+    sourceDC.SelectObject(source);
+    CMemDC thumbDC(0);
+    thumbDC.SelectObject(thumb);
+    thumbDC.SetStretchBltMode(HALFTONE);
+    thumbDC.SetBrushOrgEx(0, 0);
+    LONGLONG start = GetCounter();
+    for (long pass = 0; pass < passes; ++pass)
+        thumbDC.StretchBlt(0, 0, thumbWidth, thumbHeight, sourceDC, 0, 0, width, height, SRCCOPY);
+    AddResult(_T("resample_stretchblt_halftone"), passes, start, bytes);
+}
+
+// Times sending data over a loopback TCP connection.
+void CBenchmark::TestSocket()
+{
+    CSocket listener;
+    CSocket sender;
+    CSocket receiver;
+
+    if (!listener.Create(AF_INET, SOCK_STREAM) || !sender.Create(AF_INET, SOCK_STREAM))
+    {
+        TRACE("Failed to create the sockets\n");
+        return;
+    }
+
+    // Bind to any free port on the loopback address.
+    sockaddr_in address;
+    ZeroMemory(&address, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    int length = sizeof(address);
+
+    if (listener.Bind(reinterpret_cast<sockaddr*>(&address), length) == SOCKET_ERROR ||
+        listener.GetSockName(reinterpret_cast<sockaddr*>(&address), &length) == SOCKET_ERROR ||
+        listener.Listen() == SOCKET_ERROR ||
+        sender.Connect(reinterpret_cast<sockaddr*>(&address), length) == SOCKET_ERROR)
+    {
+        TRACE("Failed to connect the loopback sockets\n");
+        return;
+    }
+
+    listener.Accept(receiver, NULL, NULL);
+    if (receiver.GetSocket() == INVALID_SOCKET)
+        return;
+
+    const long chunks = 4096 * m_scale;
+    std::vector<char> buffer(16384, 'x');
+    ReceiveParams params;
+    params.pSocket = &receiver;
+    params.bytes = 0;
+
+    CWorkThread thread(ReceiveThread, &params);
+    LONGLONG start = GetCounter();
+    thread.CreateThread();
+
+    for (int i = 0; i < chunks; ++i)
+    {
+        int sent = 0;
+        while (sent < static_cast<int>(buffer.size()))
+        {
+            int result = sender.Send(&buffer[sent], static_cast<int>(buffer.size()) - sent, 0);
+            if (result == SOCKET_ERROR)
+                break;
+
+            sent += result;
+        }
+    }
+
+    // Closing the sending socket ends the receiving thread.
+    ::shutdown(sender, SD_SEND);
+    ::WaitForSingleObject(thread, INFINITE);
+    AddResult(_T("socket_loopback"), chunks, start, static_cast<double>(params.bytes));
+}
+
+// Times building a report with CStringBuilder, compared to operator + chains.
+void CBenchmark::TestStringBuilder()
+{
+    const long reports = 200 * m_scale;
+    const int lines = 1000;
+    const CString name = _T("The quick brown fox");
+    std::vector<CString> numbers(lines);
+
+    int i;
+    int line;
+    for (line = 0; line < lines; ++line)
+        numbers[line].Format(_T("%d"), line);
+
+    // Each operator + creates a temporary CString.
+    CString chained;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < reports; ++i)
+    {
+        chained.Empty();
+        for (line = 0; line < lines; ++line)
+            chained += _T("Item ") + numbers[line] + _T(": ") + name + _T("\r\n");
+    }
+    AddResult(_T("cstring_concat_chain"), reports, start);
+
+    // Appending never moves the text already added, and ToString copies
+    // the text with a single allocation.
+    CStringBuilder builder;
+    CString built;
+    start = GetCounter();
+    for (i = 0; i < reports; ++i)
+    {
+        builder.Clear();
+        for (line = 0; line < lines; ++line)
+            builder.Append(_T("Item ")).Append(numbers[line]).Append(_T(": ")).AppendLine(name);
+
+        built = builder.ToString();
+    }
+    AddResult(_T("stringbuilder_append"), reports, start);
+
+    if (built != chained)
+    {
+        std::cerr << "stringbuilder_append produced different text from operator +" << std::endl;
+        ++m_failures;
+    }
+
+    CString formatted;
+    start = GetCounter();
+    for (i = 0; i < reports; ++i)
+    {
+        builder.Clear();
+        for (line = 0; line < lines; ++line)
+            builder.AppendFormat(_T("Item %d: %s\r\n"), line, name.c_str());
+
+        builder.MoveTo(formatted);
+    }
+    AddResult(_T("stringbuilder_appendformat"), reports, start);
+
+    if (formatted != chained)
+    {
+        std::cerr << "stringbuilder_appendformat produced different text from operator +" << std::endl;
+        ++m_failures;
+    }
+}
+
+// Times the ANSI, UTF-8 and wide text conversions.
+void CBenchmark::TestTextConv()
+{
+    const long operations = 1000000 * m_scale;
+    const char shortText[] = "The quick brown fox jumps over the lazy dog";
+    const WCHAR shortWide[] = L"The quick brown fox jumps over the lazy dog";
+
+    // Short strings are held within the conversion objects, so converting
+    // them makes no heap allocations.
+    int i;
+    LONG allocs = g_heapAllocs;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < operations; ++i)
+        VERIFY(AtoW(shortText).c_str()[0] == L'T');
+
+    CheckAllocs(_T("textconv_atow_short"), g_heapAllocs - allocs, 0);
+    AddResult(_T("textconv_atow_short"), operations, start);
+
+    allocs = g_heapAllocs;
+    start = GetCounter();
+    for (i = 0; i < operations; ++i)
+        VERIFY(WtoA(shortWide).c_str()[0] == 'T');
+
+    CheckAllocs(_T("textconv_wtoa_short"), g_heapAllocs - allocs, 0);
+    AddResult(_T("textconv_wtoa_short"), operations, start);
+
+    // Build an ASCII document, and a UTF-8 document with accented,
+    // Greek, CJK and emoji characters.
+    std::string ascii;
+    std::string utf8;
+    for (i = 0; i < 1024; ++i)
+    {
+        ascii += shortText;
+        utf8 += shortText;
+        utf8 += " caf\xC3\xA9 \xCE\xB1\xCE\xB2 \xE6\x96\x87\xE5\xAD\x97 \xF0\x9F\x98\x80 ";
+    }
+
+    const long documents = 1000 * m_scale;
+    double bytes = static_cast<double>(documents) * ascii.size();
+    start = GetCounter();
+    for (i = 0; i < documents; ++i)
+        VERIFY(AtoW(ascii.c_str(), CP_ACP, static_cast<int>(ascii.size())).c_str()[0] == L'T');
+
+    AddResult(_T("textconv_atow_ascii"), documents, start, bytes);
+
+    CAtoW wideAscii(ascii.c_str());
+    start = GetCounter();
+    for (i = 0; i < documents; ++i)
+        VERIFY(WtoA(wideAscii, CP_ACP, static_cast<int>(ascii.size())).c_str()[0] == 'T');
+
+    AddResult(_T("textconv_wtoa_ascii"), documents, start, bytes);
+
+    bytes = static_cast<double>(documents) * utf8.size();
+    start = GetCounter();
+    for (i = 0; i < documents; ++i)
+        VERIFY(AtoW(utf8.c_str(), CP_UTF8, static_cast<int>(utf8.size())).c_str()[0] == L'T');
+
+    AddResult(_T("textconv_utf8_to_wide"), documents, start, bytes);
+
+    CAtoW wideUtf8(utf8.c_str(), CP_UTF8);
+    int wideLength = lstrlenW(wideUtf8);
+    start = GetCounter();
+    for (i = 0; i < documents; ++i)
+        VERIFY(WtoA(wideUtf8, CP_UTF8, wideLength).c_str()[0] == 'T');
+
+    AddResult(_T("textconv_wide_to_utf8"), documents, start, bytes);
+
+    // Check that the conversions produce the same text as the Windows API,
+    // including for invalid UTF-8 and unpaired surrogates.
+    const char* utf8Tests[] = { "", "text", utf8.c_str(), "caf\xC3\xA9", "\xC3(", "\xE2\x82",
+                                "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xFF text" };
+    for (i = 0; i < 10; ++i)
+    {
+        std::vector<WCHAR> expected(strlen(utf8Tests[i]) + 1, L'\0');
+        ::MultiByteToWideChar(CP_UTF8, 0, utf8Tests[i], -1, &expected[0], static_cast<int>(expected.size()));
+        if (lstrcmpW(AtoW(utf8Tests[i], CP_UTF8), &expected[0]) != 0)
+        {
+            std::cerr << "textconv AtoW produced different text for UTF-8 test " << i << std::endl;
+            ++m_failures;
+        }
+    }
+
+    const WCHAR unpaired[] = { L'a', 0xD800, L'b', 0 };
+    const LPCWSTR wideTests[] = { L"", L"text", wideUtf8, L"caf\x00E9", unpaired };
+    for (i = 0; i < 5; ++i)
+    {
+        int length = ::WideCharToMultiByte(CP_UTF8, 0, wideTests[i], -1, NULL, 0, NULL, NULL);
+        std::vector<char> expected(static_cast<size_t>(length) + 1, '\0');
+        ::WideCharToMultiByte(CP_UTF8, 0, wideTests[i], -1, &expected[0], length, NULL, NULL);
+        if (strcmp(WtoA(wideTests[i], CP_UTF8), &expected[0]) != 0)
+        {
+            std::cerr << "textconv WtoA produced different text for UTF-8 test " << i << std::endl;
+            ++m_failures;
+        }
+    }
+}
+
+// Times queuing tasks to the thread pool, and ParallelFor.
+void CBenchmark::TestThreadPool()
+{
+    CThreadPool& pool = GetThreadPool();
+
+    const long tasks = 200000 * m_scale;
+    LONG remaining = tasks;
+
+    int i;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < tasks; ++i)
+        pool.QueueTask(CountTask, &remaining);
+
+    // Help to run the tasks until they are all done.
+    while (::InterlockedExchangeAdd(&remaining, 0) != 0)
+    {
+        if (!pool.RunPendingTask())
+            ::SwitchToThread();
+    }
+
+    AddResult(_T("threadpool_queue_task"), tasks, start);
+
+    const int elements = 4000000;
+    const long passes = 10 * m_scale;
+    std::vector<DWORD> buffer(elements);
+    start = GetCounter();
+    for (i = 0; i < passes; ++i)
+        pool.ParallelFor(0, elements, FillRange, &buffer);
+
+    AddResult(_T("threadpool_parallel_for"), passes, start, double(passes) * elements * sizeof(DWORD));
+}
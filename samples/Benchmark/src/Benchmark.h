@@ -0,0 +1,80 @@
+/////////////////////////////
+// Benchmark.h
+//
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+///////////////////////////////////////////////////////////
+// BenchResult holds the result of a single benchmark.
+struct BenchResult
+{
+    CString name;           // The benchmark's name
+    long iterations;        // The number of operations timed
+    double milliseconds;    // The total time taken
+    double bytes;           // The number of bytes processed, or 0
+    double gdiAllocs;       // Heap allocations and map inserts for CDC and CGDIObject data
+    double heapAllocs;      // Calls to operator new
+};
+
+
+///////////////////////////////////////////////////////////
+// CBenchmark runs the benchmarks without any user interaction
+// and reports the results in CSV or JSON format. Windows are
+// created as message-only or hidden windows.
+class CBenchmark
+{
+public:
+    CBenchmark();
+    virtual ~CBenchmark() {}
+
+    CString GetCSV() const;
+    int     GetFailures() const { return m_failures; }
+    CString GetJSON() const;
+    void RunAll();
+    void SetDockers(int dockers) { m_dockers = dockers; }
+    void SetScale(int scale)     { m_scale = scale; }
+
+private:
+    // Data passed to the socket's receiving thread
+    struct ReceiveParams
+    {
+        CSocket* pSocket;
+        LONGLONG bytes;
+    };
+
+    void AddResult(LPCTSTR name, long iterations, LONGLONG start, double bytes = 0);
+    void CheckAllocs(LPCTSTR name, LONG allocs, LONG maxAllocs);
+    void CheckResources(LPCTSTR name, const ResourceSnapshot& before);
+    LONGLONG GetCounter() const;
+
+    void TestArchive();
+    void TestCreateDestroy();
+    void TestCString();
+    void TestDispatch();
+    void TestDocking();
+    void TestGDI();
+    void TestPixels();
+    void TestResample();
+    void TestSocket();
+    void TestStringBuilder();
+    void TestTextConv();
+    void TestThreadPool();
+
+    static void WINAPI CountTask(LPVOID pRemaining);
+    static void WINAPI FillRange(int first, int last, LPVOID pBuffer);
+    static void FormatPrintf(CString& str, LPCTSTR format, ...);
+    static UINT WINAPI ReceiveThread(LPVOID pParams);
+
+    // Member variables
+    std::vector<BenchResult> m_results;
+    LONGLONG m_frequency;   // Performance counter frequency
+    int m_dockers;          // Number of dockers used by the docking benchmark
+    int m_failures;         // Number of failed self-checks, such as leaks, excess allocations and wrong results
+    LONG m_heapAllocs;      // The heap allocation count when the last result was recorded
+    int m_scale;            // Multiplies the number of iterations
+};
+
+
+#endif  //BENCHMARK_H
@@ -0,0 +1,84 @@
+/////////////////////////////
+// TestWnd.cpp
+//
+
+#include "stdafx.h"
+#include "TestWnd.h"
+
+
+///////////////////////////////////
+// CTestWindow function definitions
+//
+
+// Creates the window as a message-only window.
+void CTestWindow::CreateWin()
+{
+    CreateEx(0, NULL, _T("Test Window"), 0, 0, 0, 0, 0, HWND_MESSAGE, NULL);
+}
+
+LRESULT CTestWindow::OnTestMessage()
+{
+    static LRESULT messages = 0;
+
+    // Return the number of WM_TESTMESSAGE messages processed so far.
+    return ++messages;
+}
+
+// Processes the test window's messages.
+LRESULT CTestWindow::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
+{
+    switch (msg)
+    {
+    case WM_TESTMESSAGE:   return OnTestMessage();
+    }
+
+    return WndProcDefault(msg, wparam, lparam);
+}
+
+
+//////////////////////////////////////
+// CMapTestWindow function definitions
+//
+
+// Creates the window as a message-only window.
+void CMapTestWindow::CreateWin()
+{
+    CreateEx(0, NULL, _T("Map Test Window"), 0, 0, 0, 0, 0, HWND_MESSAGE, NULL);
+}
+
+// Returns the message map. Several entries are used so the lookup
+// resembles that of a typical window.
+const CMapTestWindow::MessageEntry* CMapTestWindow::GetMessageMap()
+{
+    static const MessageEntry messageMap[] =
+    {
+        { WM_ERASEBKGND,    &CMapTestWindow::OnPassThrough },
+        { WM_KEYDOWN,       &CMapTestWindow::OnPassThrough },
+        { WM_LBUTTONDOWN,   &CMapTestWindow::OnPassThrough },
+        { WM_LBUTTONUP,     &CMapTestWindow::OnPassThrough },
+        { WM_MOUSEMOVE,     &CMapTestWindow::OnPassThrough },
+        { WM_SETFOCUS,      &CMapTestWindow::OnPassThrough },
+        { WM_SIZE,          &CMapTestWindow::OnPassThrough },
+        { WM_TIMER,         &CMapTestWindow::OnPassThrough },
+        { WM_TESTMESSAGE,   &CMapTestWindow::OnTestMessage },
+        { 0, 0 }
+    };
+
+    return messageMap;
+}
+
+// Passes the message on for default processing.
+LRESULT CMapTestWindow::OnPassThrough(UINT msg, WPARAM wparam, LPARAM lparam)
+{
+    return WndProcDefault(msg, wparam, lparam);
+}
+
+LRESULT CMapTestWindow::OnTestMessage(UINT, WPARAM, LPARAM)
+{
+    static LRESULT messages = 0;
+
+    // Return the number of WM_TESTMESSAGE messages processed so far.
+    return ++messages;
+}
+
+
@@ -0,0 +1,70 @@
+/////////////////////////////
+// TestWnd.h
+//
+
+#ifndef TESTWND_H
+#define TESTWND_H
+
+
+#define WM_TESTMESSAGE   WM_USER + 2   // the test message
+
+
+///////////////////////////////////////////////////////////
+// CTestWindow is a message-only window that handles its
+// messages with a switch statement.
+class CTestWindow : public CWnd
+{
+public:
+    CTestWindow() {}
+    virtual ~CTestWindow() {}
+    void CreateWin();
+
+    // Calls WndProc directly. Used to time the message dispatch.
+    LRESULT Dispatch(UINT msg, WPARAM wparam, LPARAM lparam) { return WndProc(msg, wparam, lparam); }
+
+protected:
+    // Virtual functions that override base class functions
+    virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
+
+private:
+    // Message handlers
+    LRESULT OnTestMessage();
+};
+
+
+///////////////////////////////////////////////////////////
+// CMapTestWindow is a message-only window that handles its
+// messages with a message map.
+class CMapTestWindow : public CMessageMapT<CMapTestWindow>
+{
+public:
+    CMapTestWindow() {}
+    virtual ~CMapTestWindow() {}
+    void CreateWin();
+
+    // Calls WndProc directly. Used to time the message dispatch.
+    LRESULT Dispatch(UINT msg, WPARAM wparam, LPARAM lparam) { return WndProc(msg, wparam, lparam); }
+
+    static const MessageEntry* GetMessageMap();
+
+private:
+    // Message handlers
+    LRESULT OnPassThrough(UINT msg, WPARAM wparam, LPARAM lparam);
+    LRESULT OnTestMessage(UINT msg, WPARAM wparam, LPARAM lparam);
+};
+
+
+///////////////////////////////////////////////////////////
+// CTestDocker is the docker used by the docking benchmark.
+class CTestDocker : public CDocker
+{
+public:
+    CTestDocker() { SetView(m_view); }
+    virtual ~CTestDocker() {}
+
+private:
+    CWnd m_view;
+};
+
+
+#endif  //TESTWND_H
@@ -0,0 +1,73 @@
+/////////////////////////////
+// main.cpp
+//
+
+#include "stdafx.h"
+#include "Benchmark.h"
+
+
+// Usage: Benchmark [-csv | -json] [-o file] [-scale n] [-dockers n]
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // Start Win32++
+        CWinApp theApp;
+
+        CBenchmark benchmark;
+        bool isJSON = false;
+        const char* outputFile = NULL;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            CStringA arg = argv[i];
+            if (arg == "-csv")
+                isJSON = false;
+            else if (arg == "-json")
+                isJSON = true;
+            else if (arg == "-o" && i + 1 < argc)
+                outputFile = argv[++i];
+            else if (arg == "-scale" && i + 1 < argc)
+                benchmark.SetScale(MAX(1, atoi(argv[++i])));
+            else if (arg == "-dockers" && i + 1 < argc)
+                benchmark.SetDockers(MAX(1, atoi(argv[++i])));
+            else
+            {
+                std::cerr << "Usage: Benchmark [-csv | -json] [-o file] [-scale n] [-dockers n]" << std::endl;
+                return 1;
+            }
+        }
+
+        benchmark.RunAll();
+
+        CString report = isJSON ? benchmark.GetJSON() : benchmark.GetCSV();
+        if (outputFile)
+        {
+            std::ofstream file(outputFile);
+            if (!file)
+            {
+                std::cerr << "Failed to open " << outputFile << std::endl;
+                return 1;
+            }
+
+            file << TtoA(report.c_str());
+        }
+        else
+            std::cout << TtoA(report.c_str());
+
+        // Fail if a self-check failed: excess heap allocations, leaked
+        // resources, or FormatT, text conversion, Find/Replace, CStringBuilder,
+        // SIMD pixel or resampler results that differ from the expected results.
+        return (benchmark.GetFailures() == 0) ? 0 : 2;
+    }
+
+    // Catch all unhandled CException types.
+    catch (const CException &e)
+    {
+        // Display the exception and quit.
+        std::cerr << TtoA(e.GetText()) << std::endl;
+
+        return -1;
+    }
+}
+
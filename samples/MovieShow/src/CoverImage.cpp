@@ -52,46 +52,20 @@ CCoverImage::~CCoverImage()
 {
 }
 
-// Draws the cover image to the specified device context.
+// Draws the cover image to the specified device context. The image is
+// scaled when the size of the window changes, rather than each time
+// it's drawn.
 void CCoverImage::DrawImage(CDC& dc)
 {
-    // Convert the image string to binary
-    if (m_imageData.size() > 0)
+    CRect rc = GetClientRect();
+    if (m_image.GetSource().GetHandle() && !rc.IsRectEmpty())
     {
-        UINT len = (UINT)m_imageData.size();
-        HGLOBAL mem = GlobalAlloc(GMEM_MOVEABLE, len);
-        if (mem != 0)
-        {
-            BYTE* pMem = (BYTE*)GlobalLock(mem);
-            if (pMem != NULL)
-            {
-                memcpy(pMem, &m_imageData[0], len);
-                IStream* stream = NULL;
-                VERIFY(S_OK == CreateStreamOnHGlobal(mem, FALSE, &stream));
-                Image cover(stream);
-
-                // Draw the image
-                UINT width = GetClientRect().Width();
-                UINT height = GetClientRect().Height();
-                Rect destRect(0, 0, width, height);
-                Graphics graphics(dc);
-                graphics.DrawImage(&cover, destRect);
-
-                // Cleanup
-                stream->Release();
-                GlobalUnlock(mem);
-            }
-            GlobalFree(mem);
-        }
+        CMemDC memDC(dc);
+        memDC.SelectObject(m_image.GetImage(rc.Width(), rc.Height()));
+        dc.BitBlt(0, 0, rc.Width(), rc.Height(), memDC, 0, 0, SRCCOPY);
     }
     else
-    {
-        CRect rc = GetWindowRect();
-        SolidBrush solidBrush(Color(255, 255, 255, 255));       // white brush
-        Rect rectangle(0, 0, rc.Width(), rc.Height());
-        Graphics graphics(dc);
-        graphics.FillRectangle(&solidBrush, rectangle);
-    }
+        dc.SolidFill(RGB(255, 255, 255), rc);
 }
 
 // Called when the CCoverImage window needs to be redrawn.
@@ -119,6 +93,53 @@ LRESULT CCoverImage::OnPaint(UINT, WPARAM, LPARAM)
     return 0;
 }
 
+// Decodes the cover image from the image data. The image is decoded once
+// here, rather than each time the window is drawn.
+void CCoverImage::SetImageData(const std::vector<BYTE>& imageData)
+{
+    CDIBSection image;
+
+    // Convert the image string to binary
+    if (imageData.size() > 0)
+    {
+        UINT len = (UINT)imageData.size();
+        HGLOBAL mem = GlobalAlloc(GMEM_MOVEABLE, len);
+        if (mem != 0)
+        {
+            BYTE* pMem = (BYTE*)GlobalLock(mem);
+            if (pMem != NULL)
+            {
+                memcpy(pMem, &imageData[0], len);
+                IStream* stream = NULL;
+                VERIFY(S_OK == CreateStreamOnHGlobal(mem, FALSE, &stream));
+
+                {
+                    Image cover(stream);
+                    int width = static_cast<int>(cover.GetWidth());
+                    int height = static_cast<int>(cover.GetHeight());
+                    if (cover.GetLastStatus() == Ok && width > 0 && height > 0)
+                    {
+                        // Draw the image on a white background at its full size.
+                        image.Create(width, height);
+                        CMemDC memDC(0);
+                        memDC.SelectObject(image);
+                        memDC.SolidFill(RGB(255, 255, 255), CRect(0, 0, width, height));
+                        Graphics graphics(memDC);
+                        graphics.DrawImage(&cover, 0, 0, width, height);
+                    }
+                }
+
+                // Cleanup
+                stream->Release();
+                GlobalUnlock(mem);
+            }
+            GlobalFree(mem);
+        }
+    }
+
+    m_image.SetSource(image);
+}
+
 // Process the window messages for the CCoverImage window.
 LRESULT CCoverImage::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
 {
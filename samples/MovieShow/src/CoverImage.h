@@ -13,7 +13,7 @@ class CCoverImage : public CWnd
 public:
     CCoverImage();
     virtual ~CCoverImage();
-    std::vector<BYTE>& SetImageData() { return m_imageData; }
+    void SetImageData(const std::vector<BYTE>& imageData);
 
 protected:
     // Virtual functions that override base class functions
@@ -24,7 +24,7 @@ protected:
 private:
     void DrawImage(CDC& dc);
 
-    std::vector<BYTE> m_imageData;
+    CScaledImage m_image;       // The decoded cover, and a copy scaled to fit the window
     ULONG_PTR   m_gdiplusToken;
 };
 
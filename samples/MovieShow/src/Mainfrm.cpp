@@ -95,7 +95,7 @@ void CMainFrame::ClearDisplay()
     GetViewDialog().GetYear().SetWindowText(0);
     GetViewDialog().GetActors().SetWindowText(0);
     GetViewDialog().GetInfo().SetWindowText(0);
-    GetViewDialog().SetPicture().SetImageData().clear();
+    GetViewDialog().SetPicture().SetImageData(std::vector<BYTE>());
     GetViewDialog().RedrawWindow();
 }
 
@@ -1352,7 +1352,7 @@ LRESULT CMainFrame::OnSelectListItem(const MovieInfo* pmi)
     actors.Replace(L" / ", L"\r\n");
     dialog.GetActors().SetWindowText(actors);
     dialog.GetInfo().SetWindowText(pmi->description);
-    dialog.SetPicture().SetImageData() = pmi->imageData;
+    dialog.SetPicture().SetImageData(pmi->imageData);
     dialog.SetPicture().Invalidate();
 
     BOOL isFavourite = pmi->flags & 0x0001;
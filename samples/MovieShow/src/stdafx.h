@@ -62,6 +62,7 @@
 #include <wxx_rebar.h>          // Add CRebar
 #include <wxx_rect.h>           // Add CPoint, CRect, CSize
 #include <wxx_regkey.h>         // Add CRegKey
+#include <wxx_resampler.h>      // Add CResampler, CScaledImage
 #include <wxx_richedit.h>       // Add CRichEdit
 #include <wxx_scrollview.h>     // Add CScrollView
 #include <wxx_shared_ptr.h>     // Add Shared_Ptr
@@ -59,6 +59,38 @@ LONGLONG CMainWindow::GetCounter() const
     return current.QuadPart;
 }
 
+// Compares the time taken to dispatch messages with a switch
+// statement and with a message map. WndProc is called directly
+// so the time taken by SendMessage is excluded.
+void CMainWindow::DispatchTest()
+{
+    const int dispatches = 10000000;
+    CTestWindow* pSwitchWindow = m_pTestWindows[(m_testWindows-1)/2].get();
+
+    CString str;
+    str.Format(_T("Dispatching %d messages"), dispatches);
+    SendText(str);
+
+    int i;
+    LONGLONG start = GetCounter();
+    for (i = 0; i < dispatches; ++i)
+        pSwitchWindow->Dispatch(WM_TESTMESSAGE, 0, 0);
+
+    LONGLONG end = GetCounter();
+    double mSeconds = 1000.0 * (end - start) / m_frequency;
+    str.Format(_T("%.2f milliseconds using a switch statement"), mSeconds);
+    SendText(str);
+
+    start = GetCounter();
+    for (i = 0; i < dispatches; ++i)
+        m_mapTestWindow.Dispatch(WM_TESTMESSAGE, 0, 0);
+
+    end = GetCounter();
+    mSeconds = 1000.0 * (end - start) / m_frequency;
+    str.Format(_T("%.2f milliseconds using a message map"), mSeconds);
+    SendText(str);
+}
+
 // Called when the main window is created.
 int CMainWindow::OnCreate(CREATESTRUCT&)
 {
@@ -66,6 +98,7 @@ int CMainWindow::OnCreate(CREATESTRUCT&)
     SetIconLarge(IDW_MAIN);
 
     m_edit.Create(*this);
+    m_mapTestWindow.CreateWin();
 
     return 0;
 }
@@ -117,6 +150,7 @@ void CMainWindow::OnAllWindowsCreated()
     if (result != IDOK) return;
 
     PerformanceTest();
+    DispatchTest();
 
     // Loop the performance test
     result = IDYES;
@@ -126,6 +160,7 @@ void CMainWindow::OnAllWindowsCreated()
         if (result != IDYES) break;
 
         PerformanceTest();
+        DispatchTest();
     }
     SendText(_T("Testing complete"));
 }
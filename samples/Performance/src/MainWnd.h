@@ -42,6 +42,7 @@ private:
     virtual LRESULT OnWindowCreated();
 
     LONGLONG GetCounter() const;
+    void DispatchTest();
     void OnAllWindowsCreated();
     void PerformanceTest() const;
     void SendText(LPCTSTR str) const;
@@ -49,6 +50,7 @@ private:
     // Member variables
     std::vector<TestWindowPtr> m_pTestWindows; // A vector CTestWindow smart pointers
     CMyEdit m_edit;        // Handle to the edit window
+    CMapTestWindow m_mapTestWindow; // Test window that uses a message map
     int m_testMessages;    // Number of test messages to be sent
     int m_testWindows;     // Number of test windows to create
     int m_windowsCreated;  // Number of windows created
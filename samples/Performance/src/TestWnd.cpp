@@ -77,3 +77,49 @@ LRESULT CTestWindow::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
     }
 }
 
+
+//////////////////////////////////////
+// CMapTestWindow function definitions
+//
+
+// Creates the window as a message-only window.
+void CMapTestWindow::CreateWin()
+{
+    CreateEx(0, NULL, _T("Map Test Window"), 0, 0, 0, 0, 0, HWND_MESSAGE, NULL);
+}
+
+// Returns the message map. Several entries are used so the lookup
+// resembles that of a typical window.
+const CMapTestWindow::MessageEntry* CMapTestWindow::GetMessageMap()
+{
+    static const MessageEntry messageMap[] =
+    {
+        { WM_ERASEBKGND,    &CMapTestWindow::OnPassThrough },
+        { WM_KEYDOWN,       &CMapTestWindow::OnPassThrough },
+        { WM_LBUTTONDOWN,   &CMapTestWindow::OnPassThrough },
+        { WM_LBUTTONUP,     &CMapTestWindow::OnPassThrough },
+        { WM_MOUSEMOVE,     &CMapTestWindow::OnPassThrough },
+        { WM_SETFOCUS,      &CMapTestWindow::OnPassThrough },
+        { WM_SIZE,          &CMapTestWindow::OnPassThrough },
+        { WM_TIMER,         &CMapTestWindow::OnPassThrough },
+        { WM_TESTMESSAGE,   &CMapTestWindow::OnTestMessage },
+        { 0, 0 }
+    };
+
+    return messageMap;
+}
+
+// Passes the message on for default processing.
+LRESULT CMapTestWindow::OnPassThrough(UINT msg, WPARAM wparam, LPARAM lparam)
+{
+    return WndProcDefault(msg, wparam, lparam);
+}
+
+LRESULT CMapTestWindow::OnTestMessage(UINT, WPARAM, LPARAM)
+{
+    static LRESULT messages = 0;
+
+    // Return the number of WM_TESTMESSAGE messages processed so far.
+    return ++messages;
+}
+
@@ -17,6 +17,9 @@ public:
     virtual ~CTestWindow(){}
     void CreateWin(int i);
 
+    // Calls WndProc directly. Used to time the message dispatch.
+    LRESULT Dispatch(UINT msg, WPARAM wparam, LPARAM lparam) { return WndProc(msg, wparam, lparam); }
+
 protected:
     // Virtual functions that override base class functions
     virtual int OnCreate(CREATESTRUCT& cs);
@@ -31,4 +34,27 @@ private:
 };
 
 
+///////////////////////////////////////////////////////////
+// CMapTestWindow is a message-only window that uses a
+// message map instead of a switch statement. It is used to
+// compare the message map's dispatch with CTestWindow's.
+class CMapTestWindow : public CMessageMapT<CMapTestWindow>
+{
+public:
+    CMapTestWindow() {}
+    virtual ~CMapTestWindow() {}
+    void CreateWin();
+
+    // Calls WndProc directly. Used to time the message dispatch.
+    LRESULT Dispatch(UINT msg, WPARAM wparam, LPARAM lparam) { return WndProc(msg, wparam, lparam); }
+
+    static const MessageEntry* GetMessageMap();
+
+private:
+    // Message handlers
+    LRESULT OnPassThrough(UINT msg, WPARAM wparam, LPARAM lparam);
+    LRESULT OnTestMessage(UINT msg, WPARAM wparam, LPARAM lparam);
+};
+
+
 #endif  //TESTWIN_H
@@ -55,6 +55,7 @@
 #include <wxx_mdi.h>            // Add CMDIChild, CMDIFrame, CDockMDIFrame
 #include <wxx_menu.h>           // Add CMenu
 #include <wxx_menubar.h>        // Add CMenuBar
+#include <wxx_messagemap.h>     // Add CMessageMapT
 #include <wxx_metafile.h>       // Add CMetaFile, CEnhMetaFile
 #include <wxx_mutex.h>          // Add CEvent, CMutex, CSemaphore
 #include <wxx_propertysheet.h>  // Add CPropertyPage, CPropertySheet
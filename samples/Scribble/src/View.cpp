@@ -47,48 +47,39 @@ int CView::OnCreate(CREATESTRUCT&)
     return 0;
 }
 
-// Draws the points to a memory DC. A memory DC provides double buffering
-// for smoother rendering.
-CMemDC CView::Draw()
+// Draws the background and the points to the specified DC.
+void CView::Draw(CDC& dc)
 {
-    // Set up our Memory DC and bitmap
-    CClientDC dc(*this);
-    CMemDC memDC(dc);
-    int width = GetClientRect().Width();
-    int height = GetClientRect().Height();
-    memDC.CreateCompatibleBitmap(dc, width, height);
-    memDC.FillRect(GetClientRect(), m_brush);
-
-    // Draw the lines on the memory DC
+    dc.FillRect(GetClientRect(), m_brush);
+
+    // Draw the lines
     if (GetAllPoints().size() > 0)
     {
         bool isDrawing = false;  //Start with the pen up
         for (size_t i = 0 ; i < GetAllPoints().size(); ++i)
         {
-            memDC.CreatePen(PS_SOLID, 1, GetAllPoints()[i].penColor);
+            dc.CreatePen(PS_SOLID, 1, GetAllPoints()[i].penColor);
 
             if (isDrawing)
-                memDC.LineTo(GetAllPoints()[i].x, GetAllPoints()[i].y);
+                dc.LineTo(GetAllPoints()[i].x, GetAllPoints()[i].y);
             else
-                memDC.MoveTo(GetAllPoints()[i].x, GetAllPoints()[i].y);
+                dc.MoveTo(GetAllPoints()[i].x, GetAllPoints()[i].y);
 
             isDrawing = GetAllPoints()[i].isPenDown;
         }
     }
-
-    return memDC;
 }
 
 // Called when part of the view window needs to be redawn.
-// Calls the Draw function to perform the drawing to a memory DC.
+// Calls the Draw function to perform the drawing to a buffered DC.
+// The buffered DC provides double buffering for smoother rendering,
+// and only copies the part of the window that needs to be redrawn.
 void CView::OnDraw(CDC& dc)
 {
-    int width = GetClientRect().Width();
-    int height = GetClientRect().Height();
-
-    // Copy from the memory DC to our painting dc
-    CMemDC memDC = Draw();
-    dc.BitBlt(0, 0, width, height, memDC, 0, 0, SRCCOPY);
+    CRect rcPaint;
+    dc.GetClipBox(rcPaint);
+    CBufferedDC memDC(dc, rcPaint);
+    Draw(memDC);
 }
 
 // Called when a file is dropped on the view window.
@@ -187,8 +178,11 @@ void CView::PrintPage(CDC& dc, UINT)
         int width = viewRect.Width();
         int height = viewRect.Height();
 
-        // Acquire the view's bitmap.
-        CMemDC memDC = Draw();
+        // Draw the view to a bitmap.
+        CClientDC viewDC(*this);
+        CMemDC memDC(viewDC);
+        memDC.CreateCompatibleBitmap(viewDC, width, height);
+        Draw(memDC);
         CBitmap bmView = memDC.DetachBitmap();
 
         // Now we convert the Device Dependent Bitmap(DDB) to a
@@ -210,7 +204,6 @@ void CView::PrintPage(CDC& dc, UINT)
 
         // Determine the scaling factors required to print the bitmap and retain
         // its original aspect ratio.
-        CClientDC viewDC(*this);
         double viewPixelsX = double(viewDC.GetDeviceCaps(LOGPIXELSX));
         double viewPixelsY = double(viewDC.GetDeviceCaps(LOGPIXELSY));
         double printPixelsX = double(printDC.GetDeviceCaps(LOGPIXELSX));
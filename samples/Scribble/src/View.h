@@ -44,7 +44,7 @@ protected:
     virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
 
 private:
-    CMemDC Draw();
+    void Draw(CDC& dc);
     void DrawLine(int x, int y);
 
     CDoc m_doc;
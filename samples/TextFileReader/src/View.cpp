@@ -44,6 +44,8 @@ CView()                                                                     /*
 *-----------------------------------------------------------------------------*/
 {
     SetDefaults();
+      // Only draw the lines in view, using a back buffer the size of the view
+    SetViewportBuffer(TRUE);
 
       // This is an optional text message displayed at the end of the file view.
       // Set this to null if a message isn't required;
@@ -121,14 +123,26 @@ OnInitialUpdate()                                                           /*
 
 /*============================================================================*/
     void    CView::
-OnDraw(CDC& memDC)                                                          /*
-
-    Paint the window's compatible bitmap whose device context is memDC
-    bounded by the rectangle rc, in pixel units. The content of the window
-    consists of lines of wide character text, where the top-left corner of
-    the display is given as the current scroll position in the number of
-    average character widths from the left and lines from the top of the
-    document.
+OnDraw(CDC& dc)                                                             /*
+
+    Paint the window when there is nothing to scroll, which is when no
+    document is open.
+*-----------------------------------------------------------------------------*/
+{
+    CRect rc = GetClientRect();
+    dc.FillRect(rc, GetScrollBkgnd());
+    OnDrawViewport(dc, rc);
+}
+
+/*============================================================================*/
+    void    CView::
+OnDrawViewport(CDC& memDC, const CRect& updateRect)                         /*
+
+    Paint the part of the document within updateRect, in document pixel
+    units, to the view's back buffer whose device context is memDC. The
+    content of the window consists of lines of wide character text. The
+    viewport origin of memDC has been set to the scroll position, so only
+    the lines that intersect updateRect are drawn.
 *-----------------------------------------------------------------------------*/
 {
       // select the window font
@@ -145,8 +159,12 @@ OnDraw(CDC& memDC)                                                          /*
           // upper-left-most character in the display
         CStringW fmt(L"%.4u | "),
             line_no;
+          // find the lines that need to be painted
+        UINT line_height = MAX(1, GetFontSize().cy);
+        UINT first = UINT(MAX(0, updateRect.top)) / line_height;
+        UINT last  = MIN(doc_length, UINT(MAX(0, updateRect.bottom)) / line_height);
           // display the current view
-        for (UINT i = 0; i <= doc_length; i++)
+        for (UINT i = first; i <= last; i++)
         {
             if (m_showNumbers)
                 line_no.Format(fmt, i + 1);
@@ -168,39 +186,6 @@ OnDraw(CDC& memDC)                                                          /*
     }
 }
 
-/*============================================================================*/
-    LRESULT  CView::
-OnPaint(UINT, WPARAM, LPARAM)                                               /*
-
-    Called when part or all of the window needs to be redrawn.
-*-----------------------------------------------------------------------------*/
-{
-    // The drawing of the client area is done in a manner that reduces
-    // flicker when the window is scrolled or resized. This is done by
-    // creating a compatible DC and bitmap, painting what is to appear
-    // in the window into this bitmap, and, once complete, copying this
-    // bitmap into the window.  This process is split into two parts: The
-    // part that comprises this method is application-independent. The
-    // remainder is relegated to the Paint() method. The WindProc()
-    // function further responds to the WM_ERASEBKGND by not erasing the
-    // background. We start by creating the device context for handling
-    // the WM_PAINT message.
-
-    CRect rc = GetClientRect(); // device units (pixels)
-      // create a memory device context to print into
-    CPaintDC dc(*this);
-    CMemDC memDC(dc);
-      // Create a bitmap big enough for our client rectangle.
-    memDC.CreateCompatibleBitmap(dc, rc.Width(), rc.Height());
-    memDC.FillRect(rc, GetScrollBkgnd());
-      // here we would paint the client rc with app-dependent stuff
-    OnDraw(memDC);
-    // now we can rapidly copy the painted memory into the screen DC.
-    dc.BitBlt(rc.left, rc.top, rc.Width(), rc.Height(), memDC, 0, 0,
-        SRCCOPY);
-    return 0;
-}
-
 /*============================================================================*/
     void CView::
 PreCreate(CREATESTRUCT &cs)                                                 /*
@@ -328,16 +313,14 @@ SetScrollParameters()                                                       /*
 TextLineOut(CDC& dc, UINT leftcol, UINT line, LPCWSTR s) const              /*
 
     Output the wide character string s beginning at leftcol on the given line
-    of the client area with device context dc, within the client rectangle rc
-    using the given font sizes.
+    of the document with device context dc, using the given font sizes. The
+    viewport origin of dc offsets the output by the scroll position.
 *-----------------------------------------------------------------------------*/
 {
-      // set TextOut() below to use device coordinates
-    CPoint sPos = GetScrollPosition();
-      // convert left column and line number to device coordinates
+      // convert left column and line number to document coordinates
     CPoint pt(leftcol, line * GetFontSize().cy);
       // output the line to the view dc
-    TextOutW(dc, pt.x - sPos.x, pt.y - sPos.y, s, lstrlenW(s));
+    TextOutW(dc, pt.x, pt.y, s, lstrlenW(s));
 }
 
 /*============================================================================*/
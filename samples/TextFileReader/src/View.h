@@ -73,8 +73,8 @@ CView : public CScrollView                                                  /*
 
     protected:
         void    OnInitialUpdate();
-        void    OnDraw(CDC& memDC);
-        LRESULT OnPaint(UINT msg, WPARAM wparam, LPARAM lparam);
+        void    OnDraw(CDC& dc);
+        void    OnDrawViewport(CDC& memDC, const CRect& updateRect);
         void    PreCreate(CREATESTRUCT& cs);
         void    Serialize(CArchive& ar);
 
@@ -75,6 +75,7 @@ BOOL CMainFrame::OnEditFunction()
     {
         CString str = m_view.GetInput().GetFunction();
         m_view.GetCalc().Input(str);
+        m_view.UpdatePlot();
         m_view.RedrawWindow();
 
         if (m_view.GetCalc().Get_Status() == Calc::st_ERROR)
@@ -89,7 +89,7 @@ void CView::CalcPoints(double xmin, double xmax)
 }
 
 // Plot the function to the window.
-void CView::DoPlot(CDC& dc)
+void CView::DoPlot(CDC& dc, const CUpdateRegion& region)
 {
     if (m_points.size() == 0)
         return;
@@ -121,7 +121,7 @@ void CView::DoPlot(CDC& dc)
     PrepareDC(dc);
     PlotXAxis(dc, xnorm, ynorm, xoffset, yoffset);
     PlotYAxis(dc, xnorm, ynorm, xoffset, yoffset);
-    PlotFunction(dc, xnorm, ynorm, xoffset, yoffset);
+    PlotFunction(dc, region, xnorm, ynorm, xoffset, yoffset);
     DrawLabel(dc);
 }
 
@@ -142,13 +142,11 @@ void CView::DrawLabel(CDC& dc)
 }
 
 // Called when part or all of the window needs to be redrawn.
-void CView::OnDraw(CDC& dc)
+// The points are calculated by UpdatePlot, not each time the window
+// is drawn.
+void CView::OnDrawRegion(CDC& dc, const CUpdateRegion& region)
 {
-    if (m_calc.Get_Status() != st_ERROR)
-    {
-        CalcPoints(GetXMin(), GetXMax());
-        DoPlot(dc);
-    }
+    DoPlot(dc, region);
 }
 
 // OnInitialUpdate is called after the window is created
@@ -272,24 +270,39 @@ void CView::PlotYAxis(CDC& dc, double xnorm, double ynorm, double xoffset, doubl
     }
 }
 
-// Plots the function.
-void CView::PlotFunction(CDC& dc, double xnorm, double ynorm, double xoffset, double yoffset)
+// Plots the function. Line segments outside the update region are skipped.
+void CView::PlotFunction(CDC& dc, const CUpdateRegion& region, double xnorm, double ynorm, double xoffset, double yoffset)
 {
     CRect rect;
     dc.CreatePen(PS_SOLID, 1, RGB(0, 0, 255));
 
+    // Convert the update region to logical co-ordinates, allowing for the pen width.
+    CUpdateRegion plotRegion = region;
+    plotRegion.InflateRect(2, 2);
+    plotRegion.DPtoLP(dc);
+
     // Find the first valid value.
     size_t index = 0;
     while ((m_points[index].status != st_OK) && (index < m_points.size() - 1))
         index++;
 
     // Draw the function.
-    dc.MoveTo((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+    CPoint last((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+    dc.MoveTo(last);
     while (index < m_points.size())
     {
         if (m_points[index].status == st_OK)
         {
-            dc.LineTo((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+            CPoint next((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+            CRect segment((last.x < next.x) ? last.x : next.x, (last.y < next.y) ? last.y : next.y,
+                          (last.x < next.x) ? next.x : last.x, (last.y < next.y) ? next.y : last.y);
+            segment.InflateRect(1, 1);
+            if (plotRegion.Intersects(segment))
+                dc.LineTo(next);
+            else
+                dc.MoveTo(next);
+
+            last = next;
             index++;
         }
         else
@@ -298,11 +311,23 @@ void CView::PlotFunction(CDC& dc, double xnorm, double ynorm, double xoffset, do
                 index++;
 
             if (index < m_points.size())
-                dc.MoveTo((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+            {
+                last = CPoint((int)(xnorm * (m_points[index].x - xoffset)), (int)(ynorm * (m_points[index].y - yoffset)));
+                dc.MoveTo(last);
+            }
         }
     }
 }
 
+// Recalculates the points to plot. Called when the function or the
+// size of the window changes.
+void CView::UpdatePlot()
+{
+    m_points.clear();
+    if (m_calc.Get_Status() != st_ERROR)
+        CalcPoints(GetXMin(), GetXMax());
+}
+
 // Set the CREATESTRUCT parameters before the window is created.
 void CView::PreCreate(CREATESTRUCT& cs)
 {
@@ -334,6 +359,7 @@ LRESULT CView::WndProc(UINT msg, WPARAM wparam, LPARAM lparam)
         switch (msg)
         {
         case WM_SIZE:
+            UpdatePlot();
             Invalidate();
             break;  // Also do default processing.
         }
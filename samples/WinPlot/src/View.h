@@ -29,24 +29,26 @@ public:
 
     Calc::Calculator& GetCalc() { return m_calc; }
     CInputDlg& GetInput() { return m_inputDlg; }
+    void UpdatePlot();
 
 protected:
     // Virtual functions that override base class functions
-    virtual void OnDraw(CDC& dc);
+    virtual void OnDrawRegion(CDC& dc, const CUpdateRegion& region);
     virtual void OnInitialUpdate();
     virtual void PreCreate(CREATESTRUCT& cs);
     virtual void PreRegisterClass(WNDCLASS& wc);
+    virtual BOOL WantsUpdateRegion() const { return TRUE; }
     virtual LRESULT WndProc(UINT msg, WPARAM wparam, LPARAM lparam);
 
 private:
     void CalcPoints(double xmin, double xmax);
-    void DoPlot(CDC& dc);
+    void DoPlot(CDC& dc, const CUpdateRegion& region);
     void DrawLabel(CDC& dc);
     double GetXMin() { return m_inputDlg.GetMin(); }
     double GetXMax() { return m_inputDlg.GetMax(); }
     void PlotXAxis(CDC& dc, double xnorm, double ynorm, double xoffset, double yoffset);
     void PlotYAxis(CDC& dc, double xnorm, double ynorm, double xoffset, double yoffset);
-    void PlotFunction(CDC& dc, double xnorm, double ynorm, double xoffset, double yoffset);
+    void PlotFunction(CDC& dc, const CUpdateRegion& region, double xnorm, double ynorm, double xoffset, double yoffset);
     void PrepareDC(CDC& dc);
 
     // Member varuables